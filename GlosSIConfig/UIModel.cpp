@@ -409,7 +409,16 @@ QVariantMap UIModel::getDefaultConf() const
             QJsonObject{{"maxControllers", -1},
                 {"emulateDS4", false},
                 {"allowDesktopConfig", false},
-                {"updateRate", 144}
+                {"updateRate", 144},
+                {"idleThrottle", false},
+                {"idleUpdateRate", 30},
+                {"keepaliveMs", 500},
+                {"inputBackend", "XInput"},
+                {"replayFile", ""},
+                {"replayMaxSpeed", false},
+                {"replayLoop", false},
+                {"inputThreadTask", "None"},
+                {"inputThreadAffinity", 0}
             }},
         {"devices",
          QJsonObject{
@@ -435,7 +444,9 @@ QVariantMap UIModel::getDefaultConf() const
              {"scale", QJsonValue::Null},
              {"windowMode", false},
              {"disableGlosSIOverlay", false},
-             {"opaqueSteamOverlay", false}
+             {"opaqueSteamOverlay", false},
+             {"idleFps", 20},
+             {"renderThreadAffinity", 0}
          }},
     };
 
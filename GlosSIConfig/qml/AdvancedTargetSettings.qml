@@ -35,7 +35,7 @@ CollapsiblePane {
     Column {
         spacing: 16		
 		id: contentColumn
-		height: subTitleLabel.height + 16 + advancedLaunchPane.height + 16 + deviceWindowRow.height + 16 + commonPane.height
+		height: subTitleLabel.height + 16 + advancedLaunchPane.height + 16 + deviceWindowRow.height + 16 + controllerTimingPane.height + 16 + commonPane.height
 		Label {
             id: subTitleLabel
 			width: parent.width
@@ -558,6 +558,275 @@ CollapsiblePane {
             }
         }
 
+        RPane {
+            id: controllerTimingPane
+            width: parent.width
+            radius: 4
+            Material.elevation: 32
+            bgOpacity: 0.97
+            height: controllerTimingCol.height + 24
+
+            // affinity masks are stored as numbers; a comma separated core list is easier to edit
+            function coresFromMask(mask) {
+                const cores = []
+                for (let core = 0; core < 64 && mask >= Math.pow(2, core); core++) {
+                    if (Math.floor(mask / Math.pow(2, core)) % 2 == 1) {
+                        cores.push(core)
+                    }
+                }
+                return cores.join(", ")
+            }
+            function maskFromCores(text) {
+                const cores = new Set(text.split(",")
+                    .map((e) => parseInt(e.trim()))
+                    .filter((e) => !isNaN(e) && e >= 0 && e < 64))
+                let mask = 0
+                cores.forEach((core) => { mask += Math.pow(2, core) })
+                return mask
+            }
+
+            Column {
+                id: controllerTimingCol
+                spacing: 4
+                width: parent.width
+                Label {
+                    font.bold: true
+                    text: qsTr("Controller timing")
+                }
+                Row {
+                    leftPadding: 16
+                    Label {
+                        text: qsTr("Update rate (Hz)")
+                        topPadding: 16
+                    }
+                    SpinBox {
+                        width: 172
+                        from: 30
+                        value: shortcutInfo.controller.updateRate || 144
+                        to: 1000
+                        stepSize: 1
+                        editable: true
+                        onValueChanged: shortcutInfo.controller.updateRate = value
+                    }
+                    RoundButton {
+                        onClicked: () => {
+                            helpInfoDialog.titleText = qsTr("Update rate")
+                            helpInfoDialog.text =
+                                qsTr("How often controller input is read and forwarded to the virtual controllers")
+                                + "\n"
+                                + qsTr("Higher rates lower input latency, but use more CPU")
+
+                            helpInfoDialog.open()
+                        }
+                        width: 48
+                        height: 48
+                        Material.elevation: 0
+                        anchors.topMargin: 16
+                        Image {
+                            anchors.centerIn: parent
+                            source: "qrc:/svg/help_outline_white_24dp.svg"
+                            width: 24
+                            height: 24
+                        }
+                    }
+                }
+                Row {
+                    CheckBox {
+                        id: idleThrottleCheckbox
+                        text: qsTr("Throttle while idle")
+                        checked: shortcutInfo.controller.idleThrottle || false
+                        onCheckedChanged: shortcutInfo.controller.idleThrottle = checked
+                    }
+                    Label {
+                        text: qsTr("Idle rate (Hz)")
+                        topPadding: 16
+                        leftPadding: 16
+                    }
+                    SpinBox {
+                        width: 172
+                        from: 1
+                        value: shortcutInfo.controller.idleUpdateRate || 30
+                        to: 1000
+                        stepSize: 1
+                        editable: true
+                        enabled: idleThrottleCheckbox.checked
+                        onValueChanged: shortcutInfo.controller.idleUpdateRate = value
+                    }
+                    RoundButton {
+                        onClicked: () => {
+                            helpInfoDialog.titleText = qsTr("Throttle while idle")
+                            helpInfoDialog.text =
+                                qsTr("Drops to the idle rate while no controller input changes")
+                                + "\n"
+                                + qsTr("Saves CPU, but the first input after idling may be delayed by one idle tick")
+
+                            helpInfoDialog.open()
+                        }
+                        width: 48
+                        height: 48
+                        Material.elevation: 0
+                        anchors.topMargin: 16
+                        Image {
+                            anchors.centerIn: parent
+                            source: "qrc:/svg/help_outline_white_24dp.svg"
+                            width: 24
+                            height: 24
+                        }
+                    }
+                }
+                Row {
+                    leftPadding: 16
+                    Label {
+                        text: qsTr("Keepalive (ms)")
+                        topPadding: 16
+                    }
+                    SpinBox {
+                        width: 172
+                        from: 0
+                        value: shortcutInfo.controller.keepaliveMs ?? 500
+                        to: 10000
+                        stepSize: 50
+                        editable: true
+                        onValueChanged: shortcutInfo.controller.keepaliveMs = value
+                    }
+                    RoundButton {
+                        onClicked: () => {
+                            helpInfoDialog.titleText = qsTr("Keepalive")
+                            helpInfoDialog.text =
+                                qsTr("Resends an unchanged controller report after this long")
+                                + "\n"
+                                + qsTr("0 to only send reports when the input changes")
+
+                            helpInfoDialog.open()
+                        }
+                        width: 48
+                        height: 48
+                        Material.elevation: 0
+                        anchors.topMargin: 16
+                        Image {
+                            anchors.centerIn: parent
+                            source: "qrc:/svg/help_outline_white_24dp.svg"
+                            width: 24
+                            height: 24
+                        }
+                    }
+                }
+                Row {
+                    leftPadding: 16
+                    Label {
+                        text: qsTr("Input backend")
+                        topPadding: 16
+                    }
+                    ComboBox {
+                        width: 172
+                        model: ["XInput", "XUSB"]
+                        currentIndex: Math.max(0, model.indexOf(shortcutInfo.controller.inputBackend || "XInput"))
+                        onActivated: shortcutInfo.controller.inputBackend = currentText
+                    }
+                    RoundButton {
+                        onClicked: () => {
+                            helpInfoDialog.titleText = qsTr("Input backend")
+                            helpInfoDialog.text =
+                                qsTr("XInput: read controllers through the XInput API")
+                                + "\n"
+                                + qsTr("XUSB: talk to the controller driver directly, skipping XInput's internal polling")
+
+                            helpInfoDialog.open()
+                        }
+                        width: 48
+                        height: 48
+                        Material.elevation: 0
+                        anchors.topMargin: 16
+                        Image {
+                            anchors.centerIn: parent
+                            source: "qrc:/svg/help_outline_white_24dp.svg"
+                            width: 24
+                            height: 24
+                        }
+                    }
+                }
+                Row {
+                    leftPadding: 16
+                    Label {
+                        text: qsTr("Controller thread priority (MMCSS)")
+                        topPadding: 16
+                    }
+                    ComboBox {
+                        width: 172
+                        model: ["None", "Games", "Pro Audio"]
+                        currentIndex: Math.max(0, model.indexOf(shortcutInfo.controller.inputThreadTask || "None"))
+                        onActivated: shortcutInfo.controller.inputThreadTask = currentText
+                    }
+                    RoundButton {
+                        onClicked: () => {
+                            helpInfoDialog.titleText = qsTr("Controller thread priority (MMCSS)")
+                            helpInfoDialog.text =
+                                qsTr("Registers the controller thread with the Multimedia Class Scheduler Service")
+                                + "\n"
+                                + qsTr("Can reduce input jitter under load, but may take CPU time from the game")
+
+                            helpInfoDialog.open()
+                        }
+                        width: 48
+                        height: 48
+                        Material.elevation: 0
+                        anchors.topMargin: 16
+                        Image {
+                            anchors.centerIn: parent
+                            source: "qrc:/svg/help_outline_white_24dp.svg"
+                            width: 24
+                            height: 24
+                        }
+                    }
+                }
+                Row {
+                    leftPadding: 16
+                    Label {
+                        text: qsTr("Controller thread cores")
+                        topPadding: 16
+                    }
+                    TextField {
+                        width: 172
+                        placeholderText: qsTr("any")
+                        text: controllerTimingPane.coresFromMask(shortcutInfo.controller.inputThreadAffinity || 0)
+                        onEditingFinished: shortcutInfo.controller.inputThreadAffinity = controllerTimingPane.maskFromCores(text)
+                    }
+                    Label {
+                        text: qsTr("Overlay thread cores")
+                        topPadding: 16
+                        leftPadding: 16
+                    }
+                    TextField {
+                        width: 172
+                        placeholderText: qsTr("any")
+                        text: controllerTimingPane.coresFromMask(shortcutInfo.window.renderThreadAffinity || 0)
+                        onEditingFinished: shortcutInfo.window.renderThreadAffinity = controllerTimingPane.maskFromCores(text)
+                    }
+                    RoundButton {
+                        onClicked: () => {
+                            helpInfoDialog.titleText = qsTr("Thread cores")
+                            helpInfoDialog.text =
+                                qsTr("Comma separated list of logical cores the thread may run on, e.g. \"2, 3\"")
+                                + "\n"
+                                + qsTr("Leave empty to run on any core")
+
+                            helpInfoDialog.open()
+                        }
+                        width: 48
+                        height: 48
+                        Material.elevation: 0
+                        anchors.topMargin: 16
+                        Image {
+                            anchors.centerIn: parent
+                            source: "qrc:/svg/help_outline_white_24dp.svg"
+                            width: 24
+                            height: 24
+                        }
+                    }
+                }
+            }
+        }
+
         RPane {
             width: parent.width
             radius: 4
@@ -20,7 +20,6 @@ limitations under the License.
 #ifdef _WIN32
 #include <ShObjIdl.h>
 #include <atlbase.h>
-#include <tlhelp32.h>
 #include <Propsys.h>
 #include <propkey.h>
 #include <shellapi.h>
@@ -33,13 +32,20 @@ limitations under the License.
 #include <regex>
 
 #include "HttpServer.h"
+#include "Log.h"
 #include "Overlay.h"
+#include "Profiler.h"
 #include "../common/UnhookUtil.h"
 #include "../common/util.h"
 
 AppLauncher::AppLauncher(
-    std::vector<HWND>& process_hwnds,
-    std::function<void()> shutdown) : shutdown_(std::move(shutdown)), process_hwnds_(process_hwnds)
+    WindowIndex& process_windows,
+    std::function<void()> shutdown,
+    std::function<void()> on_process_exit)
+    : shutdown_(std::move(shutdown)),
+      pid_snapshot_(GetCurrentProcessId()),
+      process_windows_(process_windows),
+      process_watcher_(std::move(on_process_exit))
 {
 #ifdef _WIN32
     spdlog::debug("Unpatching Valve CreateProcess Hooks");
@@ -53,8 +59,14 @@ AppLauncher::AppLauncher(
         "/launched-pids",
         HttpServer::Method::GET,
         [this](const httplib::Request& req, httplib::Response& res) {
-            const nlohmann::json j = launchedPids();
-            res.set_content(j.dump(), "text/json");
+            // doesn't touch pid_mutex_; the snapshot is already serialized
+            const auto [snapshot, not_modified] = pid_snapshot_.lookup(req.get_header_value("If-None-Match"));
+            res.set_header("ETag", snapshot->etag);
+            if (not_modified) {
+                res.status = 304;
+                return;
+            }
+            res.set_content(snapshot->json, "text/json");
         },
         {1, 2, 3},
     });
@@ -87,10 +99,18 @@ void AppLauncher::launchApp(const std::wstring& path, const std::wstring& args)
 {
 #ifdef _WIN32
 
+    auto launcher_profiles = LauncherProfiles::BuiltIn();
     if (!Settings::launch.launcherProcesses.empty()) {
-        has_extra_launchers_ = true;
-        spdlog::debug("Has extra launchers");
+        launcher_profiles.push_back({"Configured", L"", Settings::launch.launcherProcesses, {}});
+    }
+    pid_mutex_.lock();
+    launchers_ = LauncherProfiles::Matcher(std::move(launcher_profiles));
+    if (launchers_.activate(path + L" " + args)) {
+        for (const auto& name : launchers_.activeNames()) {
+            spdlog::debug("Launcher profile \"{}\" active", name);
+        }
     }
+    pid_mutex_.unlock();
 
     if (Settings::launch.isUWP) {
         spdlog::info("LaunchApp is UWP, launching...");
@@ -109,8 +129,8 @@ void AppLauncher::launchApp(const std::wstring& path, const std::wstring& args)
         ImGui::SetNextWindowDockID(dockspace_id, ImGuiCond_FirstUseEver);
         if (ImGui::Begin("Launched Processes")) {
             ImGui::BeginChild("Inner##LaunchedProcs", {0.f, ImGui::GetItemRectSize().y - 64}, true);
-            std::ranges::for_each(pids_, [](DWORD pid) {
-                ImGui::Text("%s | %d", util::string::to_string(util::win::process::GetProcName(pid)).c_str(), pid);
+            std::ranges::for_each(pids_, [this](DWORD pid) {
+                ImGui::Text("%s | %d", util::string::to_string(process_tree_.name(pid)).c_str(), pid);
                 ImGui::SameLine();
                 if (ImGui::Button((" Kill ##" + std::to_string(pid)).c_str())) {
                     util::win::process::KillProcess(pid);
@@ -125,47 +145,67 @@ void AppLauncher::launchApp(const std::wstring& path, const std::wstring& args)
 
 void AppLauncher::update()
 {
-    if (process_check_clock_.getElapsedTime().asMilliseconds() > 250) {
+#ifdef _WIN32
+    // exits are handled right away, looking for new processes can wait
+    const auto process_exited = process_watcher_.hasExits();
+#else
+    const auto process_exited = false;
+#endif
+    if (process_exited || process_check_clock_.getElapsedTime().asMilliseconds() > 250) {
+        PROFILE_ZONE("AppLauncher::update");
         pid_mutex_.lock();
 #ifdef _WIN32
-        if (has_extra_launchers_ && pids_.empty()) {
+        for (const auto& exit : process_watcher_.takeExits()) {
+            GLOSSI_EXT_DEBUG(Log::PROCESS, "Process {} exited with code {}", exit.pid, exit.exit_code);
+        }
+        process_tree_ = ProcessTree::Index::Snapshot();
+        if (launchers_.active() && pids_.empty()) {
             findLauncherPids();
         }
         if (!pids_.empty() && pids_[0] > 0) {
             if (Settings::launch.waitForChildProcs) {
                 getChildPids(pids_[0]);
             }
-            if (!IsProcessRunning(pids_[0])) {
-                spdlog::info(L"Launched App \"{}\" with PID \"{}\" died", util::win::process::GetProcName(pids_[0]), pids_[0]);
+            watchNewPids();
+            if (!isRunning(pids_[0])) {
+                spdlog::info(L"Launched App \"{}\" with PID \"{}\" died", process_tree_.name(pids_[0]), pids_[0]);
                 if (Settings::launch.closeOnExit && !Settings::launch.waitForChildProcs && Settings::launch.launch) {
                     spdlog::info("Configured to close on exit. Shutting down...");
                     shutdown_();
                 }
+                known_pids_.erase(pids_[0]);
+                launchers_.forget(pids_[0]);
                 pids_[0] = 0;
             }
         }
         if (Settings::launch.waitForChildProcs) {
 
-            std::erase_if(pids_, [](auto pid) {
+            watchNewPids();
+            std::erase_if(pids_, [this](auto pid) {
                 if (pid == 0) {
                     return true;
                 }
-                const auto running = IsProcessRunning(pid);
-                if (!running)
-                    spdlog::trace(L"Child process \"{}\" with PID \"{}\" died", util::win::process::GetProcName(pid), pid);
+                const auto running = isRunning(pid);
+                if (!running) {
+                    GLOSSI_TRACE(L"Child process \"{}\" with PID \"{}\" died", process_tree_.name(pid), pid);
+                    // PIDs get recycled
+                    known_pids_.erase(pid);
+                    launchers_.forget(pid);
+                    polled_pids_.erase(pid);
+                }
                 return !running;
             });
 
-            auto filtered_pids = pids_ | std::ranges::views::filter([](DWORD pid) {
-                                     return std::ranges::find(Settings::launch.launcherProcesses, util::win::process::GetProcName(pid)) == Settings::launch.launcherProcesses.end();
+            auto filtered_pids = pids_ | std::ranges::views::filter([this](DWORD pid) {
+                                     return !launchers_.isLauncher(process_tree_, pid);
                                  });
-            if (has_extra_launchers_ && !filtered_pids.empty()) {
+            if (launchers_.active() && !filtered_pids.empty()) {
                 launcher_has_launched_game_ = true;
             }
             if (Settings::launch.closeOnExit && Settings::launch.launch) {
-                if (has_extra_launchers_ && (Settings::launch.ignoreLauncher || Settings::launch.killLauncher)) {
+                if (launchers_.active() && (Settings::launch.ignoreLauncher || Settings::launch.killLauncher)) {
                     if (launcher_has_launched_game_ && filtered_pids.empty()) {
-                        spdlog::info("Configured to close on all children exit. Shutting down after game launched via EGS quit...");
+                        spdlog::info("Configured to close on all children exit. Shutting down after game launched via launcher quit...");
                         shutdown_();
                     }
                 }
@@ -179,6 +219,7 @@ void AppLauncher::update()
         }
         getProcessHwnds();
 #endif
+        publishPids();
         pid_mutex_.unlock();
         process_check_clock_.restart();
     }
@@ -196,25 +237,22 @@ void AppLauncher::close()
 
 std::vector<DWORD> AppLauncher::launchedPids()
 {
-    pid_mutex_.lock();
-    std::vector<DWORD> res;
-    res.reserve(pids_.size());
+    return pid_snapshot_.current()->pids;
+}
+
+void AppLauncher::publishPids()
+{
+    std::vector<DWORD> pids;
+    pids.reserve(pids_.size());
     if (!Settings::launch.killLauncher && Settings::launch.ignoreLauncher) {
-        for (const auto& pid : pids_ | std::ranges::views::filter(
-                                           [](DWORD pid) {
-                                               return std::ranges::find(
-                                                          Settings::launch.launcherProcesses,
-                                                          util::win::process::GetProcName(pid)) == Settings::launch.launcherProcesses.end();
-                                           })) {
-            res.push_back(pid);
-        }
+        std::ranges::copy_if(pids_, std::back_inserter(pids), [this](DWORD pid) {
+            return !launchers_.isLauncher(process_tree_, pid);
+        });
     }
     else {
-        std::ranges::copy(pids_.begin(), pids_.end(),
-                          std::back_inserter(res));
+        pids = pids_;
     }
-    pid_mutex_.unlock();
-    return res;
+    pid_snapshot_.publish(std::move(pids));
 }
 
 void AppLauncher::addPids(const std::vector<DWORD>& pids)
@@ -222,12 +260,11 @@ void AppLauncher::addPids(const std::vector<DWORD>& pids)
     pid_mutex_.lock();
     for (const auto pid : pids) {
         if (pid > 0 && std::ranges::find(pids_, pid) == pids_.end()) {
-            if (Settings::common.extendedLogging) {
-                spdlog::debug("Added PID {} via API", pid);
-            }
+            GLOSSI_EXT_DEBUG(Log::PROCESS, "Added PID {} via API", pid);
             pids_.push_back(pid);
         }
     }
+    publishPids();
     pid_mutex_.unlock();
 }
 
@@ -242,56 +279,65 @@ bool AppLauncher::IsProcessRunning(DWORD pid)
     return ret == WAIT_TIMEOUT;
 }
 
-void AppLauncher::getChildPids(DWORD parent_pid)
+void AppLauncher::watchNewPids()
 {
-    HANDLE hp = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-    PROCESSENTRY32 pe = {0};
-    pe.dwSize = sizeof(PROCESSENTRY32);
-    if (Process32First(hp, &pe)) {
-        do {
-            if (pe.th32ParentProcessID == parent_pid) {
-                if (std::ranges::find(pids_, pe.th32ProcessID) == pids_.end()) {
-                    if (Settings::common.extendedLogging) {
-                        spdlog::info(L"Found new child process \"{}\" with PID \"{}\"", util::win::process::GetProcName(pe.th32ProcessID), pe.th32ProcessID);
-                    }
-                    pids_.push_back(pe.th32ProcessID);
-                    getChildPids(pe.th32ProcessID);
-                }
-            }
-        } while (Process32Next(hp, &pe));
+    for (const auto pid : pids_) {
+        if (pid == 0 || !known_pids_.insert(pid).second) {
+            continue;
+        }
+        if (!process_watcher_.watch(pid) && IsProcessRunning(pid)) {
+            GLOSSI_EXT_DEBUG(Log::PROCESS, "Can't watch process {}; polling it instead", pid);
+            polled_pids_.insert(pid);
+        }
     }
-    CloseHandle(hp);
 }
 
-void AppLauncher::getProcessHwnds()
+bool AppLauncher::isRunning(DWORD pid) const
 {
-    process_hwnds_.clear();
-    HWND curr_wnd = nullptr;
-    do {
-        curr_wnd = FindWindowEx(nullptr, curr_wnd, nullptr, nullptr);
-        DWORD check_pid = 0;
-        GetWindowThreadProcessId(curr_wnd, &check_pid);
-        if ((std::ranges::find_if(pids_, [check_pid](auto pid) {
-                 return pid == check_pid;
-             }) != pids_.end())) {
-            process_hwnds_.push_back(curr_wnd);
+    if (polled_pids_.contains(pid)) {
+        return IsProcessRunning(pid);
+    }
+    // watched processes are removed from the watcher once their exit is reported
+    return process_watcher_.watching(pid);
+}
+
+void AppLauncher::getChildPids(DWORD parent_pid)
+{
+    PROFILE_ZONE("AppLauncher::getChildPids");
+    process_tree_.forEachDescendant(parent_pid, [this](DWORD pid) {
+        if (std::ranges::find(pids_, pid) == pids_.end()) {
+            GLOSSI_EXT_INFO(Log::PROCESS, L"Found new child process \"{}\" with PID \"{}\"", process_tree_.name(pid), pid);
+            pids_.push_back(pid);
         }
-    } while (curr_wnd != nullptr);
+    });
+}
+
+void AppLauncher::getProcessHwnds()
+{
+    if (!process_windows_.eventsRunning() && !process_windows_.startEvents()) {
+        // index was still filled by enumerating; try hooking again next time
+        spdlog::debug("Couldn't hook window events; enumerating windows instead");
+    }
+    process_windows_.setPids(pids_);
     if (!launched_uwp_path_.empty()) {
         // UWP and ApplicationFrameHost Bullshit.
         // iterate all "ApplicationFrameWindow"; check the AppUserModelId (used for launching) and add on match.
-        do {
-            curr_wnd = FindWindowEx(nullptr, curr_wnd, L"ApplicationFrameWindow", nullptr);
-            IPropertyStore* propStore;
-            SHGetPropertyStoreForWindow(curr_wnd, IID_IPropertyStore, reinterpret_cast<void**>(&propStore));
+        std::vector<HWND> uwp_windows;
+        HWND curr_wnd = nullptr;
+        while ((curr_wnd = FindWindowEx(nullptr, curr_wnd, L"ApplicationFrameWindow", nullptr)) != nullptr) {
+            CComPtr<IPropertyStore> prop_store;
+            if (FAILED(SHGetPropertyStoreForWindow(curr_wnd, IID_PPV_ARGS(&prop_store)))) {
+                continue;
+            }
             PROPVARIANT prop;
-            if (propStore != nullptr) {
-                propStore->GetValue(PKEY_AppUserModel_ID, &prop);
-                if (prop.bstrVal != nullptr && std::wstring(prop.bstrVal) == launched_uwp_path_) {
-                    process_hwnds_.push_back(curr_wnd);
-                }
+            PropVariantInit(&prop);
+            if (SUCCEEDED(prop_store->GetValue(PKEY_AppUserModel_ID, &prop))
+                && prop.vt == VT_LPWSTR && prop.pwszVal != nullptr && launched_uwp_path_ == prop.pwszVal) {
+                uwp_windows.push_back(curr_wnd);
             }
-        } while (curr_wnd != nullptr);
+            PropVariantClear(&prop);
+        }
+        process_windows_.setExtraWindows(uwp_windows);
     }
 }
 
@@ -300,10 +346,12 @@ void AppLauncher::getProcessHwnds()
 #ifdef _WIN32
 bool AppLauncher::findLauncherPids()
 {
-    if (const auto pid = util::win::process::PidByName(L"EpicGamesLauncher.exe")) {
-        spdlog::debug("Found EGS-Launcher running");
-        pids_.push_back(pid);
-        return true;
+    for (const auto& name : launchers_.mainProcesses()) {
+        if (const auto pid = process_tree_.pidByName(name)) {
+            spdlog::debug(L"Found launcher \"{}\" running", name);
+            pids_.push_back(pid);
+            return true;
+        }
     }
     return false;
 }
@@ -473,9 +521,6 @@ void AppLauncher::launchURL(const std::wstring& url, const std::wstring& args, c
     }
     CoUninitialize();
 
-    if (url.find(L"epicgames.launcher") != std::wstring::npos) {
-        has_extra_launchers_ = true;
-    }
     if (execute_info.hProcess != nullptr) {
         if (const auto pid = GetProcessId(execute_info.hProcess); pid > 0) {
             pid_mutex_.lock();
@@ -486,13 +531,12 @@ void AppLauncher::launchURL(const std::wstring& url, const std::wstring& args, c
         }
     }
 
-    if (has_extra_launchers_) {
-        spdlog::debug("Epic Games launch; Couldn't find egs launcher PID");
+    if (launchers_.active()) {
+        spdlog::debug("Launcher launch; Couldn't get launcher PID from launch");
         pid_mutex_.lock();
-
-        const auto pid = util::win::process::PidByName(L"EpicGamesLauncher.exe");
+        process_tree_ = ProcessTree::Index::Snapshot();
         if (!findLauncherPids()) {
-            spdlog::debug("Did not find EGS-Launcher not running, retrying later...");
+            spdlog::debug("Launcher not running (yet), retrying later...");
         }
         pid_mutex_.unlock();
         return;
@@ -20,18 +20,27 @@ limitations under the License.
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 #endif
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <array>
 #include <string>
 #include <unordered_set>
 #include <SFML/System/Clock.hpp>
 
+#include "LauncherProfiles.h"
+#include "PidSnapshot.h"
+#include "ProcessTree.h"
+#include "ProcessWatcher.h"
+#include "WindowIndex.h"
+
 class AppLauncher {
   public:
     explicit AppLauncher(
-        std::vector<HWND>& process_hwnds,
-        std::function<void()> shutdown = []() {});
+        WindowIndex& process_windows,
+        std::function<void()> shutdown = []() {},
+        std::function<void()> on_process_exit = nullptr);
 
     void launchApp(const std::wstring& path, const std::wstring& args = L"");
     void update();
@@ -45,13 +54,29 @@ class AppLauncher {
     sf::Clock process_check_clock_;
     std::mutex pid_mutex_;
 
+    // What GET /launched-pids serves; (filtered) PIDs, republished on change
+    PidSnapshot::Publisher<DWORD> pid_snapshot_;
+    // pid_mutex_ must be held
+    void publishPids();
+
 #ifdef _WIN32
     static bool IsProcessRunning(DWORD pid);
+    // refreshed once per update; all name/child lookups go through it
+    ProcessTree::Index process_tree_;
     void getChildPids(DWORD parent_pid);
     void getProcessHwnds();
-    std::vector<HWND>& process_hwnds_;
+    WindowIndex& process_windows_;
+
+    // exits of launched processes are pushed by the watcher;
+    // only processes it can't open (access denied) are still polled
+    ProcessWatcher process_watcher_;
+    std::unordered_set<DWORD> known_pids_;
+    std::unordered_set<DWORD> polled_pids_;
+    void watchNewPids();
+    bool isRunning(DWORD pid) const;
 
-    bool has_extra_launchers_ = false;
+    // set up per launch; tells launcher processes (EGS, Ubisoft Connect, ...) apart from the game
+    LauncherProfiles::Matcher launchers_;
     bool launcher_has_launched_game_ = false;
     bool findLauncherPids();
 
@@ -0,0 +1,338 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <spdlog/spdlog.h>
+
+#include "MappedFile.h"
+#include "imgui.h"
+#include "imgui_internal.h"
+
+/*
+ * Caches decoded startup assets (font atlas, logo) as raw blobs in the data dir
+ *
+ * Files are memory mapped and copied straight into the atlas/texture; they are keyed by a hash
+ * of everything that changes their content, so stale or foreign files are simply rebuilt.
+ * DPI and UI scale only change io.FontGlobalScale and are not part of the key.
+ */
+namespace AssetCache {
+
+namespace detail {
+constexpr uint32_t VERSION = 1;
+
+#pragma pack(push, 1)
+struct BlobHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t width;
+    uint32_t height;
+};
+
+struct FontHeader {
+    float size;
+    float ascent;
+    float descent;
+    uint32_t glyph_count;
+};
+
+struct Glyph {
+    uint32_t codepoint;
+    float advance_x;
+    float x0, y0, x1, y1;
+    float u0, v0, u1, v1;
+};
+#pragma pack(pop)
+
+inline std::filesystem::path cache_dir;
+
+// FNV-1a
+inline uint64_t Hash(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+{
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+template <typename T>
+uint64_t HashValue(const T& value, uint64_t hash)
+{
+    return Hash(&value, sizeof(T), hash);
+}
+
+template <typename T>
+bool Get(const uint8_t*& cur, const uint8_t* end, T& value)
+{
+    if (end - cur < static_cast<ptrdiff_t>(sizeof(T))) {
+        return false;
+    }
+    std::memcpy(&value, cur, sizeof(T));
+    cur += sizeof(T);
+    return true;
+}
+
+template <typename T>
+void Put(std::vector<uint8_t>& out, const T& value)
+{
+    const auto pos = out.size();
+    out.resize(pos + sizeof(T));
+    std::memcpy(out.data() + pos, &value, sizeof(T));
+}
+
+inline std::filesystem::path BlobPath(const char* name, uint64_t key)
+{
+    return cache_dir / fmt::format("{}_{:016x}.bin", name, key);
+}
+
+inline bool ReadHeader(const MappedFile& file, const char (&magic)[5], uint64_t key, BlobHeader& header, const uint8_t*& cur)
+{
+    cur = file.data();
+    return cur != nullptr
+           && Get(cur, cur + file.size(), header)
+           && std::memcmp(header.magic, magic, 4) == 0
+           && header.version == VERSION
+           && header.key == key;
+}
+
+// write to a temp file first; a crash mid-write must not leave a truncated blob behind
+inline void WriteBlob(const std::filesystem::path& path, const std::vector<uint8_t>& data)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    auto tmp_path = path;
+    tmp_path += ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file.good()) {
+            spdlog::debug("Failed to write asset cache \"{}\"", tmp_path.string());
+            return;
+        }
+    }
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        spdlog::debug("Failed to write asset cache \"{}\": {}", path.string(), ec.message());
+        std::filesystem::remove(tmp_path, ec);
+    }
+}
+
+// Everything the stb_truetype builder output depends on
+inline uint64_t AtlasKey(ImFontAtlas* atlas)
+{
+    uint64_t key = HashValue(VERSION, 0xcbf29ce484222325ull);
+    key = HashValue(IMGUI_VERSION_NUM, key);
+    key = HashValue(atlas->Flags, key);
+    key = HashValue(atlas->TexDesiredWidth, key);
+    key = HashValue(atlas->TexGlyphPadding, key);
+    for (const auto& cfg : atlas->ConfigData) {
+        key = Hash(cfg.FontData, static_cast<size_t>(cfg.FontDataSize), key);
+        key = HashValue(cfg.FontNo, key);
+        key = HashValue(cfg.SizePixels, key);
+        key = HashValue(cfg.OversampleH, key);
+        key = HashValue(cfg.OversampleV, key);
+        key = HashValue(cfg.PixelSnapH, key);
+        key = HashValue(cfg.GlyphExtraSpacing, key);
+        key = HashValue(cfg.GlyphOffset, key);
+        key = HashValue(cfg.GlyphMinAdvanceX, key);
+        key = HashValue(cfg.GlyphMaxAdvanceX, key);
+        key = HashValue(cfg.RasterizerMultiply, key);
+        key = HashValue(cfg.FontBuilderFlags, key);
+        const ImWchar* ranges = cfg.GlyphRanges ? cfg.GlyphRanges : atlas->GetGlyphRangesDefault();
+        for (; ranges[0]; ranges += 2) {
+            key = HashValue(ranges[0], key);
+            key = HashValue(ranges[1], key);
+        }
+    }
+    return key;
+}
+
+// only plain, non-merged fonts rendered to an alpha texture are cached
+inline bool AtlasCacheable(const ImFontAtlas* atlas)
+{
+    if (atlas->Fonts.Size != atlas->ConfigData.Size || atlas->TexPixelsUseColors) {
+        return false;
+    }
+    for (int i = 0; i < atlas->ConfigData.Size; i++) {
+        if (atlas->ConfigData[i].MergeMode || atlas->ConfigData[i].DstFont != atlas->Fonts[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool LoadAtlas(ImFontAtlas* atlas, uint64_t key)
+{
+    const MappedFile file(BlobPath("font_atlas", key));
+    const auto end = file.data() + file.size();
+    const uint8_t* cur = nullptr;
+    BlobHeader header{};
+    if (!ReadHeader(file, "GSFA", key, header, cur)) {
+        return false;
+    }
+
+    // validate everything before touching the atlas
+    const auto fonts_begin = cur;
+    for (int i = 0; i < atlas->Fonts.Size; i++) {
+        FontHeader font{};
+        if (!Get(cur, end, font) || static_cast<size_t>(end - cur) < font.glyph_count * sizeof(Glyph)) {
+            return false;
+        }
+        cur += font.glyph_count * sizeof(Glyph);
+    }
+    uint32_t rect_count = 0;
+    ImFontAtlasBuildInit(atlas);
+    if (!Get(cur, end, rect_count) || rect_count != static_cast<uint32_t>(atlas->CustomRects.Size)
+        || static_cast<size_t>(end - cur) != rect_count * 2 * sizeof(uint16_t) + size_t{header.width} * header.height) {
+        return false;
+    }
+
+    atlas->TexWidth = static_cast<int>(header.width);
+    atlas->TexHeight = static_cast<int>(header.height);
+    atlas->TexUvScale = ImVec2(1.0f / atlas->TexWidth, 1.0f / atlas->TexHeight);
+
+    cur = fonts_begin;
+    for (int i = 0; i < atlas->Fonts.Size; i++) {
+        FontHeader font{};
+        Get(cur, end, font);
+        auto& cfg = atlas->ConfigData[i];
+        ImFontAtlasBuildSetupFont(atlas, cfg.DstFont, &cfg, font.ascent, font.descent);
+        cfg.DstFont->FontSize = font.size;
+        cfg.DstFont->Glyphs.reserve(static_cast<int>(font.glyph_count));
+        for (uint32_t g = 0; g < font.glyph_count; g++) {
+            Glyph glyph{};
+            Get(cur, end, glyph);
+            // cached values already have the config (snapping, spacing, ...) applied
+            cfg.DstFont->AddGlyph(nullptr, static_cast<ImWchar>(glyph.codepoint),
+                                  glyph.x0, glyph.y0, glyph.x1, glyph.y1,
+                                  glyph.u0, glyph.v0, glyph.u1, glyph.v1, glyph.advance_x);
+        }
+    }
+    Get(cur, end, rect_count);
+    for (auto& rect : atlas->CustomRects) {
+        Get(cur, end, rect.X);
+        Get(cur, end, rect.Y);
+    }
+
+    const size_t pixel_count = size_t{header.width} * header.height;
+    atlas->TexPixelsAlpha8 = static_cast<unsigned char*>(IM_ALLOC(pixel_count));
+    std::memcpy(atlas->TexPixelsAlpha8, cur, pixel_count);
+
+    // custom rects (cursors, lines, white pixel), lookup tables, fallback glyphs
+    ImFontAtlasBuildFinish(atlas);
+    return true;
+}
+
+inline void StoreAtlas(const ImFontAtlas* atlas, uint64_t key)
+{
+    if (atlas->TexPixelsAlpha8 == nullptr) {
+        return;
+    }
+    std::vector<uint8_t> data;
+    BlobHeader header{{'G', 'S', 'F', 'A'}, VERSION, key, static_cast<uint32_t>(atlas->TexWidth), static_cast<uint32_t>(atlas->TexHeight)};
+    Put(data, header);
+    for (const auto* font : atlas->Fonts) {
+        Put(data, FontHeader{font->FontSize, font->Ascent, font->Descent, static_cast<uint32_t>(font->Glyphs.Size)});
+        for (const auto& glyph : font->Glyphs) {
+            Put(data, Glyph{
+                          glyph.Codepoint, glyph.AdvanceX,
+                          glyph.X0, glyph.Y0, glyph.X1, glyph.Y1,
+                          glyph.U0, glyph.V0, glyph.U1, glyph.V1});
+        }
+    }
+    Put(data, static_cast<uint32_t>(atlas->CustomRects.Size));
+    for (const auto& rect : atlas->CustomRects) {
+        Put(data, rect.X);
+        Put(data, rect.Y);
+    }
+    const auto pos = data.size();
+    data.resize(pos + size_t{header.width} * header.height);
+    std::memcpy(data.data() + pos, atlas->TexPixelsAlpha8, data.size() - pos);
+    WriteBlob(BlobPath("font_atlas", key), data);
+}
+
+inline bool BuildAtlas(ImFontAtlas* atlas)
+{
+    const bool cacheable = !cache_dir.empty() && AtlasCacheable(atlas);
+    const auto key = cacheable ? AtlasKey(atlas) : 0;
+    if (cacheable && LoadAtlas(atlas, key)) {
+        spdlog::debug("Font atlas loaded from cache");
+        return true;
+    }
+    if (!ImFontAtlasGetBuilderForStbTruetype()->FontBuilder_Build(atlas)) {
+        return false;
+    }
+    if (cacheable) {
+        StoreAtlas(atlas, key);
+    }
+    return true;
+}
+
+inline const ImFontBuilderIO ATLAS_BUILDER{BuildAtlas};
+} // namespace detail
+
+// Enables caching for the given directory; empty path disables it
+inline void SetDirectory(std::filesystem::path dir)
+{
+    detail::cache_dir = std::move(dir);
+}
+
+// Builds the atlas from cache (if possible) on the next ImFontAtlas::Build()
+inline void Install(ImFontAtlas* atlas)
+{
+    atlas->FontBuilderIO = &detail::ATLAS_BUILDER;
+}
+
+// Same as sf::Texture::loadFromMemory, but skips image decoding if the pixels are cached
+inline bool LoadTexture(sf::Texture& texture, const char* name, const uint8_t* encoded, size_t size)
+{
+    using namespace detail;
+    const auto key = Hash(encoded, size, HashValue(VERSION, 0xcbf29ce484222325ull));
+    if (!cache_dir.empty()) {
+        const MappedFile file(BlobPath(name, key));
+        const uint8_t* cur = nullptr;
+        BlobHeader header{};
+        if (ReadHeader(file, "GSTX", key, header, cur)
+            && static_cast<size_t>(file.data() + file.size() - cur) == size_t{header.width} * header.height * 4
+            && texture.create(header.width, header.height)) {
+            texture.update(cur);
+            return true;
+        }
+    }
+
+    sf::Image image;
+    if (!image.loadFromMemory(encoded, size) || !texture.loadFromImage(image)) {
+        return false;
+    }
+    if (!cache_dir.empty()) {
+        std::vector<uint8_t> data;
+        Put(data, BlobHeader{{'G', 'S', 'T', 'X'}, VERSION, key, image.getSize().x, image.getSize().y});
+        data.insert(data.end(), image.getPixelsPtr(), image.getPixelsPtr() + size_t{image.getSize().x} * image.getSize().y * 4);
+        WriteBlob(BlobPath(name, key), data);
+    }
+    return true;
+}
+
+} // namespace AssetCache
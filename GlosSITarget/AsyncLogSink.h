@@ -0,0 +1,281 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <spdlog/details/log_msg_buffer.h>
+#include <spdlog/sinks/sink.h>
+
+namespace spdlog {
+namespace sinks {
+
+/*
+ * Moves writing (and flushing) of the wrapped sinks to a background thread
+ *
+ * Logging threads only copy the message into a bounded lock free queue (Vyukov MPMC);
+ * the writer thread drains it every flush_interval (earlier once the queue fills up),
+ * flushing every flush_batch lines and at the end of every pass.
+ * flush() drains the queue on the calling thread, so "flush_on" and the crash handler still work;
+ * if the writer is busy for longer than flush_timeout, it's left to the writer instead of blocking the caller.
+ *
+ * Not thread safe: set_pattern/set_formatter (same as any other spdlog sink)
+ */
+class async_queue_sink : public sink {
+  public:
+    enum class overflow_policy {
+        // logging thread waits for the writer to catch up
+        block,
+        // line gets discarded; the writer reports how many were lost
+        drop,
+    };
+
+    struct options {
+        size_t queue_size;
+        size_t flush_batch;
+        std::chrono::milliseconds flush_interval;
+        overflow_policy overflow;
+        // longest flush() waits for a busy writer thread
+        std::chrono::milliseconds flush_timeout = std::chrono::milliseconds(10);
+    };
+
+    async_queue_sink(std::vector<sink_ptr> sinks, const options& opts)
+        : sinks_(std::move(sinks)), opts_(opts)
+    {
+        size_t size = 2;
+        while (size < opts_.queue_size) {
+            size *= 2;
+        }
+        mask_ = size - 1;
+        cells_ = std::make_unique<cell[]>(size);
+        for (size_t i = 0; i < size; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        worker_ = std::thread(&async_queue_sink::run, this);
+    }
+
+    ~async_queue_sink() override
+    {
+        {
+            std::lock_guard lock(wake_mutex_);
+            run_ = false;
+        }
+        wake_cv_.notify_one();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+        flush();
+    }
+
+    async_queue_sink(const async_queue_sink&) = delete;
+    async_queue_sink& operator=(const async_queue_sink&) = delete;
+
+    void log(const details::log_msg& msg) override
+    {
+        if (tryPush(msg)) {
+            // writer sleeps until the flush interval is up; only poke it if it risks falling behind
+            if (size() > mask_ / 2) {
+                wake();
+            }
+            return;
+        }
+        // a wrapped sink logging on the writer thread can't wait for itself to make room
+        if (opts_.overflow == overflow_policy::drop || std::this_thread::get_id() == worker_.get_id()) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        wake();
+        while (!tryPush(msg)) {
+            std::this_thread::yield();
+        }
+    }
+
+    void flush() override
+    {
+        // crash handler (or a wrapped sink) on the writer thread itself; it may already hold consumer_mutex_,
+        // so only flush what has been written so far
+        if (std::this_thread::get_id() == worker_.get_id()) {
+            flushSinksUnlocked();
+            return;
+        }
+        std::unique_lock lock(consumer_mutex_, opts_.flush_timeout);
+        if (lock) {
+            // flushes whatever it wrote
+            drain();
+            return;
+        }
+        // the writer is in the middle of a pass (or stuck); it flushes once it's done
+        wake();
+    }
+
+    void set_pattern(const std::string& pattern) override
+    {
+        for (const auto& s : sinks_) {
+            s->set_pattern(pattern);
+        }
+    }
+
+    void set_formatter(std::unique_ptr<formatter> sink_formatter) override
+    {
+        for (const auto& s : sinks_) {
+            s->set_formatter(sink_formatter->clone());
+        }
+    }
+
+    uint64_t dropped() const
+    {
+        return dropped_total_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    struct cell {
+        std::atomic<size_t> sequence = 0;
+        details::log_msg_buffer msg;
+    };
+
+    std::vector<sink_ptr> sinks_;
+    options opts_;
+
+    std::unique_ptr<cell[]> cells_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> enqueue_pos_ = 0;
+    alignas(64) std::atomic<size_t> dequeue_pos_ = 0;
+
+    std::atomic<uint64_t> dropped_ = 0;
+    std::atomic<uint64_t> dropped_total_ = 0;
+
+    // serializes consumers (writer thread and flush()); producers never touch it
+    std::timed_mutex consumer_mutex_;
+    size_t unflushed_ = 0;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    bool wake_ = false;
+    bool run_ = true;
+    std::thread worker_;
+
+    size_t size() const
+    {
+        return enqueue_pos_.load(std::memory_order_relaxed) - dequeue_pos_.load(std::memory_order_relaxed);
+    }
+
+    bool tryPush(const details::log_msg& msg)
+    {
+        auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            auto& c = cells_[pos & mask_];
+            const auto seq = c.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    // log_msg_buffer keeps short lines inline; no allocation
+                    c.msg = details::log_msg_buffer(msg);
+                    c.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void wake()
+    {
+        {
+            std::lock_guard lock(wake_mutex_);
+            wake_ = true;
+        }
+        wake_cv_.notify_one();
+    }
+
+    // consumer_mutex_ must be held (also for write/flushSinks)
+    void drain()
+    {
+        for (;;) {
+            const auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+            auto& c = cells_[pos & mask_];
+            if (c.sequence.load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+            write(c.msg);
+            c.sequence.store(pos + mask_ + 1, std::memory_order_release);
+            dequeue_pos_.store(pos + 1, std::memory_order_relaxed);
+            if (unflushed_ >= opts_.flush_batch) {
+                flushSinks();
+            }
+        }
+        if (const auto dropped = dropped_.exchange(0, std::memory_order_relaxed); dropped > 0) {
+            dropped_total_.fetch_add(dropped, std::memory_order_relaxed);
+            const auto text = fmt::format("Log queue full; dropped {} lines", dropped);
+            write(details::log_msg("async_queue_sink", level::warn, text));
+        }
+        // everything written this pass hits the disk now, not only on the next wake up
+        if (unflushed_ > 0) {
+            flushSinks();
+        }
+    }
+
+    void write(const details::log_msg& msg)
+    {
+        for (const auto& s : sinks_) {
+            if (s->should_log(msg.level)) {
+                s->log(msg);
+            }
+        }
+        unflushed_++;
+    }
+
+    void flushSinks()
+    {
+        flushSinksUnlocked();
+        unflushed_ = 0;
+    }
+
+    // spdlog sinks lock themselves
+    void flushSinksUnlocked()
+    {
+        for (const auto& s : sinks_) {
+            s->flush();
+        }
+    }
+
+    void run()
+    {
+        std::unique_lock wake_lock(wake_mutex_);
+        while (run_) {
+            wake_cv_.wait_for(wake_lock, opts_.flush_interval, [this] { return wake_ || !run_; });
+            wake_ = false;
+            wake_lock.unlock();
+            {
+                std::lock_guard lock(consumer_mutex_);
+                drain();
+            }
+            wake_lock.lock();
+        }
+    }
+};
+
+} // namespace sinks
+} // namespace spdlog
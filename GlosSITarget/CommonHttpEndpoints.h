@@ -1,5 +1,10 @@
 #pragma once
+#include <cmath>
+#include <limits>
+
 #include "HttpServer.h"
+#include "Profiler.h"
+#include "StartupTimings.h"
 #include "../common/Settings.h"
 #include "../common/steam_util.h"
 
@@ -74,6 +79,60 @@ inline void addEndpoints()
         },
 
     });
+
+    HttpServer::AddEndpoint({
+        "/profiler/trace",
+        HttpServer::Method::GET,
+        [](const httplib::Request& req, httplib::Response& res) {
+            // ?seconds=N; defaults to the last 5 seconds
+            double seconds = 5;
+            if (req.has_param("seconds")) {
+                try {
+                    seconds = std::stod(req.get_param_value("seconds"));
+                }
+                catch (std::exception&) {
+                    seconds = std::numeric_limits<double>::quiet_NaN();
+                }
+                // "nan" / "inf" parse just fine, but can't be turned into a window
+                if (!std::isfinite(seconds)) {
+                    res.status = 400;
+                    res.set_content(nlohmann::json{
+                                        {"code", 400},
+                                        {"name", "Bad Request"},
+                                        {"message", "seconds must be a finite number"},
+                                    }
+                                        .dump(),
+                                    "text/json");
+                    return;
+                }
+                seconds = std::clamp(seconds, 0.0, 600.0);
+            }
+            const auto window = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(seconds));
+            res.set_content(Profiler::ChromeTrace(window).dump(), "text/json");
+        },
+        {
+            {"traceEvents", {
+                {{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", 1}, {"args", {{"name", "Main"}}}},
+                {{"name", "Frame"}, {"ph", "X"}, {"pid", 1}, {"tid", 1}, {"ts", 1000.0}, {"dur", 16666.0}},
+            }},
+            {"displayTimeUnit", "ms"},
+        },
+    });
+
+    HttpServer::AddEndpoint({
+        "/startup",
+        HttpServer::Method::GET,
+        [](const httplib::Request& req, httplib::Response& res) {
+            res.set_content(StartupTimings::Json().dump(), "text/json");
+        },
+        {
+            {"totalMs", 412.3},
+            {"phases", {
+                {{"name", "Logging"}, {"ms", 35.1}},
+                {{"name", "Font atlas"}, {"ms", 1.2}},
+            }},
+        },
+    });
     
 };
 
@@ -0,0 +1,235 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+/*
+ * Monitors and their placement on the virtual screen
+ *
+ * Everything but Enumerate()/GameWindowRect() is plain rectangle math and works on any platform.
+ * Coordinates are virtual screen coordinates (primary monitor at 0,0; others may be negative).
+ */
+namespace DisplayTopology {
+
+struct Rect {
+    int left = 0;
+    int top = 0;
+    int right = 0;
+    int bottom = 0;
+
+    int width() const
+    {
+        return right - left;
+    }
+
+    int height() const
+    {
+        return bottom - top;
+    }
+
+    bool empty() const
+    {
+        return width() <= 0 || height() <= 0;
+    }
+
+    int64_t area() const
+    {
+        return empty() ? 0 : static_cast<int64_t>(width()) * height();
+    }
+
+    Rect intersect(const Rect& other) const
+    {
+        Rect res{std::max(left, other.left), std::max(top, other.top), std::min(right, other.right), std::min(bottom, other.bottom)};
+        return res.empty() ? Rect{} : res;
+    }
+
+    Rect unite(const Rect& other) const
+    {
+        if (empty()) {
+            return other;
+        }
+        if (other.empty()) {
+            return *this;
+        }
+        return {std::min(left, other.left), std::min(top, other.top), std::max(right, other.right), std::max(bottom, other.bottom)};
+    }
+
+    // squared distance from point to the closest point inside the rect; 0 if inside
+    int64_t distanceSq(int x, int y) const
+    {
+        const int64_t dx = x < left ? left - x : x >= right ? x - right + 1 : 0;
+        const int64_t dy = y < top ? top - y : y >= bottom ? y - bottom + 1 : 0;
+        return dx * dx + dy * dy;
+    }
+
+    bool operator==(const Rect&) const = default;
+};
+
+struct Monitor {
+    // device name ("\\.\DISPLAY1"); stable while the monitor is connected
+    std::string id;
+    Rect bounds;
+    // without taskbar & co.
+    Rect work_area;
+    bool primary = false;
+    // Hz; 0 = unknown
+    unsigned int refresh_rate = 0;
+
+    bool operator==(const Monitor&) const = default;
+};
+
+struct Topology {
+    std::vector<Monitor> monitors;
+
+    Rect virtualScreen() const
+    {
+        Rect res;
+        for (const auto& monitor : monitors) {
+            res = res.unite(monitor.bounds);
+        }
+        return res;
+    }
+
+    const Monitor* primary() const
+    {
+        const auto it = std::ranges::find_if(monitors, [](const auto& m) { return m.primary; });
+        return it != monitors.end() ? &*it : monitors.empty() ? nullptr : &monitors.front();
+    }
+
+    const Monitor* find(const std::string& id) const
+    {
+        const auto it = std::ranges::find_if(monitors, [&id](const auto& m) { return m.id == id; });
+        return it != monitors.end() ? &*it : nullptr;
+    }
+
+    // Monitor showing most of the window; closest one if it's entirely off-screen (like MONITOR_DEFAULTTONEAREST)
+    const Monitor* monitorFor(const Rect& window) const
+    {
+        const Monitor* best = nullptr;
+        int64_t best_area = 0;
+        for (const auto& monitor : monitors) {
+            const auto area = monitor.bounds.intersect(window).area();
+            if (area > best_area) {
+                best = &monitor;
+                best_area = area;
+            }
+        }
+        if (best) {
+            return best;
+        }
+        const auto cx = window.left + window.width() / 2;
+        const auto cy = window.top + window.height() / 2;
+        int64_t best_dist = INT64_MAX;
+        for (const auto& monitor : monitors) {
+            const auto dist = monitor.bounds.distanceSq(cx, cy);
+            if (dist < best_dist) {
+                best = &monitor;
+                best_dist = dist;
+            }
+        }
+        return best;
+    }
+};
+
+struct Diff {
+    std::vector<std::string> added;
+    std::vector<std::string> removed;
+    // moved, resized, new refresh rate, primary changed
+    std::vector<std::string> changed;
+
+    bool empty() const
+    {
+        return added.empty() && removed.empty() && changed.empty();
+    }
+};
+
+inline Diff Compare(const Topology& before, const Topology& after)
+{
+    Diff diff;
+    for (const auto& monitor : after.monitors) {
+        const auto* old = before.find(monitor.id);
+        if (!old) {
+            diff.added.push_back(monitor.id);
+        }
+        else if (!(*old == monitor)) {
+            diff.changed.push_back(monitor.id);
+        }
+    }
+    for (const auto& monitor : before.monitors) {
+        if (!after.find(monitor.id)) {
+            diff.removed.push_back(monitor.id);
+        }
+    }
+    return diff;
+}
+
+#ifdef _WIN32
+inline Topology Enumerate()
+{
+    Topology topology;
+    EnumDisplayMonitors(
+        nullptr, nullptr,
+        [](HMONITOR hmonitor, HDC, LPRECT, LPARAM param) -> BOOL {
+            auto& res = *reinterpret_cast<Topology*>(param);
+            MONITORINFOEXA info{};
+            info.cbSize = sizeof(info);
+            if (!GetMonitorInfoA(hmonitor, &info)) {
+                return TRUE;
+            }
+            Monitor monitor;
+            monitor.id = info.szDevice;
+            monitor.bounds = {info.rcMonitor.left, info.rcMonitor.top, info.rcMonitor.right, info.rcMonitor.bottom};
+            monitor.work_area = {info.rcWork.left, info.rcWork.top, info.rcWork.right, info.rcWork.bottom};
+            monitor.primary = info.dwFlags & MONITORINFOF_PRIMARY;
+            DEVMODEA dev_mode{};
+            dev_mode.dmSize = sizeof(dev_mode);
+            if (EnumDisplaySettingsA(info.szDevice, ENUM_CURRENT_SETTINGS, &dev_mode)) {
+                monitor.refresh_rate = dev_mode.dmDisplayFrequency;
+            }
+            res.monitors.push_back(std::move(monitor));
+            return TRUE;
+        },
+        reinterpret_cast<LPARAM>(&topology));
+    return topology;
+}
+
+// Biggest visible, not minimized window of the given ones; empty Rect if there's none
+inline Rect GameWindowRect(const std::vector<HWND>& windows)
+{
+    Rect res;
+    for (const auto hwnd : windows) {
+        RECT rect;
+        if (!IsWindowVisible(hwnd) || IsIconic(hwnd) || !GetWindowRect(hwnd, &rect)) {
+            continue;
+        }
+        const Rect window{rect.left, rect.top, rect.right, rect.bottom};
+        if (window.area() > res.area()) {
+            res = window;
+        }
+    }
+    return res;
+}
+#endif
+
+} // namespace DisplayTopology
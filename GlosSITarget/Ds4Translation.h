@@ -0,0 +1,235 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * XUSB (XInput) -> DS4 report translation
+ *
+ * Platform independent drop-in for ViGEm's DS4_REPORT_INIT + XUSB_TO_DS4_REPORT.
+ * Output is bit-identical to the ViGEm helper; see golden values at the bottom.
+ */
+namespace Ds4Translation {
+
+// Same layout as XINPUT_GAMEPAD / XUSB_REPORT
+struct XusbReport {
+    uint16_t wButtons;
+    uint8_t bLeftTrigger;
+    uint8_t bRightTrigger;
+    int16_t sThumbLX;
+    int16_t sThumbLY;
+    int16_t sThumbRX;
+    int16_t sThumbRY;
+};
+
+// Same layout as DS4_REPORT
+struct Ds4Report {
+    uint8_t bThumbLX;
+    uint8_t bThumbLY;
+    uint8_t bThumbRX;
+    uint8_t bThumbRY;
+    uint16_t wButtons;
+    uint8_t bSpecial;
+    uint8_t bTriggerL;
+    uint8_t bTriggerR;
+};
+
+namespace detail {
+
+// XUSB button bits
+constexpr uint16_t XUSB_DPAD_UP = 0x0001;
+constexpr uint16_t XUSB_DPAD_DOWN = 0x0002;
+constexpr uint16_t XUSB_DPAD_LEFT = 0x0004;
+constexpr uint16_t XUSB_DPAD_RIGHT = 0x0008;
+constexpr uint16_t XUSB_START = 0x0010;
+constexpr uint16_t XUSB_BACK = 0x0020;
+constexpr uint16_t XUSB_LEFT_THUMB = 0x0040;
+constexpr uint16_t XUSB_RIGHT_THUMB = 0x0080;
+constexpr uint16_t XUSB_LEFT_SHOULDER = 0x0100;
+constexpr uint16_t XUSB_RIGHT_SHOULDER = 0x0200;
+constexpr uint16_t XUSB_GUIDE = 0x0400;
+constexpr uint16_t XUSB_A = 0x1000;
+constexpr uint16_t XUSB_B = 0x2000;
+constexpr uint16_t XUSB_X = 0x4000;
+constexpr uint16_t XUSB_Y = 0x8000;
+
+// DS4 button bits
+constexpr uint16_t DS4_THUMB_RIGHT = 1 << 15;
+constexpr uint16_t DS4_THUMB_LEFT = 1 << 14;
+constexpr uint16_t DS4_OPTIONS = 1 << 13;
+constexpr uint16_t DS4_SHARE = 1 << 12;
+constexpr uint16_t DS4_TRIGGER_RIGHT = 1 << 11;
+constexpr uint16_t DS4_TRIGGER_LEFT = 1 << 10;
+constexpr uint16_t DS4_SHOULDER_RIGHT = 1 << 9;
+constexpr uint16_t DS4_SHOULDER_LEFT = 1 << 8;
+constexpr uint16_t DS4_TRIANGLE = 1 << 7;
+constexpr uint16_t DS4_CIRCLE = 1 << 6;
+constexpr uint16_t DS4_CROSS = 1 << 5;
+constexpr uint16_t DS4_SQUARE = 1 << 4;
+constexpr uint8_t DS4_SPECIAL_PS = 1 << 0;
+
+enum Ds4Dpad : uint16_t {
+    NORTH = 0x0,
+    NORTHEAST = 0x1,
+    EAST = 0x2,
+    SOUTHEAST = 0x3,
+    SOUTH = 0x4,
+    SOUTHWEST = 0x5,
+    WEST = 0x6,
+    NORTHWEST = 0x7,
+    NONE = 0x8,
+};
+
+// Replays the exact (order dependent!) sequence of DS4_SET_DPAD calls the ViGEm helper does
+constexpr uint16_t DpadFromXusb(uint16_t b)
+{
+    uint16_t dpad = NONE;
+    if (b & XUSB_DPAD_UP)
+        dpad = NORTH;
+    if (b & XUSB_DPAD_RIGHT)
+        dpad = EAST;
+    if (b & XUSB_DPAD_DOWN)
+        dpad = SOUTH;
+    if (b & XUSB_DPAD_LEFT)
+        dpad = WEST;
+    if ((b & XUSB_DPAD_UP) && (b & XUSB_DPAD_RIGHT))
+        dpad = NORTHEAST;
+    if ((b & XUSB_DPAD_RIGHT) && (b & XUSB_DPAD_DOWN))
+        dpad = SOUTHEAST;
+    if ((b & XUSB_DPAD_DOWN) && (b & XUSB_DPAD_LEFT))
+        dpad = SOUTHWEST;
+    if ((b & XUSB_DPAD_LEFT) && (b & XUSB_DPAD_UP))
+        dpad = NORTHWEST;
+    return dpad;
+}
+
+// low byte of XUSB buttons: dpad, start, back, thumbs
+constexpr std::array<uint16_t, 256> LOW_BYTE_TABLE = [] {
+    std::array<uint16_t, 256> table{};
+    for (uint16_t i = 0; i < 256; i++) {
+        uint16_t out = DpadFromXusb(i);
+        if (i & XUSB_START)
+            out |= DS4_OPTIONS;
+        if (i & XUSB_BACK)
+            out |= DS4_SHARE;
+        if (i & XUSB_LEFT_THUMB)
+            out |= DS4_THUMB_LEFT;
+        if (i & XUSB_RIGHT_THUMB)
+            out |= DS4_THUMB_RIGHT;
+        table[i] = out;
+    }
+    return table;
+}();
+
+// high byte of XUSB buttons: shoulders, face buttons (guide goes to bSpecial)
+constexpr std::array<uint16_t, 256> HIGH_BYTE_TABLE = [] {
+    std::array<uint16_t, 256> table{};
+    for (uint16_t i = 0; i < 256; i++) {
+        const uint16_t b = static_cast<uint16_t>(i << 8);
+        uint16_t out = 0;
+        if (b & XUSB_LEFT_SHOULDER)
+            out |= DS4_SHOULDER_LEFT;
+        if (b & XUSB_RIGHT_SHOULDER)
+            out |= DS4_SHOULDER_RIGHT;
+        if (b & XUSB_A)
+            out |= DS4_CROSS;
+        if (b & XUSB_B)
+            out |= DS4_CIRCLE;
+        if (b & XUSB_X)
+            out |= DS4_SQUARE;
+        if (b & XUSB_Y)
+            out |= DS4_TRIANGLE;
+        table[i] = out;
+    }
+    return table;
+}();
+
+// Axis math is kept *exactly* as in ViGEm (including the asymmetric +/-1 offsets and truncating division)
+// so reports stay bit-identical. The `== 0 -> 0xFF` fixup compiles to a cmov.
+constexpr uint8_t AxisX(int16_t v)
+{
+    return static_cast<uint8_t>((v + 32768) / 257);
+}
+
+constexpr uint8_t AxisLY(int16_t v)
+{
+    const auto res = static_cast<uint8_t>(-(v + 32766) / 257);
+    return res == 0 ? 0xFF : res;
+}
+
+constexpr uint8_t AxisRY(int16_t v)
+{
+    const auto res = static_cast<uint8_t>(-(v + 32768) / 257);
+    return res == 0 ? 0xFF : res;
+}
+
+} // namespace detail
+
+constexpr Ds4Report Translate(const XusbReport& in)
+{
+    Ds4Report out{};
+    out.bThumbLX = detail::AxisX(in.sThumbLX);
+    out.bThumbLY = detail::AxisLY(in.sThumbLY);
+    out.bThumbRX = detail::AxisX(in.sThumbRX);
+    out.bThumbRY = detail::AxisRY(in.sThumbRY);
+    out.wButtons = static_cast<uint16_t>(
+        detail::LOW_BYTE_TABLE[in.wButtons & 0xFF] | detail::HIGH_BYTE_TABLE[in.wButtons >> 8] | ((in.bLeftTrigger != 0) << 10) | ((in.bRightTrigger != 0) << 11));
+    out.bSpecial = static_cast<uint8_t>((in.wButtons & detail::XUSB_GUIDE) ? detail::DS4_SPECIAL_PS : 0);
+    out.bTriggerL = in.bLeftTrigger;
+    out.bTriggerR = in.bRightTrigger;
+    return out;
+}
+
+// Converts `count` reports in one go; `in` and `out` must not overlap
+constexpr void Translate(const XusbReport* in, Ds4Report* out, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        out[i] = Translate(in[i]);
+    }
+}
+
+template <size_t N>
+constexpr std::array<Ds4Report, N> Translate(const std::array<XusbReport, N>& in)
+{
+    std::array<Ds4Report, N> out{};
+    Translate(in.data(), out.data(), N);
+    return out;
+}
+
+namespace detail {
+constexpr bool Equals(const Ds4Report& a, const Ds4Report& b)
+{
+    return a.bThumbLX == b.bThumbLX && a.bThumbLY == b.bThumbLY && a.bThumbRX == b.bThumbRX && a.bThumbRY == b.bThumbRY && a.wButtons == b.wButtons && a.bSpecial == b.bSpecial && a.bTriggerL == b.bTriggerL && a.bTriggerR == b.bTriggerR;
+}
+} // namespace detail
+
+// Golden values, taken from ViGEm's DS4_REPORT_INIT + XUSB_TO_DS4_REPORT
+// idle
+static_assert(detail::Equals(Translate(XusbReport{}), Ds4Report{127, 129, 127, 129, 0x0008, 0, 0, 0}));
+// full deflection
+static_assert(detail::Equals(Translate(XusbReport{0, 0, 0, 32767, 32767, 32767, 32767}), Ds4Report{255, 2, 255, 1, 0x0008, 0, 0, 0}));
+static_assert(detail::Equals(Translate(XusbReport{0, 0, 0, -32768, -32768, -32768, -32768}), Ds4Report{0, 0xFF, 0, 0xFF, 0x0008, 0, 0, 0}));
+// all face/shoulder/menu/thumb buttons, guide, triggers
+static_assert(detail::Equals(Translate(XusbReport{0xF7F0, 10, 255, 0, 0, 0, 0}), Ds4Report{127, 129, 127, 129, 0xFFF8, 1, 10, 255}));
+// dpad: diagonals win, later directions override earlier ones
+static_assert(detail::Equals(Translate(XusbReport{0x0009, 0, 0, 0, 0, 0, 0}), Ds4Report{127, 129, 127, 129, 0x0001, 0, 0, 0}));
+static_assert(detail::Equals(Translate(XusbReport{0x0003, 0, 0, 0, 0, 0, 0}), Ds4Report{127, 129, 127, 129, 0x0004, 0, 0, 0}));
+static_assert(detail::Equals(Translate(XusbReport{0x000F, 0, 0, 0, 0, 0, 0}), Ds4Report{127, 129, 127, 129, 0x0007, 0, 0, 0}));
+static_assert(detail::Equals(Translate(XusbReport{0x0004, 0, 0, 0, 0, 0, 0}), Ds4Report{127, 129, 127, 129, 0x0006, 0, 0, 0}));
+
+} // namespace Ds4Translation
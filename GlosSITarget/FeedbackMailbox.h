@@ -0,0 +1,116 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+namespace Feedback {
+
+// Everything a game can send back to a virtual pad
+struct State {
+    uint8_t large_motor = 0;
+    uint8_t small_motor = 0;
+    uint8_t led_number = 0;
+    bool has_lightbar = false;
+    uint8_t lightbar_red = 0;
+    uint8_t lightbar_green = 0;
+    uint8_t lightbar_blue = 0;
+};
+
+struct Counters {
+    // pushed by ViGEm callbacks
+    std::atomic<uint64_t> received = 0;
+    // overwritten before the input thread got to apply them
+    std::atomic<uint64_t> coalesced = 0;
+    // taken, but not forwarded to the real device (rumble disabled / device gone)
+    std::atomic<uint64_t> dropped = 0;
+    std::atomic<uint64_t> applied = 0;
+};
+
+/*
+ * Single-producer/single-consumer feedback channel, latest value wins
+ *
+ * Only the newest rumble state matters, so instead of a queue this is a single
+ * slot packed into one 64bit atomic; pushing never blocks and never allocates,
+ * bursts simply collapse into one update.
+ * Producer: ViGEm notification thread; Consumer: controller thread.
+ */
+class Mailbox {
+  public:
+    // Returns true if a not yet taken state got replaced
+    bool push(const State& state)
+    {
+        return slot_.exchange(Pack(state) | PENDING, std::memory_order_acq_rel) & PENDING;
+    }
+
+    std::optional<State> take()
+    {
+        if (!(slot_.load(std::memory_order_relaxed) & PENDING)) {
+            return std::nullopt;
+        }
+        // only clear the flag; a concurrent push just sets it again
+        const auto packed = slot_.fetch_and(~PENDING, std::memory_order_acq_rel);
+        if (!(packed & PENDING)) {
+            return std::nullopt;
+        }
+        return Unpack(packed);
+    }
+
+    // Most recent state, whether taken or not
+    State peek() const
+    {
+        return Unpack(slot_.load(std::memory_order_relaxed));
+    }
+
+    // Drops any pending state and forgets the last one; for a slot getting a new (or no) pad
+    void reset()
+    {
+        slot_.store(0, std::memory_order_release);
+    }
+
+  private:
+    static constexpr uint64_t PENDING = uint64_t{1} << 63;
+    std::atomic<uint64_t> slot_ = 0;
+
+    static uint64_t Pack(const State& s)
+    {
+        return uint64_t{s.large_motor}
+               | uint64_t{s.small_motor} << 8
+               | uint64_t{s.led_number} << 16
+               | uint64_t{s.has_lightbar} << 24
+               | uint64_t{s.lightbar_red} << 32
+               | uint64_t{s.lightbar_green} << 40
+               | uint64_t{s.lightbar_blue} << 48;
+    }
+
+    static State Unpack(uint64_t v)
+    {
+        State s;
+        s.large_motor = static_cast<uint8_t>(v);
+        s.small_motor = static_cast<uint8_t>(v >> 8);
+        s.led_number = static_cast<uint8_t>(v >> 16);
+        s.has_lightbar = (v >> 24) & 1;
+        s.lightbar_red = static_cast<uint8_t>(v >> 32);
+        s.lightbar_green = static_cast<uint8_t>(v >> 40);
+        s.lightbar_blue = static_cast<uint8_t>(v >> 48);
+        return s;
+    }
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+};
+
+} // namespace Feedback
@@ -0,0 +1,223 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <string>
+
+#include "LatencyHistogram.h"
+#include "TickClock.h"
+
+/*
+ * Paces the main (render) loop
+ *
+ * Runs at `active_fps` while something is visible (overlays open, window mode, ...)
+ * and drops to `idle_fps` otherwise. wake() renders the next frame right away
+ * (as far as the active rate allows) and keeps it up for `wake_hold`, so hotkeys / remote changes
+ * show up without delay.
+ *
+ * Deadlines are absolute (see InputPump); the clock is injected, so the logic runs fine on a virtual one.
+ * wake() and the stats getters are thread safe, everything else belongs to the main thread.
+ */
+class FrameScheduler {
+  public:
+    struct Config {
+        unsigned int active_fps = 60;
+        unsigned int idle_fps = 10;
+        TickClock::duration wake_hold = std::chrono::seconds(1);
+    };
+
+    // Time spent in one subsystem per frame
+    struct Stage {
+        std::string name;
+        // 0 = share of the active frame time
+        TickClock::duration budget{};
+        LatencyHistogram histogram;
+        std::atomic<uint64_t> over_budget = 0;
+    };
+
+    class StageTimer {
+      public:
+        StageTimer(FrameScheduler& scheduler, Stage& stage)
+            : scheduler_(scheduler), stage_(stage), start_(scheduler.clock_.now())
+        {
+        }
+        ~StageTimer()
+        {
+            scheduler_.record(stage_, scheduler_.clock_.now() - start_);
+        }
+        StageTimer(const StageTimer&) = delete;
+        StageTimer& operator=(const StageTimer&) = delete;
+
+      private:
+        FrameScheduler& scheduler_;
+        Stage& stage_;
+        TickClock::time_point start_;
+    };
+
+    FrameScheduler(TickClock& clock, const Config& config)
+        : clock_(clock), frame_start_(clock.now()), next_(frame_start_), last_wake_(frame_start_ - config.wake_hold)
+    {
+        configure(config);
+    }
+
+    void configure(const Config& config)
+    {
+        config_ = config;
+        active_period_ = PeriodFromRate(config.active_fps);
+        idle_period_ = std::max(PeriodFromRate(config.idle_fps), active_period_);
+        frame_budget_ = active_period_.count();
+        current_fps_ = config.active_fps;
+    }
+
+    const Config& config() const
+    {
+        return config_;
+    }
+
+    // Something is (or isn't) on screen; takes effect with the next frame
+    void setActive(bool active)
+    {
+        if (active && !active_ && idle_.load(std::memory_order_relaxed)) {
+            // don't finish a long idle period first
+            next_ = std::min(next_, frame_start_);
+        }
+        active_ = active;
+    }
+
+    // Safe to call from any thread
+    void wake()
+    {
+        wake_pending_.store(true, std::memory_order_release);
+        clock_.wake();
+    }
+
+    bool isIdle() const
+    {
+        return idle_;
+    }
+
+    unsigned int currentFps() const
+    {
+        return current_fps_;
+    }
+
+    // Stages without an explicit budget get the active frame time
+    TickClock::duration budget(const Stage& stage) const
+    {
+        return stage.budget.count() > 0 ? stage.budget : TickClock::duration(frame_budget_.load(std::memory_order_relaxed));
+    }
+
+    // Call at the end of every frame; blocks until the next one is due.
+    void waitForNextFrame()
+    {
+        auto now = clock_.now();
+        record(frame_, now - frame_start_);
+        if (wake_pending_.exchange(false, std::memory_order_acq_rel)) {
+            last_wake_ = now;
+        }
+        idle_ = !active_ && now - last_wake_ >= config_.wake_hold;
+        current_fps_ = idle_ ? std::min(config_.idle_fps, config_.active_fps) : config_.active_fps;
+        next_ += idle_ ? idle_period_ : active_period_;
+        // don't try to catch up on missed frames
+        if (next_ < now) {
+            next_ = now;
+        }
+        for (;;) {
+            clock_.sleepUntil(next_);
+            now = clock_.now();
+            if (now >= next_) {
+                break;
+            }
+            if (!wake_pending_.exchange(false, std::memory_order_acq_rel)) {
+                continue;
+            }
+            // cut the idle sleep short, but never exceed the active rate
+            last_wake_ = now;
+            idle_ = false;
+            current_fps_ = config_.active_fps;
+            next_ = std::max(now, std::min(next_, frame_start_ + active_period_));
+        }
+        frame_start_ = now;
+    }
+
+    Stage& addStage(std::string name, TickClock::duration budget = {})
+    {
+        auto& stage = stages_.emplace_back();
+        stage.name = std::move(name);
+        stage.budget = budget;
+        return stage;
+    }
+
+    [[nodiscard]] StageTimer time(Stage& stage)
+    {
+        return {*this, stage};
+    }
+
+    // Stages are only ever added during startup
+    const std::deque<Stage>& stages() const
+    {
+        return stages_;
+    }
+
+    const Stage& frame() const
+    {
+        return frame_;
+    }
+
+    void resetStats()
+    {
+        for (auto& stage : stages_) {
+            stage.histogram.reset();
+            stage.over_budget = 0;
+        }
+        frame_.histogram.reset();
+        frame_.over_budget = 0;
+    }
+
+    static TickClock::duration PeriodFromRate(unsigned int fps)
+    {
+        return std::chrono::duration_cast<TickClock::duration>(
+            std::chrono::duration<double>(1.0 / std::max(fps, 1u)));
+    }
+
+  private:
+    TickClock& clock_;
+    Config config_;
+    TickClock::duration active_period_{};
+    TickClock::duration idle_period_{};
+    TickClock::time_point frame_start_;
+    TickClock::time_point next_;
+    TickClock::time_point last_wake_;
+    std::atomic<bool> wake_pending_ = false;
+    bool active_ = true;
+    std::atomic<bool> idle_ = false;
+    std::atomic<unsigned int> current_fps_ = 0;
+    std::atomic<TickClock::duration::rep> frame_budget_ = 0;
+
+    std::deque<Stage> stages_;
+    Stage frame_{"Frame", {}, {}, 0};
+
+    void record(Stage& stage, TickClock::duration d)
+    {
+        stage.histogram.record(d);
+        if (d > budget(stage)) {
+            stage.over_budget.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
@@ -20,7 +20,8 @@ limitations under the License.
 
 #include <algorithm>
 
-HttpServer::HttpServer(std::function<void()> close) : close_(std::move(close))
+HttpServer::HttpServer(std::function<void()> close, std::function<void()> on_change)
+    : close_(std::move(close)), on_change_(std::move(on_change))
 {
 }
 
@@ -119,6 +120,9 @@ void HttpServer::run()
                                     .dump(),
                                 "text/json");
             }
+            if (e.method != GET) {
+                on_change_();
+            }
         });
     }
 
@@ -24,7 +24,8 @@ class AppLauncher;
 class HttpServer {
 
   public:
-    explicit HttpServer(std::function<void()> close);
+    // on_change: called after every non GET request got handled
+    explicit HttpServer(std::function<void()> close, std::function<void()> on_change = [] {});
 
     // C++ enums suck.
     enum Method {
@@ -56,6 +57,7 @@ class HttpServer {
     uint16_t port_ = 8756;
 
     std::function<void()> close_;
+    std::function<void()> on_change_;
 
     static inline std::vector<Endpoint> endpoints_;
 
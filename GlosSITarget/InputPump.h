@@ -0,0 +1,153 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <algorithm>
+#include <memory>
+
+#include "TickClock.h"
+
+namespace InputPump {
+
+/*
+ * Decides when the controller thread polls next
+ *
+ * Deadlines are absolute, so time spent polling/submitting doesn't add up to drift
+ * and the configured rate is actually met.
+ */
+class Pump {
+  public:
+    Pump(TickClock& clock, unsigned int rate_hz)
+        : clock_(clock), period_(PeriodFromRate(rate_hz)), next_(clock.now())
+    {
+    }
+    virtual ~Pump() = default;
+
+    // Called once per poll; blocks until the next poll is due.
+    // input_changed: whether the poll that just happened produced new controller state
+    virtual void wait(bool input_changed) = 0;
+
+    virtual bool isIdle() const
+    {
+        return false;
+    }
+
+    TickClock::duration period() const
+    {
+        return period_;
+    }
+
+    static TickClock::duration PeriodFromRate(unsigned int rate_hz)
+    {
+        return std::chrono::duration_cast<TickClock::duration>(
+            std::chrono::duration<double>(1.0 / std::max(rate_hz, 1u)));
+    }
+
+  protected:
+    void sleepFor(TickClock::duration period)
+    {
+        const auto now = clock_.now();
+        if (now < next_) {
+            // last sleep got cut short by wake(); that early poll replaces the one due at next_
+            next_ = now + period;
+        }
+        else {
+            next_ += period;
+            // don't try to catch up on missed ticks; bursting polls is useless
+            if (next_ < now) {
+                next_ = now;
+            }
+        }
+        clock_.sleepUntil(next_);
+    }
+
+    TickClock& clock_;
+    TickClock::duration period_;
+    TickClock::time_point next_;
+};
+
+/*
+ * Polls at exactly the configured rate, regardless of input
+ */
+class FixedRatePump : public Pump {
+  public:
+    using Pump::Pump;
+
+    void wait(bool) override
+    {
+        sleepFor(period_);
+    }
+};
+
+/*
+ * Polls at the configured rate while input changes
+ * and drops to `idle_rate_hz` after `idle_after` without any change.
+ *
+ * First change after idling switches back to full rate immediately.
+ */
+class ChangeDrivenPump : public Pump {
+  public:
+    ChangeDrivenPump(TickClock& clock, unsigned int rate_hz, unsigned int idle_rate_hz, TickClock::duration idle_after)
+        : Pump(clock, rate_hz), idle_period_(std::max(PeriodFromRate(idle_rate_hz), period_)), idle_after_(idle_after), last_change_(clock.now())
+    {
+    }
+
+    void wait(bool input_changed) override
+    {
+        const auto now = clock_.now();
+        if (input_changed) {
+            last_change_ = now;
+            if (idle_) {
+                idle_ = false;
+                next_ = now;
+            }
+        }
+        else if (!idle_ && now - last_change_ >= idle_after_) {
+            idle_ = true;
+        }
+        sleepFor(idle_ ? idle_period_ : period_);
+    }
+
+    bool isIdle() const override
+    {
+        return idle_;
+    }
+
+  private:
+    TickClock::duration idle_period_;
+    TickClock::duration idle_after_;
+    TickClock::time_point last_change_;
+    bool idle_ = false;
+};
+
+/*
+ * Doesn't wait at all; for replaying recordings at max speed
+ */
+class UnthrottledPump : public Pump {
+  public:
+    explicit UnthrottledPump(TickClock& clock) : Pump(clock, 1) {}
+
+    void wait(bool) override {}
+};
+
+inline std::unique_ptr<Pump> Create(TickClock& clock, unsigned int rate_hz, bool idle_throttle, unsigned int idle_rate_hz)
+{
+    if (idle_throttle) {
+        return std::make_unique<ChangeDrivenPump>(clock, rate_hz, idle_rate_hz, std::chrono::seconds(5));
+    }
+    return std::make_unique<FixedRatePump>(clock, rate_hz);
+}
+
+} // namespace InputPump
@@ -0,0 +1,272 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "MappedFile.h"
+#include "ReplayInputSource.h"
+
+/*
+ * Compact binary controller recordings (*.gsir)
+ *
+ * Layout: FileHeader, followed by records.
+ * Every record is a RecordHeader followed by only the gamepad fields that changed
+ * since the previous record of the same pad (in XINPUT_GAMEPAD order, little endian).
+ * Idle controllers cost nothing, a single button press costs 8 bytes.
+ */
+namespace InputRecording {
+
+constexpr char MAGIC[4] = {'G', 'S', 'I', 'R'};
+constexpr uint16_t VERSION = 1;
+
+#pragma pack(push, 1)
+struct FileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t pad_count;
+};
+
+struct RecordHeader {
+    // since previous record
+    uint32_t delta_us;
+    uint8_t pad;
+    // bit 0-6: fields present; bit 7: connected
+    uint8_t fields;
+};
+#pragma pack(pop)
+
+namespace detail {
+enum Field : uint8_t {
+    BUTTONS = 1 << 0,
+    LEFT_TRIGGER = 1 << 1,
+    RIGHT_TRIGGER = 1 << 2,
+    THUMB_LX = 1 << 3,
+    THUMB_LY = 1 << 4,
+    THUMB_RX = 1 << 5,
+    THUMB_RY = 1 << 6,
+    CONNECTED = 1 << 7,
+};
+
+template <typename T>
+void Put(std::vector<uint8_t>& out, T value)
+{
+    const auto pos = out.size();
+    out.resize(pos + sizeof(T));
+    std::memcpy(out.data() + pos, &value, sizeof(T));
+}
+
+template <typename T>
+bool Get(const uint8_t*& cur, const uint8_t* end, T& value)
+{
+    if (end - cur < static_cast<ptrdiff_t>(sizeof(T))) {
+        return false;
+    }
+    std::memcpy(&value, cur, sizeof(T));
+    cur += sizeof(T);
+    return true;
+}
+} // namespace detail
+
+/*
+ * Appends controller states to a recording
+ * Buffers in memory; only touches the disk every 64KiB and on destruction.
+ */
+class Writer {
+  public:
+    Writer(const std::filesystem::path& path, size_t pad_count)
+        : file_(path, std::ios::binary | std::ios::trunc), pads_(pad_count)
+    {
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.pad_count = static_cast<uint16_t>(pad_count);
+        file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        buffer_.reserve(FLUSH_SIZE + 64);
+    }
+
+    ~Writer()
+    {
+        flush();
+    }
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    bool isOpen() const
+    {
+        return file_.good();
+    }
+
+    // Records the state if it differs from the last one recorded for this pad
+    void append(TickClock::time_point time, size_t pad, bool connected, const Ds4Translation::XusbReport& gamepad)
+    {
+        if (pad >= pads_.size()) {
+            return;
+        }
+        auto& last = pads_[pad];
+        using namespace detail;
+        uint8_t fields = connected ? CONNECTED : 0;
+        if (connected) {
+            fields |= gamepad.wButtons != last.gamepad.wButtons ? BUTTONS : 0;
+            fields |= gamepad.bLeftTrigger != last.gamepad.bLeftTrigger ? LEFT_TRIGGER : 0;
+            fields |= gamepad.bRightTrigger != last.gamepad.bRightTrigger ? RIGHT_TRIGGER : 0;
+            fields |= gamepad.sThumbLX != last.gamepad.sThumbLX ? THUMB_LX : 0;
+            fields |= gamepad.sThumbLY != last.gamepad.sThumbLY ? THUMB_LY : 0;
+            fields |= gamepad.sThumbRX != last.gamepad.sThumbRX ? THUMB_RX : 0;
+            fields |= gamepad.sThumbRY != last.gamepad.sThumbRY ? THUMB_RY : 0;
+        }
+        if (fields == (last.connected ? CONNECTED : 0)) {
+            return;
+        }
+        if (!started_) {
+            started_ = true;
+            last_time_ = time;
+        }
+        const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(time - last_time_).count();
+        last_time_ = time;
+
+        Put(buffer_, RecordHeader{static_cast<uint32_t>(std::clamp<int64_t>(delta, 0, UINT32_MAX)), static_cast<uint8_t>(pad), fields});
+        if (fields & BUTTONS)
+            Put(buffer_, gamepad.wButtons);
+        if (fields & LEFT_TRIGGER)
+            Put(buffer_, gamepad.bLeftTrigger);
+        if (fields & RIGHT_TRIGGER)
+            Put(buffer_, gamepad.bRightTrigger);
+        if (fields & THUMB_LX)
+            Put(buffer_, gamepad.sThumbLX);
+        if (fields & THUMB_LY)
+            Put(buffer_, gamepad.sThumbLY);
+        if (fields & THUMB_RX)
+            Put(buffer_, gamepad.sThumbRX);
+        if (fields & THUMB_RY)
+            Put(buffer_, gamepad.sThumbRY);
+
+        last.connected = connected;
+        if (connected) {
+            last.gamepad = gamepad;
+        }
+        if (buffer_.size() >= FLUSH_SIZE) {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        file_.write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+        file_.flush();
+        buffer_.clear();
+    }
+
+  private:
+    static constexpr size_t FLUSH_SIZE = 64 * 1024;
+
+    struct Pad {
+        bool connected = false;
+        Ds4Translation::XusbReport gamepad{};
+    };
+    std::ofstream file_;
+    std::vector<Pad> pads_;
+    std::vector<uint8_t> buffer_;
+    bool started_ = false;
+    TickClock::time_point last_time_{};
+};
+
+/*
+ * Streams frames straight out of a memory mapped recording
+ */
+class Reader : public ReplayStream {
+  public:
+    explicit Reader(const std::filesystem::path& path) : file_(path)
+    {
+        FileHeader header{};
+        const uint8_t* cur = file_.data();
+        if (cur == nullptr || !detail::Get(cur, cur + file_.size(), header)
+            || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+            return;
+        }
+        valid_ = true;
+        pads_.resize(header.pad_count);
+        rewind();
+    }
+
+    bool isValid() const
+    {
+        return valid_;
+    }
+
+    size_t padCount() const override
+    {
+        return pads_.size();
+    }
+
+    bool next(ReplayFrame& frame) override
+    {
+        using namespace detail;
+        const auto end = file_.data() + file_.size();
+        RecordHeader header{};
+        if (!valid_ || !Get(cur_, end, header) || header.pad >= pads_.size()) {
+            return false;
+        }
+        auto& gamepad = pads_[header.pad];
+        bool ok = true;
+        if (header.fields & BUTTONS)
+            ok &= Get(cur_, end, gamepad.wButtons);
+        if (header.fields & LEFT_TRIGGER)
+            ok &= Get(cur_, end, gamepad.bLeftTrigger);
+        if (header.fields & RIGHT_TRIGGER)
+            ok &= Get(cur_, end, gamepad.bRightTrigger);
+        if (header.fields & THUMB_LX)
+            ok &= Get(cur_, end, gamepad.sThumbLX);
+        if (header.fields & THUMB_LY)
+            ok &= Get(cur_, end, gamepad.sThumbLY);
+        if (header.fields & THUMB_RX)
+            ok &= Get(cur_, end, gamepad.sThumbRX);
+        if (header.fields & THUMB_RY)
+            ok &= Get(cur_, end, gamepad.sThumbRY);
+        if (!ok) {
+            // truncated recording
+            cur_ = end;
+            return false;
+        }
+        time_ += std::chrono::microseconds(header.delta_us);
+        frame.at = time_;
+        frame.pad = header.pad;
+        frame.connected = header.fields & CONNECTED;
+        frame.gamepad = gamepad;
+        return true;
+    }
+
+    void rewind() override
+    {
+        cur_ = file_.data() + sizeof(FileHeader);
+        time_ = {};
+        std::fill(pads_.begin(), pads_.end(), Ds4Translation::XusbReport{});
+    }
+
+  private:
+    MappedFile file_;
+    bool valid_ = false;
+    const uint8_t* cur_ = nullptr;
+    TickClock::duration time_{};
+    std::vector<Ds4Translation::XusbReport> pads_;
+};
+
+} // namespace InputRecording
@@ -15,46 +15,165 @@ limitations under the License.
 */
 #include "InputRedirector.h"
 
-#include <SFML/System/Clock.hpp>
-#include <SFML/System/Sleep.hpp>
+#include <cstring>
+#include <ctime>
+
 #include <spdlog/spdlog.h>
 
+#include "Ds4Translation.h"
+#include "HttpServer.h"
+#include "Profiler.h"
+#include "ReplayInputSource.h"
+#include "StubPadSink.h"
+#include "../common/Settings.h"
+
+#ifdef _WIN32
 #include "Overlay.h"
-#include "..\common\Settings.h"
+#include "ProcessPriority.h"
+#include "ViGEmPadSink.h"
+#include "XInputSource.h"
+#include "XusbInputSource.h"
+
+#pragma comment(lib, "Cfgmgr32.lib")
+
+namespace {
+// {4D1E55B2-F16F-11CF-88CB-001111000030} GUID_DEVINTERFACE_HID, without pulling in hidclass.h / initguid
+// {EC87F1E3-C13B-4100-B5F7-8B84D54260CB} XUSB, missing from the public headers
+constexpr GUID CONTROLLER_INTERFACE_CLASSES[] = {
+    {0x4D1E55B2, 0xF16F, 0x11CF, {0x88, 0xCB, 0x00, 0x11, 0x11, 0x00, 0x00, 0x30}},
+    {0xEC87F1E3, 0xC13B, 0x4100, {0xB5, 0xF7, 0x8B, 0x84, 0xD5, 0x42, 0x60, 0xCB}},
+};
+} // namespace
+#endif
 
-InputRedirector::InputRedirector()
+InputRedirector::InputRedirector(
+    std::unique_ptr<PadSink> sink,
+    std::unique_ptr<TickClock> clock,
+    std::unique_ptr<InputSource> source)
+    : source_(std::move(source)), clock_(std::move(clock)), sink_(std::move(sink))
 {
 #ifdef _WIN32
-    driver_ = vigem_alloc();
-    vigem_connected_ = VIGEM_SUCCESS(vigem_connect(driver_));
-    if (vigem_connected_) {
-        spdlog::debug("Connected to ViGEm");
+    if (!clock_) {
+        auto timer_clock = std::make_unique<WaitableTimerTickClock>();
+        if (!timer_clock->isHighResolution()) {
+            if (timer_clock->raisedTimerResolution()) {
+                spdlog::debug("High resolution waitable timer not available; Raised system timer resolution instead");
+            }
+            else {
+                spdlog::warn("Neither high resolution waitable timer nor raised system timer resolution available; Controller polling is limited to ~64Hz");
+            }
+        }
+        clock_ = std::move(timer_clock);
     }
-    else {
-        spdlog::error("Error initializing ViGEm");
+    if (!sink_) {
+        sink_ = std::make_unique<ViGEmPadSink>();
+    }
+#else
+    if (!clock_) {
+        clock_ = std::make_unique<SteadyTickClock>();
+    }
+    if (!sink_) {
+        sink_ = std::make_unique<StubPadSink>();
     }
 #endif
+
+    HttpServer::AddEndpoint({
+        "/controller-stats",
+        HttpServer::Method::GET,
+        [this](const httplib::Request& req, httplib::Response& res) {
+            nlohmann::json j = {
+                {"reportsForwarded", reports_forwarded_.load()},
+                {"reportsSuppressed", reports_suppressed_.load()},
+                {"keepaliveMs", Settings::controller.keepaliveMs},
+            };
+            j["feedback"] = {
+                {"received", feedback_counters_.received.load()},
+                {"coalesced", feedback_counters_.coalesced.load()},
+                {"dropped", feedback_counters_.dropped.load()},
+                {"applied", feedback_counters_.applied.load()},
+            };
+            j["lightbar"] = nlohmann::json::array();
+            for (size_t i = 0; i < slots_.size(); i++) {
+                const auto fb = slots_[i].feedback.peek();
+                j["lightbar"].push_back(fb.has_lightbar
+                                            ? nlohmann::json{fb.lightbar_red, fb.lightbar_green, fb.lightbar_blue}
+                                            : nlohmann::json(nullptr));
+            }
+            res.set_content(j.dump(), "text/json");
+        },
+        {
+            {"reportsForwarded", 1234},
+            {"reportsSuppressed", 5678},
+            {"keepaliveMs", 500},
+            {"feedback", {
+                {"received", 100},
+                {"coalesced", 60},
+                {"dropped", 0},
+                {"applied", 40},
+            }},
+            {"lightbar", {{0, 0, 64}, nullptr, nullptr, nullptr}},
+        },
+    });
+
+    HttpServer::AddEndpoint({
+        "/controller-latency",
+        HttpServer::Method::GET,
+        [this](const httplib::Request& req, httplib::Response& res) {
+            res.set_content(latencyJson().dump(), "text/json");
+        },
+        {
+            {"poll", {{"count", 1000}, {"p50Us", 12.5}, {"p99Us", 80.0}, {"maxUs", 420.0}}},
+            {"submit", {{"count", 200}, {"p50Us", 40.0}, {"p99Us", 150.0}, {"maxUs", 900.0}}},
+            {"pipeline", {{"count", 200}, {"p50Us", 55.0}, {"p99Us", 230.0}, {"maxUs", 1200.0}}},
+        },
+    });
 }
 
 InputRedirector::~InputRedirector()
 {
 #ifdef _WIN32
+    for (const auto notification : device_notifications_) {
+        if (notification != nullptr) {
+            CM_Unregister_Notification(notification);
+        }
+    }
+#endif
     if (controller_thread_.joinable())
         controller_thread_.join();
-    vigem_disconnect(driver_);
-    vigem_free(driver_);
-#endif
 }
 
 void InputRedirector::run()
 {
-    run_ = vigem_connected_;
+    run_ = sink_->isConnected();
+    if (!source_) {
+        createSource();
+    }
+    slots_.resize(source_->maxPads());
+    presence_.resize(source_->maxPads());
+#ifdef _WIN32
+
+    // Only controller interfaces matter; every other device arrival would just cause a needless rescan
+    for (size_t i = 0; i < device_notifications_.size(); i++) {
+        CM_NOTIFY_FILTER filter{};
+        filter.cbSize = sizeof(filter);
+        filter.FilterType = CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE;
+        filter.u.DeviceInterface.ClassGuid = CONTROLLER_INTERFACE_CLASSES[i];
+        if (const auto res = CM_Register_Notification(&filter, this, &InputRedirector::DeviceNotificationCallback, &device_notifications_[i]);
+            res != CR_SUCCESS) {
+            device_notifications_[i] = nullptr;
+            spdlog::warn("Couldn't register for device notifications ({:#x}); Relying on periodic controller detection", res);
+        }
+    }
+#endif
+    thread_task_ = ThreadPolicy::TaskFromName(Settings::controller.inputThreadTask);
+    thread_affinity_ = Settings::controller.inputThreadAffinity;
     max_controllers_ = Settings::controller.maxControllers;
     if (max_controllers_ < 0) {
-        for (int i = 0; i < XUSER_MAX_COUNT; i++) {
-            XINPUT_STATE state{};
-            if (XInputGetState(i, &state) == ERROR_SUCCESS) {
-                max_controllers_ = i + 1;
+        source_->beginTick();
+        for (size_t i = 0; i < source_->maxPads(); i++) {
+            PadState state;
+            if (source_->poll(i, state)) {
+                max_controllers_ = static_cast<int>(i) + 1;
             }
         }
         if (max_controllers_ < 0) {
@@ -65,6 +184,7 @@ void InputRedirector::run()
             spdlog::info("Auto detected {} controllers", max_controllers_);
         }
     }
+    feedback_wake_clock_ = clock_.get();
     controller_thread_ = std::thread(&InputRedirector::runLoop, this);
 #ifdef _WIN32
     Overlay::AddOverlayElem([this](bool window_has_focus, ImGuiID dockspace_id) {
@@ -75,8 +195,8 @@ void InputRedirector::run()
         ImGui::SameLine();
         ImGui::InputInt("##Max. controller count", &countcopy, 1, 1);
         ImGui::Text("-1 = Auto-detection (auto-detection only works on launch");
-        if (countcopy > XUSER_MAX_COUNT) {
-            countcopy = XUSER_MAX_COUNT;
+        if (countcopy > static_cast<int>(slots_.size())) {
+            countcopy = static_cast<int>(slots_.size());
         }
         if (countcopy < -1) {
             countcopy = -1;
@@ -92,6 +212,23 @@ void InputRedirector::run()
 
         ImGui::Spacing();
 
+        int rate_copy = static_cast<int>(Settings::controller.updateRate);
+        ImGui::Text("Update rate (Hz)");
+        ImGui::SameLine();
+        if (ImGui::InputInt("##Update rate", &rate_copy, 1, 10)) {
+            Settings::controller.updateRate = static_cast<unsigned int>(std::clamp(rate_copy, 30, 1000));
+            pump_settings_changed_ = true;
+        }
+        if (ImGui::Checkbox("Reduce update rate while controllers are idle", &Settings::controller.idleThrottle)) {
+            pump_settings_changed_ = true;
+        }
+        ImGui::Text("Saves CPU, but delays the first input after idling by up to %ums", 1000 / std::max(Settings::controller.idleUpdateRate, 1u));
+        if (pump_idle_) {
+            ImGui::Text("Controllers idle; updating at %u Hz", Settings::controller.idleUpdateRate);
+        }
+
+        ImGui::Spacing();
+
         if (Settings::launch.launch) {
             ImGui::Checkbox("Allow desktop config", &Settings::controller.allowDesktopConfig);
             ImGui::Text("Allows desktop config if the launched application is not focused");
@@ -118,6 +255,77 @@ void InputRedirector::run()
                 controller_settings_changed_ = true;
             }
             Settings::devices.realDeviceIds = use_real_copy;
+
+            ImGui::Spacing();
+            ImGui::Text("Resend unchanged controller state every (ms)");
+            ImGui::SameLine();
+            int keepalive_copy = static_cast<int>(Settings::controller.keepaliveMs);
+            if (ImGui::InputInt("##Keepalive", &keepalive_copy, 100, 500)) {
+                Settings::controller.keepaliveMs = static_cast<unsigned int>(std::max(keepalive_copy, 0));
+            }
+            ImGui::Text("0 = Only send changed state; Some games might need periodic updates");
+
+            ImGui::Spacing();
+            ImGui::Text("Input backend (applies on next launch)");
+            ImGui::SameLine();
+            if (ImGui::BeginCombo("##Input backend", Settings::controller.inputBackend.c_str())) {
+                for (const auto backend : {"XInput", "XUSB"}) {
+                    if (ImGui::Selectable(backend, Settings::controller.inputBackend == backend)) {
+                        Settings::controller.inputBackend = backend;
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            ImGui::Text("Current: %s; XUSB supports more than 4 controllers, but bypasses Steam Input!", source_->name());
+
+            ImGui::Spacing();
+            bool record_copy = record_input_;
+            if (ImGui::Checkbox("Record controller input", &record_copy)) {
+                record_input_ = record_copy;
+            }
+            ImGui::Text("Saved to %%APPDATA%%\\GlosSI\\recordings; Replay by setting \"inputBackend\" to \"Replay\" and \"replayFile\" in the config");
+
+            ImGui::Spacing();
+            ImGui::Text("Controller thread scheduling (MMCSS)");
+            ImGui::SameLine();
+            const ThreadPolicy::Task current_task = thread_task_;
+            if (ImGui::BeginCombo("##Controller thread task", ThreadPolicy::TaskName(current_task))) {
+                for (const auto task : {ThreadPolicy::Task::None, ThreadPolicy::Task::Games, ThreadPolicy::Task::ProAudio}) {
+                    if (ImGui::Selectable(ThreadPolicy::TaskName(task), task == current_task)) {
+                        thread_task_ = task;
+                        Settings::controller.inputThreadTask = ThreadPolicy::TaskName(task);
+                        thread_policy_changed_ = true;
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            ImGui::Text("Controller thread cores (none selected = any)");
+            uint64_t affinity_copy = thread_affinity_;
+            if (ProcessPriority::AffinityEditor("##Controller thread cores", affinity_copy)) {
+                thread_affinity_ = affinity_copy;
+                Settings::controller.inputThreadAffinity = affinity_copy;
+                thread_policy_changed_ = true;
+            }
+        }
+        ImGui::End();
+    });
+    Overlay::AddOverlayElem([this](bool window_has_focus, ImGuiID dockspace_id) {
+        ImGui::SetNextWindowDockID(dockspace_id, ImGuiCond_FirstUseEver);
+        ImGui::Begin("Controller Latency");
+        const auto show = [](const char* label, const LatencyHistogram& hist) {
+            const auto s = hist.summary();
+            const auto us = [](auto d) { return std::chrono::duration<float, std::micro>(d).count(); };
+            ImGui::Text("%-10s p50: %8.1fus  p99: %8.1fus  max: %8.1fus  (%llu)", label, us(s.p50), us(s.p99), us(s.max), s.count);
+        };
+        show("Poll", poll_latency_);
+        show("Submit", submit_latency_);
+        show("Pipeline", pipeline_latency_);
+        ImGui::Text("Poll: XInputGetState; Submit: sending to the emulated controller");
+        ImGui::Text("Pipeline: from polling the controller until the emulated one got updated");
+        if (ImGui::Button("Reset")) {
+            poll_latency_.reset();
+            submit_latency_.reset();
+            pipeline_latency_.reset();
         }
         ImGui::End();
     });
@@ -127,185 +335,314 @@ void InputRedirector::run()
 void InputRedirector::stop()
 {
     run_ = false;
+    feedback_wake_clock_ = nullptr;
+    clock_->wake();
     controller_thread_.join();
-    if (vigem_connected_) {
-        for (const auto& target : vt_pad_) {
-            vigem_target_remove(driver_, target);
-        }
+    for (auto& slot : slots_) {
+        unplugPad(slot);
     }
 }
 
 void InputRedirector::runLoop()
 {
     // wait for steam to do all of it's hooking
-    const sf::Clock clock;
-    while (clock.getElapsedTime().asMilliseconds() < start_delay_ms_) {
-        sf::sleep(sf::milliseconds(20));
-    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(start_delay_ms_));
+    Profiler::SetThreadName("Controller");
+    thread_scheduler_ = ThreadPolicy::Create();
+    applyThreadPolicy();
+    createPump();
     while (run_) {
-#ifdef _WIN32
-        if (controller_settings_changed_) {
-            // unplug all.
-            controller_settings_changed_ = false;
-            for (int i = 0; i < XUSER_MAX_COUNT; i++) {
-                unplugVigemPad(i);
+        bool input_changed = false;
+        {
+            PROFILE_ZONE("Controller tick");
+            if (pump_settings_changed_) {
+                pump_settings_changed_ = false;
+                createPump();
             }
-        }
-        if (max_controllers_ < XUSER_MAX_COUNT) {
-            for (int i = max_controllers_; i < XUSER_MAX_COUNT; i++) {
-                unplugVigemPad(i);
+            if (thread_policy_changed_) {
+                thread_policy_changed_ = false;
+                applyThreadPolicy();
             }
-        }
-        for (int i = 0; i < XUSER_MAX_COUNT && i < max_controllers_; i++) {
-            XINPUT_STATE state{};
-            if (XInputGetState(i, &state) == ERROR_SUCCESS) {
-                if (vt_pad_[i] != nullptr) {
-                    if (Settings::controller.emulateDS4) {
-                        DS4_REPORT rep;
-                        DS4_REPORT_INIT(&rep);
-
-                        // The DualShock 4 expects a different report format, so we call a helper
-                        // function which will translate buttons and axes 1:1 from XUSB to DS4
-                        // format and submit it to the update function afterwards.
-                        XUSB_TO_DS4_REPORT(reinterpret_cast<PXUSB_REPORT>(&state.Gamepad), &rep);
-                        vigem_target_ds4_update(driver_, vt_pad_[i], rep);
-                    }
-                    else {
-                        vigem_target_x360_update(driver_, vt_pad_[i], *reinterpret_cast<XUSB_REPORT*>(&state.Gamepad));
-                    }
+            updateRecorder();
+            if (controller_settings_changed_) {
+                // unplug all.
+                controller_settings_changed_ = false;
+                for (auto& slot : slots_) {
+                    unplugPad(slot);
                 }
-                else {
-                    if (Settings::controller.emulateDS4) {
-                        vt_pad_[i] = vigem_target_ds4_alloc();
-                    }
-                    else {
-                        vt_pad_[i] = vigem_target_x360_alloc();
-                    }
-
-                    // By using VID and PID of Valve's Emulated Controller
-                    // ( https://partner.steamgames.com/doc/features/steam_controller/steam_input_gamepad_emulation_bestpractices )
-                    // Steam doesn't give us ANOTHER "fake" XInput device
-                    // -> Leading to endless pain and suffering.
-                    // Or really, leading to plugging in one virtual controller after another and mirroring inputs
-                    // Also annoying the shit out of the user when they open the overlay as steam prompts to setup new XInput devices
-                    // Also avoiding any fake inputs from Valve's default controller profile
-                    // -> Leading to endless pain and suffering
-                    //
-                    // Additonaly, Steam does pick up the emulated controller this way, and Hides it from our application
-                    // but Steam ONLY does this if it is configured to support X360 controller rebinding!!!
-                    // Otherwise, this application (GloSC/GlosSI) will pickup the emulated controller as well!
-                    // This however is configurable withon GlosSI overlay;
-                    // Multiple controllers can be worked around with by setting max count.
-                    if (!Settings::devices.realDeviceIds) {
-                        vigem_target_set_vid(vt_pad_[i], 0x28de); // VALVE_DIRECTINPUT_GAMEPAD_VID
-                        // vigem_target_set_pid(vt_pad_[i], 0x11FF); //VALVE_DIRECTINPUT_GAMEPAD_PID
-                        if (Settings::controller.emulateDS4) {
-                            vigem_target_set_pid(vt_pad_[i], 0x05C4); // DS4 Controller
-                        }
-                        else {
-                            vigem_target_set_pid(vt_pad_[i], 0x028E); // XBOX 360 Controller
-                        }
+            }
+            for (size_t i = std::max(max_controllers_, 0); i < slots_.size(); i++) {
+                unplugPad(slots_[i]);
+            }
+            for (auto& slot : slots_) {
+                if (const auto feedback = slot.feedback.take()) {
+                    applyFeedback(slot.index, *feedback);
+                }
+            }
+            const auto tick_start = clock_->now();
+            source_->beginTick();
+            presence_.beginTick(tick_start);
+            for (size_t i = 0; i < slots_.size() && i < static_cast<size_t>(std::max(max_controllers_, 0)); i++) {
+                if (!presence_.shouldProbe(i, tick_start)) {
+                    continue;
+                }
+                auto& slot = slots_[i];
+                PadState state;
+                const auto poll_start = std::chrono::steady_clock::now();
+                const bool state_ok = source_->poll(i, state);
+                poll_latency_.record(std::chrono::steady_clock::now() - poll_start);
+                if (recorder_) {
+                    recorder_->append(tick_start, i, state_ok, state.gamepad);
+                }
+                if (presence_.report(i, state_ok, tick_start) == PadPresence::Event::Unplugged) {
+                    unplugPad(slot);
+                }
+                if (!state_ok) {
+                    continue;
+                }
+                const bool packet_changed = state.packet != slot.packet;
+                if (packet_changed) {
+                    slot.packet = state.packet;
+                    input_changed = true;
+                }
+                if (!slot.plugged) {
+                    plugPad(slot);
+                    continue;
+                }
+                const auto now = clock_->now();
+                // packet number only tells that *something* changed; also compare the report itself.
+                // Submitting costs a driver round-trip, so identical reports are skipped.
+                const bool report_changed = packet_changed && std::memcmp(&slot.report, &state.gamepad, sizeof(state.gamepad)) != 0;
+                const bool keepalive_due = Settings::controller.keepaliveMs > 0 && now - slot.last_forward >= std::chrono::milliseconds(Settings::controller.keepaliveMs);
+                if (slot.needs_report || report_changed || keepalive_due) {
+                    const auto submit_start = std::chrono::steady_clock::now();
+                    const bool submitted = sink_->submit(slot.index, state.gamepad);
+                    const auto submit_end = std::chrono::steady_clock::now();
+                    submit_latency_.record(submit_end - submit_start);
+                    if (submitted) {
+                        pipeline_latency_.record(submit_end - poll_start);
+                        slot.report = state.gamepad;
+                        slot.last_forward = now;
+                        slot.needs_report = false;
+                        ++reports_forwarded_;
                     }
                     else {
-                        if (Settings::controller.emulateDS4) {
-                            vigem_target_set_vid(vt_pad_[i], 0x054C); // Sony Corp.
-                            vigem_target_set_pid(vt_pad_[i], 0x05C4); // DS4 Controller
-                        }
-                        else {
-                            vigem_target_set_vid(vt_pad_[i], 0x045E); // MICROSOFT
-                            vigem_target_set_pid(vt_pad_[i], 0x028E); // XBOX 360 Controller
-                        }
-                    }
-                    // TODO: MAYBE!: In a future version, use something like OpenXInput
-                    // and filter out emulated controllers to support a greater amount of controllers simultaneously
-
-                    const int target_add_res = vigem_target_add(driver_, vt_pad_[i]);
-                    if (target_add_res == VIGEM_ERROR_TARGET_UNINITIALIZED) {
-                        if (Settings::controller.emulateDS4) {
-                            vt_pad_[i] = vigem_target_ds4_alloc();
-                        }
-                        else {
-                            vt_pad_[i] = vigem_target_x360_alloc();
-                        }
-                    }
-                    if (target_add_res == VIGEM_ERROR_NONE) {
-                        spdlog::info("Plugged in controller {}, {}; VID: {:x}; PID: {:x}",
-                                     i,
-                                     vigem_target_get_index(vt_pad_[i]),
-                                     vigem_target_get_vid(vt_pad_[i]),
-                                     vigem_target_get_pid(vt_pad_[i]));
-
-                        if (Settings::controller.emulateDS4) {
-                            // TODO: make sense of DS4_OUTPUT_BUFFER
-                            // there is no doc? Ask @Nef about this...
-                            // ReSharper disable once CppDeprecatedEntity
-#pragma warning(disable : 4996)
-                            const auto callback_register_res = vigem_target_ds4_register_notification(
-                                driver_,
-                                vt_pad_[i],
-                                &InputRedirector::ds4ControllerCallback,
-                                reinterpret_cast<LPVOID>(i));
-                            if (!VIGEM_SUCCESS(callback_register_res)) {
-                                spdlog::error("Registering controller {}, {} for notification failed with error code: {:#x}", i, vigem_target_get_index(vt_pad_[i]), callback_register_res);
-                            }
-                        }
-                        else {
-                            const auto callback_register_res = vigem_target_x360_register_notification(
-                                driver_,
-                                vt_pad_[i],
-                                &InputRedirector::x360ControllerCallback,
-                                reinterpret_cast<LPVOID>(i));
-                            if (!VIGEM_SUCCESS(callback_register_res)) {
-                                spdlog::error("Registering controller {}, {} for notification failed with error code: {:#x}", i, vigem_target_get_index(vt_pad_[i]), callback_register_res);
-                            }
+                        // slot.packet already moved on; without this the report would only be retried on the next input change
+                        slot.needs_report = true;
+                        if (!sink_->isPlugged(slot.index)) {
+                            // pad got removed from under us; plug it again next tick
+                            slot.plugged = false;
                         }
                     }
                 }
-            }
-            else {
-                unplugVigemPad(i);
+                else {
+                    ++reports_suppressed_;
+                }
             }
         }
-        Sleep(static_cast<int>(1000.f / Settings::controller.updateRate));
-
-#endif
+        {
+            PROFILE_ZONE("Wait for next tick");
+            pump_->wait(input_changed);
+        }
+        pump_idle_ = pump_->isIdle();
     }
+    thread_scheduler_->revert();
 }
 
-#ifdef _WIN32
-void InputRedirector::x360ControllerCallback(PVIGEM_CLIENT client, PVIGEM_TARGET Target, UCHAR LargeMotor, UCHAR SmallMotor, UCHAR LedNumber, LPVOID UserData)
+nlohmann::json InputRedirector::latencyJson() const
 {
-    if (!enable_rumble_) {
+    const auto to_json = [](const LatencyHistogram& hist) {
+        const auto s = hist.summary();
+        const auto us = [](auto d) { return std::chrono::duration<double, std::micro>(d).count(); };
+        return nlohmann::json{
+            {"count", s.count},
+            {"p50Us", us(s.p50)},
+            {"p99Us", us(s.p99)},
+            {"maxUs", us(s.max)},
+        };
+    };
+    return {
+        {"poll", to_json(poll_latency_)},
+        {"submit", to_json(submit_latency_)},
+        {"pipeline", to_json(pipeline_latency_)},
+    };
+}
+
+void InputRedirector::createPump()
+{
+    if (!source_->realTime()) {
+        pump_ = std::make_unique<InputPump::UnthrottledPump>(*clock_);
+        spdlog::debug("Polling controllers as fast as possible");
         return;
     }
-    XINPUT_VIBRATION vibration;
-    ZeroMemory(&vibration, sizeof(XINPUT_VIBRATION));
-    vibration.wLeftMotorSpeed = LargeMotor * 257;
-    vibration.wRightMotorSpeed = SmallMotor * 257;
+    pump_ = InputPump::Create(
+        *clock_,
+        Settings::controller.updateRate,
+        Settings::controller.idleThrottle,
+        Settings::controller.idleUpdateRate);
+    if (Settings::controller.idleThrottle) {
+        spdlog::debug("Polling controllers at {}Hz; {}Hz when idle", Settings::controller.updateRate, Settings::controller.idleUpdateRate);
+    }
+    else {
+        spdlog::debug("Polling controllers at {}Hz", Settings::controller.updateRate);
+    }
+}
 
-    XInputSetState(reinterpret_cast<int>(UserData), &vibration);
+void InputRedirector::createSource()
+{
+    if (Settings::controller.inputBackend == "Replay") {
+        auto recording = std::make_unique<InputRecording::Reader>(Settings::controller.replayFile);
+        if (recording->isValid()) {
+            source_ = std::make_unique<ReplayInputSource>(
+                *clock_,
+                std::move(recording),
+                Settings::controller.replayMaxSpeed ? ReplayInputSource::Speed::MaxSpeed : ReplayInputSource::Speed::RealTime,
+                Settings::controller.replayLoop);
+            spdlog::info("Replaying controller recording \"{}\"", util::string::to_string(Settings::controller.replayFile));
+            return;
+        }
+        spdlog::error("Couldn't open controller recording \"{}\"", util::string::to_string(Settings::controller.replayFile));
+    }
+#ifdef _WIN32
+    if (Settings::controller.inputBackend == "XUSB") {
+        // skip our own emulated x360 controllers; see plugVigemPad
+        if (Settings::devices.realDeviceIds) {
+            spdlog::warn("XUSB backend with real USB-IDs can't tell real Xbox 360 controllers from emulated ones");
+        }
+        source_ = std::make_unique<XusbInputSource>(Settings::devices.realDeviceIds ? 0x045E : 0x28DE, 0x028E);
+    }
+    else {
+        source_ = std::make_unique<XInputSource>();
+    }
+#else
+    source_ = std::make_unique<ReplayInputSource>(*clock_, std::vector<ReplayFrame>{});
+#endif
+    spdlog::debug("Using {} input backend with {} controller slots", source_->name(), source_->maxPads());
 }
 
-void InputRedirector::unplugVigemPad(int idx)
+void InputRedirector::updateRecorder()
 {
-    if (vt_pad_[idx] != nullptr) {
-        if (VIGEM_SUCCESS(vigem_target_remove(driver_, vt_pad_[idx]))) {
-            spdlog::info("Unplugged controller {}, {}", idx, vigem_target_get_index(vt_pad_[idx]));
-            vt_pad_[idx] = nullptr;
+    if (record_input_ && !recorder_) {
+        const auto dir = util::path::getDataDirPath() / "recordings";
+        std::filesystem::create_directories(dir);
+        const auto path = dir / ("controller_" + std::to_string(std::time(nullptr)) + ".gsir");
+        recorder_ = std::make_unique<InputRecording::Writer>(path, source_->maxPads());
+        if (recorder_->isOpen()) {
+            spdlog::info("Recording controller input to \"{}\"", path.string());
+        }
+        else {
+            spdlog::error("Couldn't create controller recording \"{}\"", path.string());
+            recorder_.reset();
+            record_input_ = false;
         }
     }
+    else if (!record_input_ && recorder_) {
+        recorder_.reset();
+        spdlog::info("Stopped recording controller input");
+    }
+}
+
+void InputRedirector::applyThreadPolicy()
+{
+    // has to run on the controller thread itself
+    const ThreadPolicy::Policy policy{thread_task_, thread_affinity_};
+    if (thread_scheduler_->apply(policy)) {
+        spdlog::debug("Controller thread scheduling: {}; cores: {:#x}", ThreadPolicy::TaskName(policy.task), policy.affinity_mask);
+    }
 }
 
-void InputRedirector::ds4ControllerCallback(PVIGEM_CLIENT client, PVIGEM_TARGET Target, UCHAR LargeMotor, UCHAR SmallMotor, DS4_LIGHTBAR_COLOR LightbarColor, LPVOID UserData)
+#ifdef _WIN32
+DWORD CALLBACK InputRedirector::DeviceNotificationCallback(HCMNOTIFICATION notification, PVOID context, CM_NOTIFY_ACTION action, PCM_NOTIFY_EVENT_DATA event_data, DWORD event_data_size)
 {
+    if (action == CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL) {
+        auto self = static_cast<InputRedirector*>(context);
+        self->source_->devicesChanged();
+        self->presence_.rescan();
+        self->clock_->wake();
+    }
+    return ERROR_SUCCESS;
+}
+#endif
+
+void InputRedirector::PostFeedback(void* slot, const Feedback::State& state)
+{
+    ++feedback_counters_.received;
+    if (static_cast<PadSlot*>(slot)->feedback.push(state)) {
+        ++feedback_counters_.coalesced;
+    }
+    if (const auto clock = feedback_wake_clock_.load()) {
+        clock->wake();
+    }
+}
+
+void InputRedirector::applyFeedback(size_t idx, const Feedback::State& state)
+{
+    // none of the sources have a way to set the lightbar; it's only kept around (see peek()) for the stats endpoint
     if (!enable_rumble_) {
+        ++feedback_counters_.dropped;
         return;
     }
-    XINPUT_VIBRATION vibration;
-    ZeroMemory(&vibration, sizeof(XINPUT_VIBRATION));
-    vibration.wLeftMotorSpeed = LargeMotor * 257;
-    vibration.wRightMotorSpeed = SmallMotor * 257;
+    if (source_->setVibration(idx, state.large_motor, state.small_motor)) {
+        ++feedback_counters_.applied;
+    }
+    else {
+        ++feedback_counters_.dropped;
+    }
+}
+
+void InputRedirector::plugPad(PadSlot& slot)
+{
+    PadSink::Config config;
+    config.type = Settings::controller.emulateDS4 ? PadSink::Type::DS4 : PadSink::Type::X360;
 
-    XInputSetState(reinterpret_cast<int>(UserData), &vibration);
+    // By using VID and PID of Valve's Emulated Controller
+    // ( https://partner.steamgames.com/doc/features/steam_controller/steam_input_gamepad_emulation_bestpractices )
+    // Steam doesn't give us ANOTHER "fake" XInput device
+    // -> Leading to endless pain and suffering.
+    // Or really, leading to plugging in one virtual controller after another and mirroring inputs
+    // Also annoying the shit out of the user when they open the overlay as steam prompts to setup new XInput devices
+    // Also avoiding any fake inputs from Valve's default controller profile
+    // -> Leading to endless pain and suffering
+    //
+    // Additonaly, Steam does pick up the emulated controller this way, and Hides it from our application
+    // but Steam ONLY does this if it is configured to support X360 controller rebinding!!!
+    // Otherwise, this application (GloSC/GlosSI) will pickup the emulated controller as well!
+    // This however is configurable withon GlosSI overlay;
+    // Multiple controllers can be worked around with by setting max count.
+    if (!Settings::devices.realDeviceIds) {
+        config.vid = 0x28de; // VALVE_DIRECTINPUT_GAMEPAD_VID
+        // config.pid = 0x11FF; //VALVE_DIRECTINPUT_GAMEPAD_PID
+        if (Settings::controller.emulateDS4) {
+            config.pid = 0x05C4; // DS4 Controller
+        }
+        else {
+            config.pid = 0x028E; // XBOX 360 Controller
+        }
+    }
+    else {
+        if (Settings::controller.emulateDS4) {
+            config.vid = 0x054C; // Sony Corp.
+            config.pid = 0x05C4; // DS4 Controller
+        }
+        else {
+            config.vid = 0x045E; // MICROSOFT
+            config.pid = 0x028E; // XBOX 360 Controller
+        }
+    }
+    // More than 4 controllers: see XusbInputSource (OpenXInput style, filters out emulated controllers by VID/PID)
+
+    // rumble/LEDs left over from the previous pad in this slot must not reach the new one
+    slot.feedback.reset();
+    if (sink_->plug(slot.index, config, &InputRedirector::PostFeedback, &slot)) {
+        slot.plugged = true;
+        slot.needs_report = true;
+    }
+}
+
+void InputRedirector::unplugPad(PadSlot& slot)
+{
+    if (slot.plugged && sink_->unplug(slot.index)) {
+        slot.plugged = false;
+        slot.feedback.reset();
+    }
 }
-#endif
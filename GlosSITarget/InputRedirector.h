@@ -14,19 +14,37 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #pragma once
+#include <array>
+#include <memory>
 #include <thread>
+
+#include <nlohmann/json.hpp>
+
+#include "FeedbackMailbox.h"
+#include "InputPump.h"
+#include "InputRecording.h"
+#include "InputSource.h"
+#include "LatencyHistogram.h"
+#include "PadPresence.h"
+#include "PadSink.h"
+#include "SlotPool.h"
+#include "ThreadPolicy.h"
 #ifdef _WIN32
 #define NOMINMAX
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
-#include <Xinput.h>
-#include <ViGEm/Client.h>
-#include <ViGEm/Util.h>
+#include <cfgmgr32.h>
 #endif
 
 class InputRedirector {
   public:
-    InputRedirector();
+    // sink: where emulated controllers go; nullptr = ViGEm (in-process stub when not on Windows)
+    // clock: paces and timestamps the controller thread; nullptr = waitable timer (steady clock when not on Windows)
+    // source: nullptr = picked from Settings::controller.inputBackend on run()
+    explicit InputRedirector(
+        std::unique_ptr<PadSink> sink = nullptr,
+        std::unique_ptr<TickClock> clock = nullptr,
+        std::unique_ptr<InputSource> source = nullptr);
     ~InputRedirector();
 
     void run();
@@ -35,26 +53,75 @@ class InputRedirector {
   private:
     void runLoop();
 
+    std::unique_ptr<InputSource> source_;
+    void createSource();
+
+    // written on the controller thread only; toggled via record_input_
+    std::unique_ptr<InputRecording::Writer> recorder_;
+    static inline std::atomic<bool> record_input_ = false;
+    void updateRecorder();
+
     int max_controllers_ = -1;
     static constexpr int start_delay_ms_ = 2000;
     bool run_ = false;
     int overlay_elem_id_ = -1;
-#ifdef _WIN32
-    PVIGEM_CLIENT driver_;
+
+    std::unique_ptr<TickClock> clock_;
+    std::unique_ptr<InputPump::Pump> pump_;
+    std::atomic<bool> pump_idle_ = false;
+    void createPump();
+
+    std::unique_ptr<ThreadPolicy::Scheduler> thread_scheduler_;
+    // set by the overlay, applied on the controller thread; Settings::controller only keeps them for the config file
+    static inline std::atomic<ThreadPolicy::Task> thread_task_ = ThreadPolicy::Task::None;
+    static inline std::atomic<uint64_t> thread_affinity_ = 0;
+    static inline std::atomic<bool> thread_policy_changed_ = false;
+    void applyThreadPolicy();
+
+    std::atomic<uint64_t> reports_forwarded_ = 0;
+    std::atomic<uint64_t> reports_suppressed_ = 0;
+
+    // InputSource::poll; PadSink::submit; poll start -> report submitted
+    LatencyHistogram poll_latency_;
+    LatencyHistogram submit_latency_;
+    LatencyHistogram pipeline_latency_;
+    nlohmann::json latencyJson() const;
 
     // variables for overlay element; run in different thread
     static inline std::atomic<bool> enable_rumble_ = true;
     static inline std::atomic<bool> controller_settings_changed_ = false;
+    static inline std::atomic<bool> pump_settings_changed_ = false;
 
-    bool vigem_connected_;
+    std::unique_ptr<PadSink> sink_;
 
-    PVIGEM_TARGET vt_pad_[XUSER_MAX_COUNT]{};
-    static void CALLBACK x360ControllerCallback(PVIGEM_CLIENT client, PVIGEM_TARGET Target, UCHAR LargeMotor, UCHAR SmallMotor, UCHAR LedNumber, LPVOID UserData);
-    void unplugVigemPad(int idx);
+    struct PadSlot {
+        size_t index = 0;
+        bool plugged = false;
+        // Last state forwarded to the sink; reports are only submitted if they actually changed (or keepalive is due)
+        uint32_t packet = 0;
+        Ds4Translation::XusbReport report{};
+        TickClock::time_point last_forward{};
+        bool needs_report = true;
+        // Sink callbacks only post feedback; forwarding to the real device happens on the controller thread
+        Feedback::Mailbox feedback;
+    };
+    // sized by the input source; slots are stable, their address is passed as sink feedback context
+    SlotPool<PadSlot> slots_;
+    // only polls connected slots every tick; empty ones get re-probed on backoff or on device arrival
+    PadPresence::Tracker presence_;
+#ifdef _WIN32
+    // one per watched interface class (HID, XUSB)
+    std::array<HCMNOTIFICATION, 2> device_notifications_{};
+    static DWORD CALLBACK DeviceNotificationCallback(HCMNOTIFICATION notification, PVOID context, CM_NOTIFY_ACTION action, PCM_NOTIFY_EVENT_DATA event_data, DWORD event_data_size);
+#endif
 
-    static void CALLBACK ds4ControllerCallback(PVIGEM_CLIENT client, PVIGEM_TARGET Target, UCHAR LargeMotor, UCHAR SmallMotor, DS4_LIGHTBAR_COLOR LightbarColor, LPVOID UserData);
+    static inline Feedback::Counters feedback_counters_;
+    static inline std::atomic<TickClock*> feedback_wake_clock_ = nullptr;
+    static void PostFeedback(void* slot, const Feedback::State& state);
+    void applyFeedback(size_t idx, const Feedback::State& state);
 
-#endif
+    void plugPad(PadSlot& slot);
+    void unplugPad(PadSlot& slot);
 
     std::thread controller_thread_;
 };
@@ -0,0 +1,62 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "Ds4Translation.h"
+
+struct PadState {
+    // changes whenever the gamepad state changed (same semantics as XINPUT_STATE::dwPacketNumber)
+    uint32_t packet = 0;
+    // XINPUT_GAMEPAD layout
+    Ds4Translation::XusbReport gamepad{};
+};
+
+/*
+ * Where InputRedirector reads controllers from
+ *
+ * Slots are 0 based and stable; a source may report up to maxPads() of them.
+ * All functions are only called from the controller thread, except devicesChanged()
+ */
+class InputSource {
+  public:
+    virtual ~InputSource() = default;
+
+    virtual const char* name() const = 0;
+
+    virtual size_t maxPads() const = 0;
+
+    // Called once per tick, before any poll()
+    virtual void beginTick() {}
+
+    // Returns false if there is no controller in that slot (currently)
+    virtual bool poll(size_t idx, PadState& state) = 0;
+
+    virtual bool setVibration([[maybe_unused]] size_t idx, [[maybe_unused]] uint8_t large_motor, [[maybe_unused]] uint8_t small_motor)
+    {
+        return false;
+    }
+
+    // Some device got plugged in; may be called from any thread
+    virtual void devicesChanged() {}
+
+    // false: source wants to be polled as fast as possible (benchmarking)
+    virtual bool realTime() const
+    {
+        return true;
+    }
+};
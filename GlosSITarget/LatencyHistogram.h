@@ -0,0 +1,137 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+
+/*
+ * Fixed size, lock-free latency histogram (HDR-style log-linear buckets)
+ *
+ * Every power of two is split into 16 linear sub-buckets, so reported values are within ~6% of the real ones
+ * across the whole range with less than 1000 counters.
+ * Recording is a couple of shifts and a relaxed atomic increment; cheap enough to do on every controller poll.
+ * Any thread may record/read concurrently. Readers may see a slightly torn (but never corrupt) state.
+ */
+class LatencyHistogram {
+  public:
+    using duration = std::chrono::nanoseconds;
+
+    struct Summary {
+        uint64_t count = 0;
+        duration p50{};
+        duration p99{};
+        duration max{};
+    };
+
+    void record(duration d)
+    {
+        const auto v = static_cast<uint64_t>(std::max<int64_t>(d.count(), 0));
+        buckets_[BucketIndex(v)].fetch_add(1, std::memory_order_relaxed);
+        auto cur_max = max_.load(std::memory_order_relaxed);
+        while (v > cur_max && !max_.compare_exchange_weak(cur_max, v, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Upper bound of the bucket containing the given percentile (0..100)
+    duration percentile(double p) const
+    {
+        std::array<uint64_t, BUCKET_COUNT> counts;
+        uint64_t total = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            counts[i] = buckets_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        return PercentileOf(counts, total, p);
+    }
+
+    Summary summary() const
+    {
+        std::array<uint64_t, BUCKET_COUNT> counts;
+        Summary s;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            counts[i] = buckets_[i].load(std::memory_order_relaxed);
+            s.count += counts[i];
+        }
+        s.p50 = PercentileOf(counts, s.count, 50.0);
+        s.p99 = PercentileOf(counts, s.count, 99.0);
+        s.max = duration(max_.load(std::memory_order_relaxed));
+        // bucket upper bounds can overshoot the real max
+        s.p50 = std::min(s.p50, s.max);
+        s.p99 = std::min(s.p99, s.max);
+        return s;
+    }
+
+    void reset()
+    {
+        for (auto& b : buckets_) {
+            b.store(0, std::memory_order_relaxed);
+        }
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    static constexpr uint64_t SUB_BUCKET_BITS = 4;
+    static constexpr uint64_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    static constexpr size_t BucketIndex(uint64_t v)
+    {
+        // values below 2*SUB_BUCKETS get exact buckets
+        if (v < 2 * SUB_BUCKETS) {
+            return static_cast<size_t>(v);
+        }
+        const uint64_t shift = std::bit_width(v) - 1 - SUB_BUCKET_BITS;
+        return static_cast<size_t>(shift * SUB_BUCKETS + (v >> shift));
+    }
+
+    static constexpr uint64_t BucketUpperBound(size_t idx)
+    {
+        if (idx < 2 * SUB_BUCKETS) {
+            return idx;
+        }
+        const uint64_t shift = idx / SUB_BUCKETS - 1;
+        const uint64_t sub = idx % SUB_BUCKETS + SUB_BUCKETS;
+        return (sub << shift) + ((uint64_t{1} << shift) - 1);
+    }
+
+  private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+    std::atomic<uint64_t> max_ = 0;
+
+    static duration PercentileOf(const std::array<uint64_t, BUCKET_COUNT>& counts, uint64_t total, double p)
+    {
+        if (total == 0) {
+            return duration::zero();
+        }
+        const auto target = static_cast<uint64_t>(std::max(1.0, p / 100.0 * static_cast<double>(total) + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            seen += counts[i];
+            if (seen >= target) {
+                return duration(BucketUpperBound(i));
+            }
+        }
+        return duration(BucketUpperBound(BUCKET_COUNT - 1));
+    }
+};
+
+static_assert(LatencyHistogram::BucketIndex(31) == 31);
+static_assert(LatencyHistogram::BucketIndex(32) == 32);
+static_assert(LatencyHistogram::BucketUpperBound(32) == 33);
+static_assert(LatencyHistogram::BucketIndex(~uint64_t{0}) == LatencyHistogram::BUCKET_COUNT - 1);
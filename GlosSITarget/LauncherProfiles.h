@@ -0,0 +1,220 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <algorithm>
+#include <cwctype>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ProcessTree.h"
+
+/*
+ * Tells launcher (store client) processes apart from the game they launched
+ *
+ * A profile becomes active when its launch pattern matches what GlosSI launched (path/URL + args).
+ * For active profiles, a process counts as launcher if (exe names compare whole and case insensitive)
+ *  - its exe name is one of the profile's processes, or
+ *  - its exe name is one of the profile's helpers and it was started by a launcher process,
+ *    directly or through other helpers (web renderers and the like also show up under games).
+ * Everything else tracked is considered part of the game.
+ */
+namespace LauncherProfiles {
+
+struct Profile {
+    std::string name;
+    // ECMAScript, case insensitive; empty: always active
+    std::wstring launch_pattern;
+    // first one is looked for if launching didn't return a PID
+    std::vector<std::wstring> processes;
+    std::vector<std::wstring> helpers;
+};
+
+inline std::vector<Profile> BuiltIn()
+{
+    return {
+        {"Epic Games",
+         LR"(epicgames\.launcher|EpicGamesLauncher\.exe)",
+         {L"EpicGamesLauncher.exe", L"EpicWebHelper.exe"},
+         {}},
+        {"Ubisoft Connect",
+         LR"(^uplay:|upc\.exe|UbisoftConnect\.exe)",
+         {L"upc.exe", L"UbisoftConnect.exe", L"UplayWebCore.exe", L"UbisoftGameLauncher.exe", L"UbisoftGameLauncher64.exe"},
+         {L"QtWebEngineProcess.exe"}},
+        {"EA app",
+         LR"(^(origin2?|link2ea):|EADesktop\.exe|EALaunchHelper\.exe|Origin\.exe)",
+         {L"EADesktop.exe", L"EABackgroundService.exe", L"EALauncher.exe", L"EALaunchHelper.exe", L"EALocalHostSvc.exe", L"Origin.exe", L"OriginWebHelperService.exe"},
+         {L"QtWebEngineProcess.exe"}},
+        {"Battle.net",
+         LR"(^battlenet:|Battle\.net(Launcher)?\.exe)",
+         {L"Battle.net.exe", L"Battle.net Launcher.exe", L"Agent.exe"},
+         {L"BlizzardBrowser.exe", L"Battle.net Helper.exe"}},
+    };
+}
+
+namespace detail {
+inline std::wstring Lower(std::wstring_view str)
+{
+    std::wstring res(str);
+    std::ranges::transform(res, res.begin(), [](wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+    return res;
+}
+} // namespace detail
+
+class Matcher {
+  public:
+    Matcher() = default;
+
+    explicit Matcher(std::vector<Profile> profiles)
+    {
+        profiles_.reserve(profiles.size());
+        for (auto& profile : profiles) {
+            Compiled compiled{std::move(profile), std::wregex{}, false};
+            if (!compiled.profile.launch_pattern.empty()) {
+                compiled.pattern = std::wregex(compiled.profile.launch_pattern, std::regex::ECMAScript | std::regex::icase | std::regex::optimize);
+            }
+            profiles_.push_back(std::move(compiled));
+        }
+    }
+
+    // Activates all profiles matching the launched command; returns true if any did
+    bool activate(std::wstring_view launch_command)
+    {
+        bool matched = false;
+        for (auto& compiled : profiles_) {
+            if (compiled.active || compiled.profile.processes.empty()) {
+                continue;
+            }
+            if (compiled.profile.launch_pattern.empty()
+                || std::regex_search(launch_command.begin(), launch_command.end(), compiled.pattern)) {
+                compiled.active = true;
+                matched = true;
+                for (const auto& process : compiled.profile.processes) {
+                    processes_.insert(detail::Lower(process));
+                }
+                for (const auto& helper : compiled.profile.helpers) {
+                    helpers_.insert(detail::Lower(helper));
+                }
+            }
+        }
+        if (matched) {
+            cache_.clear();
+        }
+        return matched;
+    }
+
+    bool active() const
+    {
+        return !processes_.empty();
+    }
+
+    std::vector<std::string> activeNames() const
+    {
+        std::vector<std::string> res;
+        for (const auto& compiled : profiles_) {
+            if (compiled.active) {
+                res.push_back(compiled.profile.name);
+            }
+        }
+        return res;
+    }
+
+    // Main launcher executables of all active profiles
+    std::vector<std::wstring> mainProcesses() const
+    {
+        std::vector<std::wstring> res;
+        for (const auto& compiled : profiles_) {
+            if (compiled.active) {
+                res.push_back(compiled.profile.processes.front());
+            }
+        }
+        return res;
+    }
+
+    // Cached per PID; a PID is re-classified if its exe name changed (PID reuse)
+    bool isLauncher(const ProcessTree::Index& tree, ProcessTree::Pid pid)
+    {
+        if (!active()) {
+            return false;
+        }
+        const auto& name = tree.name(pid);
+        if (name.empty()) {
+            return false;
+        }
+        if (const auto it = cache_.find(pid); it != cache_.end() && it->second.name == name) {
+            return it->second.launcher;
+        }
+        const auto launcher = classify(tree, pid, name);
+        cache_.insert_or_assign(pid, Cached{name, launcher});
+        return launcher;
+    }
+
+    void forget(ProcessTree::Pid pid)
+    {
+        cache_.erase(pid);
+    }
+
+  private:
+    struct Compiled {
+        Profile profile;
+        std::wregex pattern;
+        bool active = false;
+    };
+    struct Cached {
+        std::wstring name;
+        bool launcher = false;
+    };
+    static constexpr int MAX_ANCESTORS = 16;
+
+    std::vector<Compiled> profiles_;
+    // lowercase exe names of active profiles
+    std::unordered_set<std::wstring> processes_;
+    std::unordered_set<std::wstring> helpers_;
+    std::unordered_map<ProcessTree::Pid, Cached> cache_;
+
+    bool classify(const ProcessTree::Index& tree, ProcessTree::Pid pid, const std::wstring& name) const
+    {
+        const auto lower = detail::Lower(name);
+        if (processes_.contains(lower)) {
+            return true;
+        }
+        if (!helpers_.contains(lower)) {
+            return false;
+        }
+        auto ancestor = pid;
+        for (int i = 0; i < MAX_ANCESTORS; i++) {
+            const auto parent = tree.parent(ancestor);
+            if (parent == 0 || parent == ancestor) {
+                break;
+            }
+            const auto parent_name = detail::Lower(tree.name(parent));
+            if (processes_.contains(parent_name)) {
+                return true;
+            }
+            // started by the game (or anything else)
+            if (!helpers_.contains(parent_name)) {
+                return false;
+            }
+            ancestor = parent;
+        }
+        return false;
+    }
+};
+
+} // namespace LauncherProfiles
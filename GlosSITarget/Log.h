@@ -0,0 +1,150 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+/*
+ * Thin logging macros for hot paths
+ *
+ * Arguments are only evaluated if the line actually gets logged;
+ * a disabled line costs one load and a branch (< 1ns, see tests/LogBenchmarks.cpp).
+ *
+ * GLOSSI_TRACE/GLOSSI_DEBUG:   gated by the logger level
+ * GLOSSI_EXT_*(category, ...): additionally need "extended logging" enabled for that category
+ *
+ * Define GLOSSI_LOG_ACTIVE_LEVEL (SPDLOG_LEVEL_*) to compile out everything below it.
+ */
+#ifndef GLOSSI_LOG_ACTIVE_LEVEL
+#define GLOSSI_LOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+
+namespace Log {
+
+enum Category : uint32_t {
+    // window messages, overlay detection, foreground window
+    WINDOW = 1 << 0,
+    // launched processes and their children
+    PROCESS = 1 << 1,
+    // controller input
+    INPUT = 1 << 2,
+    HTTP = 1 << 3,
+    ALL = 0xFFFFFFFF,
+};
+
+inline std::atomic<uint32_t> extended_categories = 0;
+
+// Lowest level a GLOSSI_* line can pass; lets disabled lines skip the default logger lookup.
+// Only a pre-filter, the logger's own level still applies. Raised/lowered by SetLevel().
+inline std::atomic<int> min_level = SPDLOG_LEVEL_TRACE;
+
+// spdlog::set_level() + min_level
+inline void SetLevel(spdlog::level::level_enum level)
+{
+    spdlog::set_level(level);
+    min_level.store(level, std::memory_order_relaxed);
+}
+
+inline bool ExtendedEnabled(Category category)
+{
+    return extended_categories.load(std::memory_order_relaxed) & category;
+}
+
+// categories: comma separated ("window,process"); empty = all
+inline void SetExtended(bool enabled, std::string_view categories = {})
+{
+    if (!enabled) {
+        extended_categories = 0;
+        return;
+    }
+    if (categories.empty()) {
+        extended_categories = ALL;
+        return;
+    }
+    constexpr std::pair<std::string_view, Category> names[] = {
+        {"window", WINDOW},
+        {"process", PROCESS},
+        {"input", INPUT},
+        {"http", HTTP},
+        {"all", ALL},
+    };
+    uint32_t mask = 0;
+    while (!categories.empty()) {
+        const auto end = categories.find(',');
+        auto name = categories.substr(0, end);
+        categories = end == std::string_view::npos ? std::string_view{} : categories.substr(end + 1);
+        while (!name.empty() && name.front() == ' ') {
+            name.remove_prefix(1);
+        }
+        while (!name.empty() && name.back() == ' ') {
+            name.remove_suffix(1);
+        }
+        bool found = false;
+        for (const auto& [n, category] : names) {
+            if (name == n) {
+                mask |= category;
+                found = true;
+            }
+        }
+        if (!found && !name.empty()) {
+            spdlog::warn("Unknown extended log category \"{}\"", name);
+        }
+    }
+    extended_categories = mask;
+}
+
+} // namespace Log
+
+#define GLOSSI_LOG(level, ...)                                                               \
+    do {                                                                                     \
+        if (static_cast<int>(level) >= ::Log::min_level.load(std::memory_order_relaxed)      \
+            && spdlog::default_logger_raw()->should_log(level)) {                            \
+            spdlog::default_logger_raw()->log(level, __VA_ARGS__);                           \
+        }                                                                                    \
+    } while (0)
+
+#define GLOSSI_LOG_EXT(category, level, ...)     \
+    do {                                         \
+        if (::Log::ExtendedEnabled(category)) {  \
+            GLOSSI_LOG(level, __VA_ARGS__);      \
+        }                                        \
+    } while (0)
+
+#if GLOSSI_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define GLOSSI_TRACE(...) GLOSSI_LOG(spdlog::level::trace, __VA_ARGS__)
+#define GLOSSI_EXT_TRACE(category, ...) GLOSSI_LOG_EXT(category, spdlog::level::trace, __VA_ARGS__)
+#else
+#define GLOSSI_TRACE(...) (void)0
+#define GLOSSI_EXT_TRACE(category, ...) (void)0
+#endif
+
+#if GLOSSI_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define GLOSSI_DEBUG(...) GLOSSI_LOG(spdlog::level::debug, __VA_ARGS__)
+#define GLOSSI_EXT_DEBUG(category, ...) GLOSSI_LOG_EXT(category, spdlog::level::debug, __VA_ARGS__)
+#else
+#define GLOSSI_DEBUG(...) (void)0
+#define GLOSSI_EXT_DEBUG(category, ...) (void)0
+#endif
+
+#if GLOSSI_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define GLOSSI_EXT_INFO(category, ...) GLOSSI_LOG_EXT(category, spdlog::level::info, __VA_ARGS__)
+#else
+#define GLOSSI_EXT_INFO(category, ...) (void)0
+#endif
@@ -0,0 +1,198 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <spdlog/common.h>
+
+/*
+ * Fixed size, lock free log store
+ *
+ * Any thread may push(); lines are copied into inline per-slot storage (truncated to PAYLOAD_SIZE),
+ * so logging never allocates and memory use is constant no matter how long GlosSI runs.
+ * Once full, the oldest lines get overwritten.
+ *
+ * Every line gets a running sequence number; readers keep a cursor and only copy what's new.
+ * Slots are guarded by a seqlock, a reader racing a writer that lapped it just sees the line as lost.
+ * Writers claim a slot before touching it, so a writer that got lapped mid-line can't clobber the newer one;
+ * push() only ever waits when a whole ring's worth of lines got logged while another push() was in progress.
+ */
+template <size_t CAPACITY = 1024, size_t PAYLOAD_SIZE = 256>
+class LogRing {
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+    static_assert(PAYLOAD_SIZE % sizeof(uint64_t) == 0);
+
+  public:
+    static constexpr size_t capacity = CAPACITY;
+    static constexpr size_t max_payload = PAYLOAD_SIZE;
+
+    void push(std::chrono::system_clock::time_point time, spdlog::level::level_enum level, std::string_view payload)
+    {
+        const uint64_t seq = head_.fetch_add(1, std::memory_order_relaxed);
+        auto& slot = slots_[seq & (CAPACITY - 1)];
+        // odd: being written
+        auto state = slot.state.load(std::memory_order_relaxed);
+        for (;;) {
+            if (state >= seq * 2 + 1) {
+                // lapped before we even started; a newer line owns the slot and ours is lost
+                return;
+            }
+            if (state & 1) {
+                // a writer we lapped is still busy with its line; it publishes and leaves soon
+                std::this_thread::yield();
+                state = slot.state.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (slot.state.compare_exchange_weak(state, seq * 2 + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const auto length = std::min(payload.size(), PAYLOAD_SIZE);
+        slot.time.store(time.time_since_epoch().count(), std::memory_order_relaxed);
+        slot.level.store(static_cast<uint32_t>(level), std::memory_order_relaxed);
+        slot.length.store(static_cast<uint32_t>(length), std::memory_order_relaxed);
+        for (size_t i = 0; i * sizeof(uint64_t) < length; i++) {
+            uint64_t word = 0;
+            std::memcpy(&word, payload.data() + i * sizeof(uint64_t), std::min(sizeof(uint64_t), length - i * sizeof(uint64_t)));
+            slot.payload[i].store(word, std::memory_order_relaxed);
+        }
+
+        slot.state.store(seq * 2 + 2, std::memory_order_release);
+    }
+
+    // sequence number the next pushed line will get
+    uint64_t head() const
+    {
+        return head_.load(std::memory_order_acquire);
+    }
+
+    // oldest sequence number that may still be readable
+    uint64_t tail() const
+    {
+        const auto h = head();
+        return h > CAPACITY ? h - CAPACITY : 0;
+    }
+
+    enum class ReadResult {
+        Ok,
+        // not (completely) written yet
+        Pending,
+        // overwritten by a newer line
+        Lost,
+    };
+
+    // Copies line seq; payload keeps its capacity, so a reused string doesn't allocate either
+    ReadResult read(uint64_t seq, std::chrono::system_clock::time_point& time, spdlog::level::level_enum& level, std::string& payload) const
+    {
+        const auto& slot = slots_[seq & (CAPACITY - 1)];
+        const auto before = slot.state.load(std::memory_order_acquire);
+        if (before != seq * 2 + 2) {
+            return before < seq * 2 + 2 ? ReadResult::Pending : ReadResult::Lost;
+        }
+        time = std::chrono::system_clock::time_point(
+            std::chrono::system_clock::duration(slot.time.load(std::memory_order_relaxed)));
+        level = static_cast<spdlog::level::level_enum>(slot.level.load(std::memory_order_relaxed));
+        const auto length = std::min<size_t>(slot.length.load(std::memory_order_relaxed), PAYLOAD_SIZE);
+        payload.resize(length);
+        for (size_t i = 0; i * sizeof(uint64_t) < length; i++) {
+            const auto word = slot.payload[i].load(std::memory_order_relaxed);
+            std::memcpy(payload.data() + i * sizeof(uint64_t), &word, std::min(sizeof(uint64_t), length - i * sizeof(uint64_t)));
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.state.load(std::memory_order_relaxed) == before ? ReadResult::Ok : ReadResult::Lost;
+    }
+
+  private:
+    struct Slot {
+        std::atomic<uint64_t> state = 0;
+        std::atomic<int64_t> time = 0;
+        std::atomic<uint32_t> level = 0;
+        std::atomic<uint32_t> length = 0;
+        std::array<std::atomic<uint64_t>, PAYLOAD_SIZE / sizeof(uint64_t)> payload{};
+    };
+
+    alignas(64) std::atomic<uint64_t> head_ = 0;
+    alignas(64) std::array<Slot, CAPACITY> slots_{};
+};
+
+/*
+ * Reader side of a LogRing: the last CAPACITY lines, copied out once per frame
+ *
+ * sync() only copies lines pushed since the previous call, and copies into reused strings,
+ * so its cost depends on the number of new lines, never on how much was logged before.
+ * Lines are addressed by sequence number, [begin(), end()).
+ */
+template <typename Ring>
+class LogView {
+  public:
+    struct Line {
+        std::chrono::system_clock::time_point time;
+        // off: lost before it could be copied
+        spdlog::level::level_enum level = spdlog::level::off;
+        std::string payload;
+    };
+
+    void sync(const Ring& ring)
+    {
+        const auto head = ring.head();
+        if (head - end_ > Ring::capacity) {
+            end_ = head - Ring::capacity;
+        }
+        for (; end_ < head; end_++) {
+            auto& line = lines_[end_ % Ring::capacity];
+            const auto res = ring.read(end_, line.time, line.level, line.payload);
+            if (res == Ring::ReadResult::Pending) {
+                // still being written; picked up by the next sync
+                break;
+            }
+            if (res == Ring::ReadResult::Lost) {
+                line.level = spdlog::level::off;
+            }
+        }
+        begin_ = end_ > Ring::capacity ? end_ - Ring::capacity : 0;
+    }
+
+    uint64_t begin() const
+    {
+        return begin_;
+    }
+
+    uint64_t end() const
+    {
+        return end_;
+    }
+
+    const Line& operator[](uint64_t seq) const
+    {
+        return lines_[seq % Ring::capacity];
+    }
+
+  private:
+    std::vector<Line> lines_ = std::vector<Line>(Ring::capacity);
+    uint64_t begin_ = 0;
+    uint64_t end_ = 0;
+};
@@ -20,7 +20,11 @@ limitations under the License.
 #include <regex>
 #include <shlobj_core.h>
 
+#include "AssetCache.h"
+#include "Log.h"
+#include "Profiler.h"
 #include "Roboto.h"
+#include "StartupTimings.h"
 #include "..\common\Settings.h"
 #include "GlosSI_logo.h"
 
@@ -36,18 +40,26 @@ Overlay::Overlay(
       trigger_state_change_(std::move(trigger_state_change)),
       force_enable_(force_enable)
 {
-    ImGui::SFML::Init(window_);
+    // don't let ImGui::SFML build an atlas for the default font; we replace it anyway
+    ImGui::SFML::Init(window_, false);
+    StartupTimings::Mark("ImGui init");
 
     ImGuiIO& io = ImGui::GetIO();
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
 
+#ifdef _WIN32
+    AssetCache::SetDirectory(util::path::getDataDirPath() / "cache");
+#endif
+
     io.Fonts->Clear(); // clear fonts if you loaded some before (even if only default one was loaded)
     auto fontconf = ImFontConfig{};
     fontconf.FontDataOwnedByAtlas = false;
     io.Fonts->AddFontFromMemoryTTF(Roboto_Regular_ttf.data(), Roboto_Regular_ttf.size(), 24, &fontconf);
+    AssetCache::Install(io.Fonts);
     ImGui::SFML::UpdateFontTexture();
+    StartupTimings::Mark("Font atlas");
 
 #ifdef _WIN32
     auto config_path = util::path::getDataDirPath();
@@ -58,9 +70,10 @@ Overlay::Overlay(
     io.IniFilename = config_file_name_.data();
 #endif
 
-    if (!logo_texture_.loadFromMemory(GLOSSI_LOGO.data(), GLOSSI_LOGO.size())) {
+    if (!AssetCache::LoadTexture(logo_texture_, "logo", GLOSSI_LOGO.data(), GLOSSI_LOGO.size())) {
         spdlog::trace("Failed to load logo texture");
     }
+    StartupTimings::Mark("Logo texture");
     if (logo_texture_.getSize().x > 0) {
         logo_sprite_.setTexture(logo_texture_);
         logo_sprite_.setScale(0.5f, 0.5f);
@@ -139,6 +152,9 @@ Overlay::Overlay(
 
 void Overlay::setEnabled(bool enabled)
 {
+    if (enabled_ != enabled) {
+        MarkDirty();
+    }
     enabled_ = enabled;
 }
 
@@ -149,12 +165,43 @@ bool Overlay::isEnabled() const
 
 bool Overlay::toggle()
 {
+    MarkDirty();
     enabled_ = !enabled_;
     return enabled_;
 }
 
+bool Overlay::needsRender() const
+{
+    // open overlay is interactive / changes on its own
+    // forced elements only change on input or when their owner calls MarkDirty()
+    if (enabled_ || force_enable_) {
+        return true;
+    }
+    if (dirty_.load(std::memory_order_relaxed) || settle_frames_ > 0) {
+        return true;
+    }
+    if (time_since_start_clock_.getElapsedTime().asSeconds() < SPLASH_DURATION_S_) {
+        return true;
+    }
+    return std::chrono::system_clock::now() >= next_log_change_;
+}
+
+void Overlay::MarkDirty()
+{
+    dirty_.store(true, std::memory_order_relaxed);
+}
+
 void Overlay::update()
 {
+    PROFILE_ZONE("Overlay::update");
+    if (dirty_.exchange(false, std::memory_order_relaxed)) {
+        settle_frames_ = SETTLE_FRAMES_;
+    }
+    else if (settle_frames_ > 0) {
+        settle_frames_--;
+    }
+    next_log_change_ = std::chrono::system_clock::time_point::max();
+
     ImGui::SFML::Update(window_, update_clock_.restart());
 
     if (!enabled_ && !force_enable_ && time_since_start_clock_.getElapsedTime().asSeconds() < SPLASH_DURATION_S_) {
@@ -170,10 +217,14 @@ void Overlay::update()
     }
 
     if (Settings::window.disableGlosSIOverlay) {
+        min_visible_log_level_.store(spdlog::level::off, std::memory_order_relaxed);
         std::ranges::for_each(FORCED_OVERLAY_ELEMS_, [this](const auto& elem) {
             elem.second(window_.hasFocus(), 0);
         });
-        ImGui::SFML::Render(window_);
+        {
+            PROFILE_ZONE("ImGui render");
+            ImGui::SFML::Render(window_);
+        }
         return;
     }
 
@@ -194,7 +245,9 @@ void Overlay::update()
                 Settings::StoreSettings();
             }
         }
-        ImGui::Checkbox("Extended logging", &Settings::common.extendedLogging);
+        if (ImGui::Checkbox("Extended logging", &Settings::common.extendedLogging)) {
+            ::Log::SetExtended(Settings::common.extendedLogging, Settings::common.extendedLogCategories);
+        }
         ImGuiID dockspace_id = ImGui::GetID("GlosSI-DockSpace");
         ImGui::DockSpace(dockspace_id);
 
@@ -226,11 +279,13 @@ void Overlay::update()
         ImGui::PopStyleColor();
     });
 
+    PROFILE_ZONE("ImGui render");
     ImGui::SFML::Render(window_);
 }
 
 void Overlay::ProcessEvent(sf::Event evnt)
 {
+    MarkDirty();
     ImGui::SFML::ProcessEvent(evnt);
 }
 
@@ -241,7 +296,10 @@ void Overlay::Shutdown()
 
 void Overlay::AddLog(const spdlog::details::log_msg& msg)
 {
-    LOG_MSGS_.push_back({.time = msg.time, .level = msg.level, .payload = msg.payload.data()});
+    LOG_RING_.push(msg.time, msg.level, {msg.payload.data(), msg.payload.size()});
+    if (msg.level != spdlog::level::off && msg.level >= min_visible_log_level_.load(std::memory_order_relaxed)) {
+        MarkDirty();
+    }
 }
 
 int Overlay::AddOverlayElem(const std::function<void(bool window_has_focus, ImGuiID dockspace_id)>& elem_fn, bool force_show)
@@ -252,6 +310,7 @@ int Overlay::AddOverlayElem(const std::function<void(bool window_has_focus, ImGu
     else {
         OVERLAY_ELEMS_.insert({overlay_element_id_, elem_fn});
     }
+    MarkDirty();
     // keep this non confusing, but longer...
     const auto res = overlay_element_id_;
     overlay_element_id_++;
@@ -264,36 +323,74 @@ void Overlay::RemoveOverlayElem(int id)
         OVERLAY_ELEMS_.erase(id);
     if (FORCED_OVERLAY_ELEMS_.contains(id))
         FORCED_OVERLAY_ELEMS_.erase(id);
+    MarkDirty();
+}
+
+void Overlay::syncLogs()
+{
+    log_view_.sync(LOG_RING_);
+    log_toast_begin_ = std::max(log_toast_begin_, log_view_.begin());
 }
 
 void Overlay::showLogs(ImGuiID dockspace_id)
 {
-    std::vector<Log> logs;
     if (!enabled_ && !log_expanded_) {
+        min_visible_log_level_.store(spdlog::level::off, std::memory_order_relaxed);
         return;
     }
+    syncLogs();
+    bool has_logs = false;
     bool logs_contain_warn_or_worse = false;
     if (enabled_) {
-        logs = LOG_MSGS_;
+        has_logs = log_view_.begin() != log_view_.end();
+    }
+    else {
+        // logs are in chronological order; only ever look at the ones not expired yet
+        const auto now = std::chrono::system_clock::now();
+        for (; log_toast_begin_ < log_view_.end(); log_toast_begin_++) {
+            const auto& log = log_view_[log_toast_begin_];
+            if (log.level != spdlog::level::off && log.time + std::chrono::seconds(LOG_RETENTION_TIME_) > now) {
+                break;
+            }
+        }
+        for (auto seq = log_toast_begin_; seq < log_view_.end(); seq++) {
+            const auto& log = log_view_[seq];
+            if (log.level == spdlog::level::off
+#ifdef NDEBUG
+                || log.level <= spdlog::level::debug
+#endif
+            ) {
+                continue;
+            }
+            has_logs = true;
+            if (log.level > spdlog::level::warn) {
+                logs_contain_warn_or_worse = true;
+            }
+        }
+        // re-render once the oldest toast expires
+        if (log_toast_begin_ < log_view_.end()) {
+            next_log_change_ = log_view_[log_toast_begin_].time + std::chrono::seconds(LOG_RETENTION_TIME_);
+        }
+        const auto hide_normal_in = std::chrono::duration<float>(HIDE_NORMAL_LOGS_AFTER_S - time_since_start_clock_.getElapsedTime().asSeconds());
+        if (hide_normal_in.count() > 0) {
+            next_log_change_ = std::min(next_log_change_, std::chrono::system_clock::now() + std::chrono::duration_cast<std::chrono::system_clock::duration>(hide_normal_in));
+        }
+    }
+    const bool hide_normal_logs = !enabled_ && !force_enable_ && !logs_contain_warn_or_worse && time_since_start_clock_.getElapsedTime().asSeconds() > HIDE_NORMAL_LOGS_AFTER_S;
+    if (enabled_) {
+        min_visible_log_level_.store(log_expanded_ ? spdlog::level::trace : spdlog::level::off, std::memory_order_relaxed);
+    }
+    else if (hide_normal_logs) {
+        min_visible_log_level_.store(spdlog::level::err, std::memory_order_relaxed);
     }
     else {
-        std::ranges::copy_if(LOG_MSGS_,
-                             std::back_inserter(logs),
-                             [&logs_contain_warn_or_worse](const auto& log) {
-                                 const auto res = (log.time.time_since_epoch() + std::chrono::seconds(
-                                                                                     LOG_RETENTION_TIME_) >
-                                                   std::chrono::system_clock::now().time_since_epoch())
 #ifdef NDEBUG
-                                                  && (log.level > spdlog::level::debug)
+        min_visible_log_level_.store(spdlog::level::info, std::memory_order_relaxed);
+#else
+        min_visible_log_level_.store(spdlog::level::trace, std::memory_order_relaxed);
 #endif
-                                     ;
-                                 if (res && log.level > spdlog::level::warn) {
-                                     logs_contain_warn_or_worse = true;
-                                 }
-                                 return res;
-                             });
     }
-    if (logs.empty() || (!enabled_ && !force_enable_ && !logs_contain_warn_or_worse && time_since_start_clock_.getElapsedTime().asSeconds() > HIDE_NORMAL_LOGS_AFTER_S))
+    if (!has_logs || hide_normal_logs)
         return;
     ImGui::SetNextWindowSizeConstraints({150, 150}, {1000, window_.getSize().y - 250.f});
     if (!enabled_) {
@@ -308,7 +405,8 @@ void Overlay::showLogs(ImGuiID dockspace_id)
         log_expanded_ = ImGui::Begin("Log");
     }
     if (log_expanded_) {
-        std::ranges::for_each(LOG_MSGS_, [](const auto& msg) {
+        for (auto seq = log_view_.begin(); seq < log_view_.end(); seq++) {
+            const auto& msg = log_view_[seq];
             switch (msg.level) {
             case spdlog::level::warn:
                 ImGui::TextColored({1.f, 0.8f, 0.f, 1.f}, msg.payload.data());
@@ -319,10 +417,13 @@ void Overlay::showLogs(ImGuiID dockspace_id)
             case spdlog::level::debug:
                 ImGui::TextColored({.8f, 0.8f, 0.8f, .9f}, msg.payload.data());
                 break;
+            case spdlog::level::off:
+                // lost while copying
+                break;
             default:
                 ImGui::Text(msg.payload.data());
             }
-        });
+        }
         ImGui::SetScrollY(ImGui::GetScrollMaxY());
     }
     ImGui::End();
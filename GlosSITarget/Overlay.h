@@ -22,10 +22,13 @@ limitations under the License.
 #include "imgui-SFML.h"
 #include "imgui.h"
 
+#include <atomic>
 #include <chrono>
 
 #include <spdlog/spdlog.h>
 
+#include "LogRing.h"
+
 class Overlay {
   public:
     Overlay(sf::RenderWindow& window, std::function<void()> on_close, std::function<void()> trigger_state_change, bool force_enable = false);
@@ -34,6 +37,10 @@ class Overlay {
     bool isEnabled() const;
     bool toggle();
     void update();
+    // false if the next frame would look exactly like the last one
+    bool needsRender() const;
+    // Something visible changed; safe to call from any thread
+    static void MarkDirty();
     static void ProcessEvent(sf::Event evnt);
     static void Shutdown();
     static void AddLog(const spdlog::details::log_msg& msg);
@@ -58,16 +65,25 @@ class Overlay {
     sf::Texture logo_texture_;
     sf::Sprite logo_sprite_;
 
-    struct Log {
-        std::chrono::system_clock::time_point time;
-        spdlog::level::level_enum level;
-        std::string payload;
-    };
-    static inline std::vector<Log> LOG_MSGS_;
+    // written from any thread; the overlay copies new lines into log_view_ once per frame
+    static inline LogRing<1024, 256> LOG_RING_;
+    LogView<decltype(LOG_RING_)> log_view_;
+    // everything before this is too old to show up as toast
+    uint64_t log_toast_begin_ = 0;
+    void syncLogs();
     static constexpr int LOG_RETENTION_TIME_ = 5;
     static constexpr int HIDE_NORMAL_LOGS_AFTER_S = 20;
     static constexpr int SPLASH_DURATION_S_ = 3;
 
+    static inline std::atomic<bool> dirty_ = true;
+    // AddLog only marks dirty for lines that would show up with the current log/toast state
+    static inline std::atomic<spdlog::level::level_enum> min_visible_log_level_ = spdlog::level::trace;
+    // ImGui needs a couple of frames to settle (auto-sizing, fades)
+    static constexpr int SETTLE_FRAMES_ = 3;
+    int settle_frames_ = 0;
+    // closed overlay: when the next log toast appears/disappears
+    std::chrono::system_clock::time_point next_log_change_ = std::chrono::system_clock::time_point::max();
+
     static inline int overlay_element_id_ = 0;
     static inline std::map<int, std::function<void(bool window_has_focus, ImGuiID dockspace_id)>> OVERLAY_ELEMS_;
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/sinks/base_sink.h>
 #include <spdlog/spdlog.h>
 #include "Overlay.h"
 
@@ -34,7 +36,8 @@ class overlay_sink : public spdlog::sinks::base_sink<Mutex> {
     }
 };
 
-using overlay_sink_mt = overlay_sink<std::mutex>;
+// the overlay's log store is lock free already
+using overlay_sink_mt = overlay_sink<spdlog::details::null_mutex>;
 
 } // namespace sinks
 } // namespace spdlog
\ No newline at end of file
@@ -0,0 +1,145 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "TickClock.h"
+
+namespace PadPresence {
+
+enum class Event {
+    None,
+    Plugged,
+    Unplugged,
+};
+
+struct Config {
+    // re-probe interval for empty slots; doubles on every failed probe
+    TickClock::duration min_backoff = std::chrono::milliseconds(250);
+    TickClock::duration max_backoff = std::chrono::seconds(2);
+    // a connected slot has to fail for this long before it's considered unplugged
+    TickClock::duration unplug_debounce = std::chrono::milliseconds(250);
+};
+
+/*
+ * Tracks which controller slots are connected
+ *
+ * XInputGetState on an empty slot is expensive (can take milliseconds),
+ * so only connected slots are probed every tick; empty slots are re-probed on an exponential backoff,
+ * or right away after rescan() (device arrival).
+ * Short probe failures of connected slots are debounced, so virtual pads don't get re-plugged on hiccups.
+ *
+ * Not thread safe, except for rescan()
+ */
+class Tracker {
+  public:
+    explicit Tracker(size_t slot_count = 0, Config config = {}) : config_(config)
+    {
+        resize(slot_count);
+    }
+
+    void resize(size_t slot_count)
+    {
+        const auto old_size = slots_.size();
+        slots_.resize(slot_count);
+        for (size_t i = old_size; i < slot_count; i++) {
+            slots_[i].backoff = config_.min_backoff;
+        }
+    }
+
+    size_t size() const
+    {
+        return slots_.size();
+    }
+
+    // Call once per tick before probing
+    void beginTick(TickClock::time_point now)
+    {
+        if (rescan_requested_.exchange(false)) {
+            for (auto& slot : slots_) {
+                if (!slot.connected) {
+                    slot.backoff = config_.min_backoff;
+                    slot.next_probe = now;
+                }
+            }
+        }
+    }
+
+    bool shouldProbe(size_t idx, TickClock::time_point now) const
+    {
+        const auto& slot = slots_[idx];
+        return slot.connected || now >= slot.next_probe;
+    }
+
+    // Feed back the result of a probe
+    Event report(size_t idx, bool success, TickClock::time_point now)
+    {
+        auto& slot = slots_[idx];
+        if (success) {
+            slot.failing = false;
+            if (!slot.connected) {
+                slot.connected = true;
+                return Event::Plugged;
+            }
+            return Event::None;
+        }
+        if (slot.connected) {
+            if (!slot.failing) {
+                slot.failing = true;
+                slot.first_failure = now;
+            }
+            if (now - slot.first_failure < config_.unplug_debounce) {
+                return Event::None;
+            }
+            slot.connected = false;
+            slot.failing = false;
+            slot.backoff = config_.min_backoff;
+            slot.next_probe = now + slot.backoff;
+            return Event::Unplugged;
+        }
+        slot.next_probe = now + slot.backoff;
+        slot.backoff = std::min(slot.backoff * 2, config_.max_backoff);
+        return Event::None;
+    }
+
+    bool isConnected(size_t idx) const
+    {
+        return slots_[idx].connected;
+    }
+
+    // Re-probe all empty slots on the next tick; safe to call from any thread
+    void rescan()
+    {
+        rescan_requested_ = true;
+    }
+
+  private:
+    struct Slot {
+        bool connected = false;
+        bool failing = false;
+        TickClock::time_point first_failure{};
+        // default constructed time_point is in the past; empty slots get probed right away
+        TickClock::time_point next_probe{};
+        TickClock::duration backoff{};
+    };
+    Config config_;
+    std::vector<Slot> slots_;
+    std::atomic<bool> rescan_requested_ = false;
+};
+
+} // namespace PadPresence
@@ -0,0 +1,60 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "Ds4Translation.h"
+#include "FeedbackMailbox.h"
+
+/*
+ * Where InputRedirector sends the emulated controllers to
+ *
+ * Pads are addressed by the same 0 based slot index as the InputSource.
+ * All functions are only called from the controller thread;
+ * feedback handlers may be invoked from any thread.
+ */
+class PadSink {
+  public:
+    enum class Type {
+        X360,
+        DS4,
+    };
+
+    struct Config {
+        Type type = Type::X360;
+        uint16_t vid = 0;
+        uint16_t pid = 0;
+    };
+
+    // Rumble/Lightbar sent by the game; context is what was passed to plug()
+    using FeedbackHandler = void (*)(void* context, const Feedback::State& state);
+
+    virtual ~PadSink() = default;
+
+    virtual const char* name() const = 0;
+
+    virtual bool isConnected() const = 0;
+
+    virtual bool plug(size_t idx, const Config& config, FeedbackHandler handler, void* context) = 0;
+
+    virtual bool unplug(size_t idx) = 0;
+
+    virtual bool isPlugged(size_t idx) const = 0;
+
+    // report is always in XINPUT_GAMEPAD layout; DS4 pads translate it themselves
+    virtual bool submit(size_t idx, const Ds4Translation::XusbReport& report) = 0;
+};
@@ -0,0 +1,116 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+#include <spdlog/fmt/fmt.h>
+
+/*
+ * What GET /launched-pids serves
+ *
+ * Snapshots are never modified, only replaced once the PIDs change; readers (http threads)
+ * just grab the current one without touching the launcher's lock.
+ * Each snapshot carries a version bumped on every change and a matching ETag,
+ * so pollers can send If-None-Match and get a 304 while nothing changed.
+ */
+namespace PidSnapshot {
+
+template <typename Pid>
+struct Snapshot {
+    uint64_t version = 0;
+    std::vector<Pid> pids;
+    std::string json = "[]";
+    std::string etag = "\"0\"";
+};
+
+// If-None-Match may list several tags, or be "*"
+inline bool EtagMatches(std::string_view if_none_match, std::string_view etag)
+{
+    while (!if_none_match.empty()) {
+        const auto comma = if_none_match.find(',');
+        auto tag = if_none_match.substr(0, comma);
+        if_none_match = comma == std::string_view::npos ? std::string_view{} : if_none_match.substr(comma + 1);
+        while (!tag.empty() && tag.front() == ' ') {
+            tag.remove_prefix(1);
+        }
+        while (!tag.empty() && tag.back() == ' ') {
+            tag.remove_suffix(1);
+        }
+        // weak comparison is all If-None-Match asks for
+        if (tag.starts_with("W/")) {
+            tag.remove_prefix(2);
+        }
+        if (tag == "*" || tag == etag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Pid>
+struct Lookup {
+    std::shared_ptr<const Snapshot<Pid>> snapshot;
+    // client already has this version: answer 304 with just the ETag
+    bool not_modified = false;
+};
+
+template <typename Pid>
+class Publisher {
+  public:
+    // instance: part of every ETag (e.g. the process id), so a tag from a previous run never matches
+    explicit Publisher(uint64_t instance) : instance_(instance) {}
+
+    // Single writer; returns false if the PIDs didn't change and the current snapshot stays
+    bool publish(std::vector<Pid> pids)
+    {
+        const auto current = snapshot_.load();
+        if (pids == current->pids) {
+            return false;
+        }
+        auto snapshot = std::make_shared<Snapshot<Pid>>();
+        snapshot->version = current->version + 1;
+        snapshot->json = nlohmann::json(pids).dump();
+        snapshot->etag = fmt::format("\"{}-{}\"", instance_, snapshot->version);
+        snapshot->pids = std::move(pids);
+        snapshot_.store(std::move(snapshot));
+        return true;
+    }
+
+    std::shared_ptr<const Snapshot<Pid>> current() const
+    {
+        return snapshot_.load();
+    }
+
+    // if_none_match: the request's If-None-Match header, empty if there is none
+    Lookup<Pid> lookup(std::string_view if_none_match) const
+    {
+        auto snapshot = snapshot_.load();
+        const bool not_modified = EtagMatches(if_none_match, snapshot->etag);
+        return {std::move(snapshot), not_modified};
+    }
+
+  private:
+    uint64_t instance_;
+    std::atomic<std::shared_ptr<const Snapshot<Pid>>> snapshot_ = std::make_shared<const Snapshot<Pid>>();
+};
+
+} // namespace PidSnapshot
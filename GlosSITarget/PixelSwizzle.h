@@ -0,0 +1,176 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define GLOSSI_SWIZZLE_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+/*
+ * BGRX -> RGBA conversion (GDI bitmaps -> SFML textures); alpha is forced to 255
+ *
+ * Picks the widest kernel the CPU supports at runtime (AVX2, SSSE3, scalar).
+ * src and dst may be the same buffer.
+ */
+namespace PixelSwizzle {
+
+namespace detail {
+
+inline void BgrxToRgbaScalar(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; i++) {
+        uint32_t px;
+        std::memcpy(&px, src + i * 4, 4);
+        // little endian: 0xXXRRGGBB -> 0xFFBBGGRR
+        px = 0xFF000000u | ((px & 0x000000FFu) << 16) | (px & 0x0000FF00u) | ((px & 0x00FF0000u) >> 16);
+        std::memcpy(dst + i * 4, &px, 4);
+    }
+}
+
+#ifdef GLOSSI_SWIZZLE_X86
+
+#if defined(__GNUC__) || defined(__clang__)
+#define GLOSSI_TARGET(isa) __attribute__((target(isa)))
+#else
+#define GLOSSI_TARGET(isa)
+#endif
+
+GLOSSI_TARGET("ssse3")
+inline void BgrxToRgbaSsse3(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(px, shuffle), alpha));
+    }
+    BgrxToRgbaScalar(src + i * 4, dst + i * 4, pixels - i);
+}
+
+GLOSSI_TARGET("avx2")
+inline void BgrxToRgbaAvx2(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    const __m256i shuffle = _mm256_setr_epi8(
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    size_t i = 0;
+    // two vectors per iteration keeps both shuffle ports busy
+    for (; i + 16 <= pixels; i += 16) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4 + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(a, shuffle), alpha));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4 + 32), _mm256_or_si256(_mm256_shuffle_epi8(b, shuffle), alpha));
+    }
+    for (; i + 8 <= pixels; i += 8) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(a, shuffle), alpha));
+    }
+    BgrxToRgbaScalar(src + i * 4, dst + i * 4, pixels - i);
+}
+
+#undef GLOSSI_TARGET
+
+inline bool CpuHasAvx2()
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7) {
+        return false;
+    }
+    __cpuid(regs, 1);
+    const bool osxsave = regs[2] & (1 << 27);
+    const bool avx = regs[2] & (1 << 28);
+    // OS has to save the ymm registers
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(regs, 7, 0);
+    return regs[1] & (1 << 5);
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+inline bool CpuHasSsse3()
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 1);
+    return regs[2] & (1 << 9);
+#else
+    return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+#endif
+
+} // namespace detail
+
+enum class Kernel {
+    Scalar,
+    Ssse3,
+    Avx2,
+};
+
+inline Kernel BestKernel()
+{
+#ifdef GLOSSI_SWIZZLE_X86
+    static const Kernel best = detail::CpuHasAvx2() ? Kernel::Avx2 : detail::CpuHasSsse3() ? Kernel::Ssse3 : Kernel::Scalar;
+    return best;
+#else
+    return Kernel::Scalar;
+#endif
+}
+
+inline const char* KernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Avx2:
+        return "AVX2";
+    case Kernel::Ssse3:
+        return "SSSE3";
+    default:
+        return "scalar";
+    }
+}
+
+inline void BgrxToRgba(const uint8_t* src, uint8_t* dst, size_t pixels, Kernel kernel = BestKernel())
+{
+    switch (kernel) {
+#ifdef GLOSSI_SWIZZLE_X86
+    case Kernel::Avx2:
+        detail::BgrxToRgbaAvx2(src, dst, pixels);
+        return;
+    case Kernel::Ssse3:
+        detail::BgrxToRgbaSsse3(src, dst, pixels);
+        return;
+#endif
+    default:
+        detail::BgrxToRgbaScalar(src, dst, pixels);
+    }
+}
+
+} // namespace PixelSwizzle
@@ -4,16 +4,48 @@
 
 #include "imgui.h"
 #include "Overlay.h"
+#include "ThreadPolicy.h"
+#include "../common/Settings.h"
 
 namespace ProcessPriority {
 
 static int current_priority = HIGH_PRIORITY_CLASS;
 
+// render loop runs on the thread calling init()
+inline std::unique_ptr<ThreadPolicy::Scheduler> render_thread_scheduler;
+
+// One checkbox per logical core; returns true if mask was changed
+inline bool AffinityEditor(const char* id, uint64_t& mask)
+{
+    bool changed = false;
+    ImGui::PushID(id);
+    for (unsigned int i = 0; i < ThreadPolicy::CoreCount(); i++) {
+        bool selected = mask & (uint64_t{1} << i);
+        if (i % 8 != 0) {
+            ImGui::SameLine();
+        }
+        if (ImGui::Checkbox(std::to_string(i).c_str(), &selected)) {
+            mask ^= uint64_t{1} << i;
+            changed = true;
+        }
+    }
+    ImGui::PopID();
+    return changed;
+}
+
+inline void applyRenderThreadPolicy()
+{
+    render_thread_scheduler->apply({ThreadPolicy::Task::None, Settings::window.renderThreadAffinity});
+}
+
 inline void init()
 {
     SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS);
     spdlog::trace("Set process priority to HIGH_PRIORITY_CLASS");
 
+    render_thread_scheduler = ThreadPolicy::Create();
+    applyRenderThreadPolicy();
+
     Overlay::AddOverlayElem([](bool window_has_focus, ImGuiID dockspace_id) {
         ImGui::SetNextWindowDockID(dockspace_id, ImGuiCond_FirstUseEver);
         ImGui::Begin("Process Priority");
@@ -48,6 +80,13 @@ inline void init()
             current_priority = IDLE_PRIORITY_CLASS;
             spdlog::trace("Set process priority to IDLE_PRIORITY_CLASS");
         }
+        ImGui::Spacing();
+        ImGui::Text("Render thread cores (none selected = any)");
+        ImGui::Text("Pinning GlosSI away from the cores the game uses can help with stutter");
+        // overlay elements are drawn on the render thread
+        if (AffinityEditor("##Render thread cores", Settings::window.renderThreadAffinity)) {
+            applyRenderThreadPolicy();
+        }
         ImGui::End();
     });
 }
@@ -0,0 +1,174 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cwctype>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#include <tlhelp32.h>
+#endif
+
+/*
+ * Point in time view of all running processes
+ *
+ * Built from a single process snapshot; answers name and parent -> children lookups
+ * without touching the system again.
+ */
+namespace ProcessTree {
+
+using Pid = uint32_t;
+
+// Executable names are compared like Windows compares file names: whole name, case insensitive
+inline bool NameEquals(std::wstring_view a, std::wstring_view b)
+{
+    return std::ranges::equal(a, b, [](wchar_t l, wchar_t r) {
+        return l == r || std::towlower(l) == std::towlower(r);
+    });
+}
+
+struct Entry {
+    Pid pid = 0;
+    Pid parent = 0;
+    std::wstring name;
+};
+
+class Index {
+  public:
+    Index() = default;
+
+    explicit Index(std::vector<Entry> entries) : entries_(std::move(entries))
+    {
+        std::ranges::sort(entries_, {}, &Entry::pid);
+        edges_.reserve(entries_.size());
+        for (const auto& entry : entries_) {
+            // the idle process is its own parent
+            if (entry.pid != entry.parent) {
+                edges_.emplace_back(entry.parent, entry.pid);
+            }
+        }
+        std::ranges::sort(edges_);
+    }
+
+#ifdef _WIN32
+    static Index Snapshot()
+    {
+        std::vector<Entry> entries;
+        const HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+        if (snapshot == INVALID_HANDLE_VALUE) {
+            return {};
+        }
+        PROCESSENTRY32 pe{};
+        pe.dwSize = sizeof(pe);
+        for (BOOL ok = Process32First(snapshot, &pe); ok; ok = Process32Next(snapshot, &pe)) {
+            entries.push_back({pe.th32ProcessID, pe.th32ParentProcessID, pe.szExeFile});
+        }
+        CloseHandle(snapshot);
+        return Index(std::move(entries));
+    }
+#endif
+
+    size_t size() const
+    {
+        return entries_.size();
+    }
+
+    bool contains(Pid pid) const
+    {
+        return find(pid) != nullptr;
+    }
+
+    // 0 if unknown
+    Pid parent(Pid pid) const
+    {
+        const auto entry = find(pid);
+        return entry ? entry->parent : 0;
+    }
+
+    // Empty if the process is not (or no longer) running
+    const std::wstring& name(Pid pid) const
+    {
+        static const std::wstring empty;
+        const auto entry = find(pid);
+        return entry ? entry->name : empty;
+    }
+
+    // Lowest PID whose executable name is name, ignoring case; 0 if none
+    Pid pidByName(std::wstring_view name) const
+    {
+        const auto it = std::ranges::find_if(entries_, [name](const Entry& e) {
+            return NameEquals(e.name, name);
+        });
+        return it != entries_.end() ? it->pid : 0;
+    }
+
+    std::vector<Pid> children(Pid parent) const
+    {
+        std::vector<Pid> res;
+        for (auto [it, end] = childRange(parent); it != end; ++it) {
+            res.push_back(it->second);
+        }
+        return res;
+    }
+
+    // Calls fn(pid) for every (transitive) child of root, breadth first.
+    // Safe against loops caused by PID reuse.
+    template <typename Fn>
+    void forEachDescendant(Pid root, Fn&& fn) const
+    {
+        std::vector<Pid> queue{root};
+        std::unordered_set<Pid> seen{root};
+        for (size_t i = 0; i < queue.size(); i++) {
+            for (auto [it, end] = childRange(queue[i]); it != end; ++it) {
+                const auto child = it->second;
+                if (!seen.insert(child).second) {
+                    continue;
+                }
+                queue.push_back(child);
+                fn(child);
+            }
+        }
+    }
+
+  private:
+    // sorted by pid
+    std::vector<Entry> entries_;
+    // (parent, child), sorted
+    using Edge = std::pair<Pid, Pid>;
+    std::vector<Edge> edges_;
+
+    const Entry* find(Pid pid) const
+    {
+        const auto it = std::ranges::lower_bound(entries_, pid, {}, &Entry::pid);
+        return it != entries_.end() && it->pid == pid ? &*it : nullptr;
+    }
+
+    std::pair<std::vector<Edge>::const_iterator, std::vector<Edge>::const_iterator> childRange(Pid parent) const
+    {
+        const auto begin = std::ranges::lower_bound(edges_, parent, {}, &Edge::first);
+        const auto end = std::ranges::upper_bound(begin, edges_.end(), parent, {}, &Edge::first);
+        return {begin, end};
+    }
+};
+
+} // namespace ProcessTree
@@ -0,0 +1,255 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "ProcessWatcher.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef P_PIDFD
+#define P_PIDFD 3
+#endif
+#endif
+
+#include <spdlog/spdlog.h>
+
+struct ProcessWatcher::Watch {
+    ProcessWatcher* owner = nullptr;
+    uint32_t pid = 0;
+#ifdef _WIN32
+    HANDLE process = nullptr;
+    HANDLE wait = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+void ProcessWatcher::WatchDeleter::operator()(Watch* watch) const
+{
+#ifdef _WIN32
+    if (watch->wait) {
+        // blocks until a running callback is done
+        UnregisterWaitEx(watch->wait, INVALID_HANDLE_VALUE);
+    }
+    if (watch->process) {
+        CloseHandle(watch->process);
+    }
+#else
+    if (watch->fd >= 0) {
+        close(watch->fd);
+    }
+#endif
+    delete watch;
+}
+
+ProcessWatcher::ProcessWatcher(std::function<void()> on_exit) : on_exit_(std::move(on_exit))
+{
+#ifndef _WIN32
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    poll_thread_ = std::thread(&ProcessWatcher::pollLoop, this);
+#endif
+}
+
+ProcessWatcher::~ProcessWatcher()
+{
+#ifndef _WIN32
+    run_ = false;
+    wakePollThread();
+    poll_thread_.join();
+    close(wake_fd_);
+#endif
+    std::unordered_map<uint32_t, WatchPtr> watches;
+    {
+        std::lock_guard lock(mutex_);
+        watches.swap(watches_);
+    }
+    // callbacks may still be running and need the mutex; release without holding it
+    watches.clear();
+    releaseFinished();
+}
+
+bool ProcessWatcher::watch(uint32_t pid)
+{
+    if (watching(pid)) {
+        return true;
+    }
+    WatchPtr watch(new Watch{this, pid});
+#ifdef _WIN32
+    watch->process = OpenProcess(SYNCHRONIZE | PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (watch->process == nullptr) {
+        spdlog::trace("ProcessWatcher: can't open process {}; error: {}", pid, GetLastError());
+        return false;
+    }
+    // held while registering; the callback may fire right away and must find the watch
+    std::lock_guard lock(mutex_);
+    if (!RegisterWaitForSingleObject(&watch->wait, watch->process, &ProcessWatcher::WaitCallback, watch.get(), INFINITE, WT_EXECUTEONLYONCE)) {
+        spdlog::error("ProcessWatcher: can't wait for process {}; error: {}", pid, GetLastError());
+        watch->wait = nullptr;
+        return false;
+    }
+    watches_.emplace(pid, std::move(watch));
+#else
+    watch->fd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+    if (watch->fd < 0) {
+        spdlog::trace("ProcessWatcher: can't open process {}", pid);
+        return false;
+    }
+    {
+        std::lock_guard lock(mutex_);
+        watches_.emplace(pid, std::move(watch));
+    }
+    wakePollThread();
+#endif
+    return true;
+}
+
+void ProcessWatcher::unwatch(uint32_t pid)
+{
+    {
+        std::lock_guard lock(mutex_);
+        const auto it = watches_.find(pid);
+        if (it == watches_.end()) {
+            return;
+        }
+        finished_.push_back(std::move(it->second));
+        watches_.erase(it);
+    }
+#ifdef _WIN32
+    releaseFinished();
+#else
+    wakePollThread();
+#endif
+}
+
+bool ProcessWatcher::watching(uint32_t pid) const
+{
+    std::lock_guard lock(mutex_);
+    return watches_.contains(pid);
+}
+
+size_t ProcessWatcher::size() const
+{
+    std::lock_guard lock(mutex_);
+    return watches_.size();
+}
+
+bool ProcessWatcher::hasExits() const
+{
+    return has_exits_;
+}
+
+std::vector<ProcessWatcher::Exit> ProcessWatcher::takeExits()
+{
+    std::vector<Exit> exits;
+    if (!has_exits_) {
+        return exits;
+    }
+    {
+        std::lock_guard lock(mutex_);
+        exits.swap(exits_);
+        has_exits_ = false;
+    }
+#ifdef _WIN32
+    releaseFinished();
+#endif
+    return exits;
+}
+
+void ProcessWatcher::onExit(Watch* watch, uint32_t exit_code)
+{
+    {
+        std::lock_guard lock(mutex_);
+        const auto it = watches_.find(watch->pid);
+        // unwatched in the meantime
+        if (it == watches_.end() || it->second.get() != watch) {
+            return;
+        }
+        finished_.push_back(std::move(it->second));
+        watches_.erase(it);
+        exits_.push_back({watch->pid, exit_code});
+        has_exits_ = true;
+    }
+    if (on_exit_) {
+        on_exit_();
+    }
+}
+
+void ProcessWatcher::releaseFinished()
+{
+    std::vector<WatchPtr> finished;
+    {
+        std::lock_guard lock(mutex_);
+        finished.swap(finished_);
+    }
+}
+
+#ifdef _WIN32
+void ProcessWatcher::WaitCallback(void* context, unsigned char timed_out)
+{
+    const auto watch = static_cast<Watch*>(context);
+    DWORD exit_code = 0;
+    GetExitCodeProcess(watch->process, &exit_code);
+    watch->owner->onExit(watch, exit_code);
+}
+#else
+void ProcessWatcher::wakePollThread() const
+{
+    const uint64_t one = 1;
+    [[maybe_unused]] const auto written = write(wake_fd_, &one, sizeof(one));
+}
+
+void ProcessWatcher::pollLoop()
+{
+    std::vector<pollfd> fds;
+    std::vector<Watch*> polled;
+    while (run_) {
+        // fds are only ever closed here, never while they are being polled
+        releaseFinished();
+        fds.assign(1, pollfd{wake_fd_, POLLIN, 0});
+        polled.assign(1, nullptr);
+        {
+            std::lock_guard lock(mutex_);
+            for (const auto& [pid, watch] : watches_) {
+                fds.push_back({watch->fd, POLLIN, 0});
+                polled.push_back(watch.get());
+            }
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            continue;
+        }
+        if (fds[0].revents & POLLIN) {
+            uint64_t count;
+            [[maybe_unused]] const auto read_bytes = read(wake_fd_, &count, sizeof(count));
+        }
+        for (size_t i = 1; i < fds.size(); i++) {
+            if (fds[i].revents & (POLLIN | POLLHUP)) {
+                siginfo_t info{};
+                // only works (and reaps) if it is our child; exit code stays 0 otherwise
+                waitid(static_cast<idtype_t>(P_PIDFD), static_cast<id_t>(polled[i]->fd), &info, WEXITED | WNOHANG);
+                onExit(polled[i], static_cast<uint32_t>(info.si_status));
+            }
+        }
+    }
+}
+#endif
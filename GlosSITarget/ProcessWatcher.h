@@ -0,0 +1,86 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Reports process exits without polling
+ *
+ * Every watched process keeps an open handle (Windows: thread pool wait; Linux: pidfd),
+ * so its PID can't be recycled while it is watched.
+ * Exits are queued and picked up with takeExits(); on_exit is called from the waiting thread
+ * right after an exit got queued and is meant to wake up the main loop, nothing more.
+ */
+class ProcessWatcher {
+  public:
+    struct Exit {
+        uint32_t pid = 0;
+        uint32_t exit_code = 0;
+    };
+
+    explicit ProcessWatcher(std::function<void()> on_exit = nullptr);
+    ~ProcessWatcher();
+
+    ProcessWatcher(const ProcessWatcher&) = delete;
+    ProcessWatcher& operator=(const ProcessWatcher&) = delete;
+
+    // false if the process isn't running or can't be opened
+    bool watch(uint32_t pid);
+    void unwatch(uint32_t pid);
+    // true until the exit has been reported
+    bool watching(uint32_t pid) const;
+    size_t size() const;
+
+    bool hasExits() const;
+    // Exits since the last call, in order
+    std::vector<Exit> takeExits();
+
+  private:
+    struct Watch;
+    struct WatchDeleter {
+        void operator()(Watch* watch) const;
+    };
+    using WatchPtr = std::unique_ptr<Watch, WatchDeleter>;
+
+    std::function<void()> on_exit_;
+    mutable std::mutex mutex_;
+    std::unordered_map<uint32_t, WatchPtr> watches_;
+    // exited/unwatched; released outside of mutex_ (Windows) or by the poll thread (Linux)
+    std::vector<WatchPtr> finished_;
+    std::vector<Exit> exits_;
+    std::atomic<bool> has_exits_ = false;
+
+    // called by the backend once the process is gone
+    void onExit(Watch* watch, uint32_t exit_code);
+    void releaseFinished();
+
+#ifdef _WIN32
+    static void __stdcall WaitCallback(void* context, unsigned char timed_out);
+#else
+    int wake_fd_ = -1;
+    std::atomic<bool> run_ = true;
+    std::thread poll_thread_;
+    void wakePollThread() const;
+    void pollLoop();
+#endif
+};
@@ -0,0 +1,293 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+/*
+ * Scoped-zone CPU profiler
+ *
+ * PROFILE_ZONE("name") times the enclosing scope. Every thread writes into its own fixed size ring,
+ * so recording never locks or allocates: two clock reads and a couple of relaxed stores.
+ * Readers (the http-server) copy the rings out concurrently and drop whatever got overwritten meanwhile.
+ * Rings of exited threads are handed to the next new thread, so short lived threads don't pile up rings.
+ *
+ * Zone names have to be string literals (only the pointer is stored).
+ * Define GLOSSI_NO_PROFILER to compile every zone out.
+ */
+namespace Profiler {
+
+using clock = std::chrono::steady_clock;
+
+struct Event {
+    const char* name = nullptr;
+    // since Epoch()
+    std::chrono::nanoseconds start{};
+    std::chrono::nanoseconds duration{};
+};
+
+inline clock::time_point Epoch()
+{
+    static const auto epoch = clock::now();
+    return epoch;
+}
+
+inline std::atomic<bool>& EnabledFlag()
+{
+    static std::atomic<bool> enabled = true;
+    return enabled;
+}
+
+inline bool IsEnabled()
+{
+    return EnabledFlag().load(std::memory_order_relaxed);
+}
+
+inline void SetEnabled(bool enabled)
+{
+    EnabledFlag().store(enabled, std::memory_order_relaxed);
+}
+
+class ThreadBuffer {
+  public:
+    // ~1-2 minutes of a 60fps main loop with a handful of zones
+    static constexpr size_t CAPACITY = 1 << 15;
+
+    void push(const char* name, std::chrono::nanoseconds start, std::chrono::nanoseconds duration)
+    {
+        const auto head = head_.load(std::memory_order_relaxed);
+        auto& slot = slots_[head % CAPACITY];
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.start.store(start.count(), std::memory_order_relaxed);
+        slot.duration.store(duration.count(), std::memory_order_relaxed);
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    // Events that started at or after `since`
+    void collect(std::chrono::nanoseconds since, std::vector<Event>& out) const
+    {
+        const auto head = head_.load(std::memory_order_acquire);
+        const auto first = std::max<uint64_t>(head > CAPACITY ? head - CAPACITY : 0, first_.load(std::memory_order_acquire));
+        std::vector<Event> copied;
+        copied.reserve(static_cast<size_t>(head - first));
+        for (auto i = first; i < head; i++) {
+            const auto& slot = slots_[i % CAPACITY];
+            copied.push_back({
+                slot.name.load(std::memory_order_relaxed),
+                std::chrono::nanoseconds(slot.start.load(std::memory_order_relaxed)),
+                std::chrono::nanoseconds(slot.duration.load(std::memory_order_relaxed)),
+            });
+        }
+        // the writer may have lapped us while copying; those slots (+ the one currently written) might be torn
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const auto new_head = head_.load(std::memory_order_relaxed);
+        const auto valid_first = new_head + 1 > CAPACITY ? new_head + 1 - CAPACITY : 0;
+        for (size_t i = 0; i < copied.size(); i++) {
+            if (first + i >= valid_first && copied[i].start >= since) {
+                out.push_back(copied[i]);
+            }
+        }
+    }
+
+    // Hands the buffer to a new thread; events of the previous one are no longer reported
+    void reset()
+    {
+        first_.store(head_.load(std::memory_order_relaxed), std::memory_order_release);
+        setName({});
+    }
+
+    std::string name() const
+    {
+        std::lock_guard lock(name_mtx_);
+        return name_;
+    }
+
+    void setName(std::string name)
+    {
+        std::lock_guard lock(name_mtx_);
+        name_ = std::move(name);
+    }
+
+  private:
+    struct Slot {
+        std::atomic<const char*> name = nullptr;
+        std::atomic<int64_t> start = 0;
+        std::atomic<int64_t> duration = 0;
+    };
+    std::array<Slot, CAPACITY> slots_{};
+    std::atomic<uint64_t> head_ = 0;
+    std::atomic<uint64_t> first_ = 0;
+    mutable std::mutex name_mtx_;
+    std::string name_;
+};
+
+class Registry {
+  public:
+    static Registry& Instance()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    // Reuses the buffer of an exited thread if there is one
+    ThreadBuffer* acquire()
+    {
+        std::lock_guard lock(mtx_);
+        if (!free_.empty()) {
+            auto buffer = free_.back();
+            free_.pop_back();
+            buffer->reset();
+            return buffer;
+        }
+        return buffers_.emplace_back(std::make_shared<ThreadBuffer>()).get();
+    }
+
+    // Called once the owning thread exited
+    void release(ThreadBuffer* buffer)
+    {
+        std::lock_guard lock(mtx_);
+        free_.push_back(buffer);
+    }
+
+    // Buffers of exited threads are kept until reused; their events are still interesting
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers() const
+    {
+        std::lock_guard lock(mtx_);
+        return buffers_;
+    }
+
+  private:
+    mutable std::mutex mtx_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+    std::vector<ThreadBuffer*> free_;
+};
+
+namespace detail {
+inline ThreadBuffer* AcquireThreadBuffer()
+{
+    // only touched once per thread; gives the buffer back to the registry on thread exit
+    thread_local const struct Owner {
+        ThreadBuffer* buffer;
+        ~Owner()
+        {
+            Registry::Instance().release(buffer);
+        }
+    } owner{Registry::Instance().acquire()};
+    return owner.buffer;
+}
+} // namespace detail
+
+inline ThreadBuffer& CurrentThreadBuffer()
+{
+    // plain pointer: trivially initialized thread_locals skip the init guard on every access
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (buffer == nullptr) [[unlikely]] {
+        buffer = detail::AcquireThreadBuffer();
+    }
+    return *buffer;
+}
+
+// Shows up as thread name in the trace
+inline void SetThreadName(std::string name)
+{
+    CurrentThreadBuffer().setName(std::move(name));
+}
+
+class Zone {
+  public:
+    explicit Zone(const char* name) : name_(IsEnabled() ? name : nullptr)
+    {
+        if (name_) {
+            start_ = clock::now();
+        }
+    }
+
+    ~Zone()
+    {
+        if (name_) {
+            const auto end = clock::now();
+            CurrentThreadBuffer().push(name_, start_ - Epoch(), end - start_);
+        }
+    }
+
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+
+  private:
+    const char* name_;
+    clock::time_point start_;
+};
+
+/*
+ * Chrome trace-event format (chrome://tracing, ui.perfetto.dev) of the last `window`
+ */
+inline nlohmann::json ChromeTrace(std::chrono::nanoseconds window)
+{
+    const auto since = clock::now() - Epoch() - window;
+    auto events = nlohmann::json::array();
+    int tid = 0;
+    std::vector<Event> collected;
+    for (const auto& buffer : Registry::Instance().buffers()) {
+        tid++;
+        collected.clear();
+        buffer->collect(since, collected);
+        auto name = buffer->name();
+        if (name.empty()) {
+            name = "Thread " + std::to_string(tid);
+        }
+        events.push_back({
+            {"name", "thread_name"},
+            {"ph", "M"},
+            {"pid", 1},
+            {"tid", tid},
+            {"args", {{"name", name}}},
+        });
+        for (const auto& e : collected) {
+            events.push_back({
+                {"name", e.name},
+                {"ph", "X"},
+                {"pid", 1},
+                {"tid", tid},
+                {"ts", std::chrono::duration<double, std::micro>(e.start).count()},
+                {"dur", std::chrono::duration<double, std::micro>(e.duration).count()},
+            });
+        }
+    }
+    return {
+        {"traceEvents", events},
+        {"displayTimeUnit", "ms"},
+    };
+}
+
+} // namespace Profiler
+
+#define GLOSSI_PROFILE_CONCAT_INNER(a, b) a##b
+#define GLOSSI_PROFILE_CONCAT(a, b) GLOSSI_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef GLOSSI_NO_PROFILER
+#define PROFILE_ZONE(name)
+#else
+#define PROFILE_ZONE(name) const Profiler::Zone GLOSSI_PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#endif
@@ -0,0 +1,188 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "InputSource.h"
+#include "TickClock.h"
+
+struct ReplayFrame {
+    // offset from start of playback
+    TickClock::duration at{};
+    uint32_t pad = 0;
+    bool connected = true;
+    Ds4Translation::XusbReport gamepad{};
+};
+
+// Sequence of frames, ordered by time
+class ReplayStream {
+  public:
+    virtual ~ReplayStream() = default;
+    virtual size_t padCount() const = 0;
+    virtual bool next(ReplayFrame& frame) = 0;
+    virtual void rewind() = 0;
+};
+
+class FrameVectorStream : public ReplayStream {
+  public:
+    explicit FrameVectorStream(std::vector<ReplayFrame> frames) : frames_(std::move(frames))
+    {
+        std::stable_sort(frames_.begin(), frames_.end(), [](const auto& a, const auto& b) { return a.at < b.at; });
+        for (const auto& frame : frames_) {
+            pad_count_ = std::max<size_t>(pad_count_, frame.pad + 1);
+        }
+    }
+
+    size_t padCount() const override
+    {
+        return pad_count_;
+    }
+
+    bool next(ReplayFrame& frame) override
+    {
+        if (cursor_ >= frames_.size()) {
+            return false;
+        }
+        frame = frames_[cursor_++];
+        return true;
+    }
+
+    void rewind() override
+    {
+        cursor_ = 0;
+    }
+
+  private:
+    std::vector<ReplayFrame> frames_;
+    size_t cursor_ = 0;
+    size_t pad_count_ = 0;
+};
+
+/*
+ * Plays back a scripted/recorded sequence of controller states
+ *
+ * RealTime: frames are applied once their timestamp has passed on the given clock,
+ *           so playback is as deterministic as the clock driving it.
+ * MaxSpeed: every tick advances to the next timestamp in the recording, regardless of the clock.
+ */
+class ReplayInputSource : public InputSource {
+  public:
+    enum class Speed {
+        RealTime,
+        MaxSpeed,
+    };
+
+    ReplayInputSource(TickClock& clock, std::unique_ptr<ReplayStream> stream, Speed speed = Speed::RealTime, bool loop = false)
+        : clock_(clock), stream_(std::move(stream)), speed_(speed), loop_(loop), pads_(stream_->padCount())
+    {
+        fetch();
+    }
+
+    ReplayInputSource(TickClock& clock, std::vector<ReplayFrame> frames, Speed speed = Speed::RealTime, bool loop = false)
+        : ReplayInputSource(clock, std::make_unique<FrameVectorStream>(std::move(frames)), speed, loop)
+    {
+    }
+
+    const char* name() const override
+    {
+        return "Replay";
+    }
+
+    size_t maxPads() const override
+    {
+        return pads_.size();
+    }
+
+    bool realTime() const override
+    {
+        return speed_ == Speed::RealTime;
+    }
+
+    void beginTick() override
+    {
+        const auto now = clock_.now();
+        if (!started_) {
+            started_ = true;
+            start_ = now;
+        }
+        if (!pending_ && loop_) {
+            stream_->rewind();
+            start_ = now;
+            fetch();
+        }
+        if (!pending_) {
+            return;
+        }
+        const auto until = speed_ == Speed::MaxSpeed ? pending_->at : now - start_;
+        while (pending_ && pending_->at <= until) {
+            const auto& frame = *pending_;
+            auto& pad = pads_[frame.pad];
+            pad.connected = frame.connected;
+            pad.state.gamepad = frame.gamepad;
+            pad.state.packet++;
+            fetch();
+        }
+    }
+
+    bool poll(size_t idx, PadState& state) override
+    {
+        if (idx >= pads_.size() || !pads_[idx].connected) {
+            return false;
+        }
+        state = pads_[idx].state;
+        return true;
+    }
+
+    bool setVibration(size_t idx, uint8_t, uint8_t) override
+    {
+        return idx < pads_.size() && pads_[idx].connected;
+    }
+
+    bool finished() const
+    {
+        return !pending_;
+    }
+
+  private:
+    struct Pad {
+        bool connected = false;
+        PadState state;
+    };
+
+    TickClock& clock_;
+    std::unique_ptr<ReplayStream> stream_;
+    Speed speed_;
+    bool loop_ = false;
+    std::vector<Pad> pads_;
+    std::optional<ReplayFrame> pending_;
+    bool started_ = false;
+    TickClock::time_point start_{};
+
+    void fetch()
+    {
+        ReplayFrame frame;
+        pending_.reset();
+        while (stream_->next(frame)) {
+            if (frame.pad < pads_.size()) {
+                pending_ = frame;
+                return;
+            }
+        }
+    }
+};
@@ -0,0 +1,160 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "ScreenCapture.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+#include <spdlog/spdlog.h>
+
+#include "PixelSwizzle.h"
+#include "Profiler.h"
+
+ScreenCapture::~ScreenCapture()
+{
+    {
+        std::lock_guard lock(worker_mtx_);
+        quit_ = true;
+    }
+    worker_cv_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void ScreenCapture::start(const DisplayTopology::Rect& rect)
+{
+    if (state_ == State::Capturing) {
+        return;
+    }
+    if (!worker_.joinable()) {
+        worker_ = std::thread(&ScreenCapture::workerLoop, this);
+    }
+    {
+        std::lock_guard lock(worker_mtx_);
+        rect_ = rect;
+        capture_requested_ = true;
+        state_ = State::Capturing;
+    }
+    worker_cv_.notify_one();
+}
+
+ScreenCapture::State ScreenCapture::state() const
+{
+    return state_;
+}
+
+void ScreenCapture::reset()
+{
+    if (state_ != State::Capturing) {
+        state_ = State::Idle;
+    }
+}
+
+unsigned int ScreenCapture::width() const
+{
+    return width_;
+}
+
+unsigned int ScreenCapture::height() const
+{
+    return height_;
+}
+
+const uint8_t* ScreenCapture::pixels() const
+{
+    return pixels_.data();
+}
+
+void ScreenCapture::workerLoop()
+{
+    Profiler::SetThreadName("Screen capture");
+    std::unique_lock lock(worker_mtx_);
+    while (true) {
+        worker_cv_.wait(lock, [this] { return capture_requested_ || quit_; });
+        if (quit_) {
+            return;
+        }
+        capture_requested_ = false;
+        lock.unlock();
+        state_ = capture() ? State::Done : State::Failed;
+        lock.lock();
+    }
+}
+
+bool ScreenCapture::capture()
+{
+    PROFILE_ZONE("ScreenCapture::capture");
+#ifdef _WIN32
+    HDC screen_dc = GetDC(nullptr);
+    if (screen_dc == nullptr) {
+        spdlog::error("Screenshot: couldn't get screen DC");
+        return false;
+    }
+    // screen DC spans the whole virtual screen
+    const int width = rect_.width();
+    const int height = rect_.height();
+    HDC memory_dc = CreateCompatibleDC(screen_dc);
+
+    BITMAPINFO bmp_info{};
+    bmp_info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmp_info.bmiHeader.biWidth = width;
+    // top-down
+    bmp_info.bmiHeader.biHeight = -height;
+    bmp_info.bmiHeader.biPlanes = 1;
+    bmp_info.bmiHeader.biBitCount = 32;
+    bmp_info.bmiHeader.biCompression = BI_RGB;
+    void* bits = nullptr;
+    // BitBlt writes right into memory we can read; no GetDIBits copy
+    HBITMAP bitmap = CreateDIBSection(memory_dc, &bmp_info, DIB_RGB_COLORS, &bits, nullptr, 0);
+
+    bool ok = false;
+    if (memory_dc != nullptr && bitmap != nullptr && bits != nullptr) {
+        const auto old_bitmap = SelectObject(memory_dc, bitmap);
+        {
+            PROFILE_ZONE("BitBlt");
+            ok = BitBlt(memory_dc, 0, 0, width, height, screen_dc, rect_.left, rect_.top, SRCCOPY);
+            GdiFlush();
+        }
+        if (ok) {
+            PROFILE_ZONE("Swizzle");
+            width_ = static_cast<unsigned int>(width);
+            height_ = static_cast<unsigned int>(height);
+            pixels_.resize(static_cast<size_t>(width_) * height_ * 4);
+            PixelSwizzle::BgrxToRgba(static_cast<const uint8_t*>(bits), pixels_.data(), static_cast<size_t>(width_) * height_);
+        }
+        else {
+            spdlog::error("Screenshot: BitBlt failed; error: {}", GetLastError());
+        }
+        SelectObject(memory_dc, old_bitmap);
+    }
+    else {
+        spdlog::error("Screenshot: couldn't create {}x{} bitmap", width, height);
+    }
+    if (bitmap != nullptr) {
+        DeleteObject(bitmap);
+    }
+    if (memory_dc != nullptr) {
+        DeleteDC(memory_dc);
+    }
+    ReleaseDC(nullptr, screen_dc);
+    return ok;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,79 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "DisplayTopology.h"
+
+/*
+ * Grabs the screen on a worker thread
+ *
+ * The worker is started with the first capture and then waits for the next one,
+ * instead of spawning a thread on every screenshot.
+ *
+ * The desktop is blitted straight into a DIB section and swizzled from there into an RGBA buffer,
+ * ready to be handed to sf::Texture::update() as is.
+ *
+ * Not thread safe; start(), state() and the accessors are meant to be used from one (the render) thread.
+ */
+class ScreenCapture {
+  public:
+    ScreenCapture() = default;
+    ~ScreenCapture();
+
+    ScreenCapture(const ScreenCapture&) = delete;
+    ScreenCapture& operator=(const ScreenCapture&) = delete;
+
+    enum class State {
+        Idle,
+        Capturing,
+        Done,
+        Failed,
+    };
+
+    // Starts a new capture of the given part of the virtual screen unless one is still running
+    void start(const DisplayTopology::Rect& rect);
+    State state() const;
+    // Back to Idle unless still capturing; the pixel buffer is kept for the next capture
+    void reset();
+
+    // Only valid while state() == Done
+    unsigned int width() const;
+    unsigned int height() const;
+    const uint8_t* pixels() const;
+
+  private:
+    std::atomic<State> state_ = State::Idle;
+    std::thread worker_;
+    std::mutex worker_mtx_;
+    std::condition_variable worker_cv_;
+    bool capture_requested_ = false;
+    bool quit_ = false;
+    // only written while not capturing
+    DisplayTopology::Rect rect_;
+
+    unsigned int width_ = 0;
+    unsigned int height_ = 0;
+    std::vector<uint8_t> pixels_;
+
+    void workerLoop();
+    bool capture();
+};
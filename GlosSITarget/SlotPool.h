@@ -0,0 +1,85 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <memory>
+#include <vector>
+
+/*
+ * Dynamically sized set of controller slots
+ *
+ * Slots never move in memory once created; pointers to them can be handed
+ * to driver callbacks (e.g. as ViGEm notification user data).
+ * Shrinking destroys the trailing slots, so only shrink while nothing refers to them.
+ * T needs a `size_t index` member; it is set to the slots position.
+ */
+template <typename T>
+class SlotPool {
+  public:
+    size_t size() const
+    {
+        return slots_.size();
+    }
+
+    T& operator[](size_t idx)
+    {
+        return *slots_[idx];
+    }
+
+    const T& operator[](size_t idx) const
+    {
+        return *slots_[idx];
+    }
+
+    void resize(size_t count)
+    {
+        const auto old_size = slots_.size();
+        slots_.resize(count);
+        for (size_t i = old_size; i < count; i++) {
+            slots_[i] = std::make_unique<T>();
+            slots_[i]->index = i;
+        }
+    }
+
+    auto begin()
+    {
+        return Iterator{slots_.begin()};
+    }
+
+    auto end()
+    {
+        return Iterator{slots_.end()};
+    }
+
+  private:
+    std::vector<std::unique_ptr<T>> slots_;
+
+    struct Iterator {
+        typename std::vector<std::unique_ptr<T>>::iterator it;
+        T& operator*() const
+        {
+            return **it;
+        }
+        Iterator& operator++()
+        {
+            ++it;
+            return *this;
+        }
+        bool operator!=(const Iterator& other) const
+        {
+            return it != other.it;
+        }
+    };
+};
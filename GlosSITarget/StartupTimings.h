@@ -0,0 +1,124 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+/*
+ * Startup phase timings
+ *
+ * Mark("phase") records the time since the previous mark (or process creation);
+ * Report() logs everything once, after that marks are ignored.
+ */
+namespace StartupTimings {
+
+struct Phase {
+    std::string name;
+    std::chrono::steady_clock::duration duration;
+};
+
+namespace detail {
+struct State {
+    std::mutex mutex;
+    std::vector<Phase> phases;
+    std::chrono::steady_clock::time_point process_start;
+    std::chrono::steady_clock::time_point last;
+    bool reported = false;
+
+    State()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        process_start = now;
+#ifdef _WIN32
+        FILETIME creation, exit, kernel, user;
+        if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+            FILETIME now_ft;
+            GetSystemTimeAsFileTime(&now_ft);
+            const auto to_100ns = [](const FILETIME& ft) {
+                return (static_cast<int64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+            };
+            const auto since_creation = std::chrono::duration<int64_t, std::ratio<1, 10'000'000>>(to_100ns(now_ft) - to_100ns(creation));
+            process_start = now - std::chrono::duration_cast<std::chrono::steady_clock::duration>(since_creation);
+        }
+#endif
+        last = process_start;
+    }
+};
+
+inline State& Get()
+{
+    static State state;
+    return state;
+}
+} // namespace detail
+
+inline void Mark(const std::string& name)
+{
+    auto& state = detail::Get();
+    std::lock_guard lock(state.mutex);
+    if (state.reported) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    state.phases.push_back({name, now - state.last});
+    state.last = now;
+}
+
+inline double SinceProcessStartMs()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - detail::Get().process_start).count();
+}
+
+inline void Report()
+{
+    auto& state = detail::Get();
+    std::lock_guard lock(state.mutex);
+    if (state.reported) {
+        return;
+    }
+    state.reported = true;
+    std::string report;
+    for (const auto& phase : state.phases) {
+        report += fmt::format("\n  {:<24} {:>8.1f}ms", phase.name, std::chrono::duration<double, std::milli>(phase.duration).count());
+    }
+    spdlog::info("Startup took {:.1f}ms:{}", std::chrono::duration<double, std::milli>(state.last - state.process_start).count(), report);
+}
+
+inline nlohmann::json Json()
+{
+    auto& state = detail::Get();
+    std::lock_guard lock(state.mutex);
+    auto phases = nlohmann::json::array();
+    for (const auto& phase : state.phases) {
+        phases.push_back({{"name", phase.name}, {"ms", std::chrono::duration<double, std::milli>(phase.duration).count()}});
+    }
+    return {
+        {"totalMs", std::chrono::duration<double, std::milli>(state.last - state.process_start).count()},
+        {"phases", phases},
+    };
+}
+
+} // namespace StartupTimings
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <spdlog/spdlog.h>
 
+#include "Log.h"
+#include "Profiler.h"
 #include "..\common\Settings.h"
 
 #ifdef _WIN32
@@ -31,6 +33,7 @@ SteamOverlayDetector::SteamOverlayDetector(std::function<void(bool)> overlay_cha
 
 void SteamOverlayDetector::update()
 {
+    PROFILE_ZONE("SteamOverlayDetector::update");
 #ifdef _WIN32
     // Steam hooks into Windows messages
     // as long as the overlay is open, every msg (except for input messages?)
@@ -47,8 +50,8 @@ void SteamOverlayDetector::update()
     if (PeekMessage(&msg, nullptr, 0, 0, PM_NOREMOVE)) {
         // filter out some messages as not all get altered by steam...
 
-        if (Settings::common.extendedLogging && msg.message != 512 && msg.message != 5374) {
-            spdlog::trace("PeekMessage: Window msg: {}", msg.message);
+        if (msg.message != 512 && msg.message != 5374) {
+            GLOSSI_EXT_TRACE(Log::WINDOW, "PeekMessage: Window msg: {}", msg.message);
         }
 
         if (msg.message < 1000 && msg.message > 0) {
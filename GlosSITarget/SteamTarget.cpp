@@ -29,25 +29,40 @@ limitations under the License.
 #include <CEFInject.h>
 
 #include "CommonHttpEndpoints.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "StartupTimings.h"
 
 SteamTarget::SteamTarget()
-    : window_(
+    : frame_scheduler_(frame_clock_, FrameScheduler::Config{}),
+      window_(
           [this] { run_ = false; },
           [this] { toggleGlossiOverlay(); },
           util::steam::getScreenshotHotkey(steam_path_, steam_user_id_),
           [this]() {
               target_window_handle_ = window_.getSystemHandle();
               overlay_ = window_.getOverlay();
+          },
+          [] {
+#ifdef _WIN32
+              return force_config_windows_.trackedWindows();
+#else
+              return std::vector<WindowHandle>{};
+#endif
           }),
       overlay_(window_.getOverlay()),
       detector_([this](bool overlay_open) { onOverlayChanged(overlay_open); }),
-      launcher_(force_config_hwnds_, [this] {
-          delayed_shutdown_ = true;
-          delay_shutdown_clock_.restart();
-      }),
-      server_([this] { run_ = false; })
+      launcher_(
+          force_config_windows_,
+          [this] {
+              delayed_shutdown_ = true;
+              delay_shutdown_clock_.restart();
+          },
+          [this] { frame_scheduler_.wake(); }),
+      server_([this] { run_ = false; }, [this] { frame_scheduler_.wake(); })
 {
     target_window_handle_ = window_.getSystemHandle();
+    StartupTimings::Mark("Target init");
 }
 
 int SteamTarget::run()
@@ -65,8 +80,17 @@ int SteamTarget::run()
     steam_tweaks.setAutoInject(true);
 
     CHTE::addEndpoints();
+    // stages have to exist before the http-server starts reading them
+    auto& detector_stage = frame_scheduler_.addStage("Overlay detection");
+    auto& hotkey_stage = frame_scheduler_.addStage("Hotkeys");
+    auto& window_stage = frame_scheduler_.addStage("Render");
+    auto& tweaks_stage = frame_scheduler_.addStage("Steam tweaks");
+    auto& launcher_stage = frame_scheduler_.addStage("Launcher");
+
+    addFrameStats();
 
     server_.run();
+    StartupTimings::Mark("HTTP server");
 
 
     if (!overlay_.expired())
@@ -179,41 +203,67 @@ int SteamTarget::run()
     const auto tray = createTrayMenu();
     
     bool delayed_full_init_1_frame = false;
+    bool startup_reported = false;
     sf::Clock frame_time_clock;
 
+    Profiler::SetThreadName("Main");
     while (run_) {
-        if (!fully_initialized_ && can_fully_initialize_ && delayed_full_init_1_frame) {
-            init_FuckingRenameMe();
-        }
-        else if (!fully_initialized_ && can_fully_initialize_) {
-            delayed_full_init_1_frame = true;
-        }
-        else {
-            delayed_full_init_1_frame = false;
-        }
-        detector_.update();
-        overlayHotkeyWorkaround();
-        window_.update();
+        {
+            PROFILE_ZONE("Frame");
+            if (!fully_initialized_ && can_fully_initialize_ && delayed_full_init_1_frame) {
+                init_FuckingRenameMe();
+            }
+            else if (!fully_initialized_ && can_fully_initialize_) {
+                delayed_full_init_1_frame = true;
+            }
+            else {
+                delayed_full_init_1_frame = false;
+            }
+            {
+                const auto timer = frame_scheduler_.time(detector_stage);
+                detector_.update();
+            }
+            {
+                const auto timer = frame_scheduler_.time(hotkey_stage);
+                overlayHotkeyWorkaround();
+            }
+            {
+                const auto timer = frame_scheduler_.time(window_stage);
+                window_.update();
+            }
+            if (!startup_reported) {
+                startup_reported = true;
+                StartupTimings::Mark("First frame");
+                StartupTimings::Report();
+            }
 
-        if (cef_tweaks_enabled_ && fully_initialized_) {
-            steam_tweaks_.update(frame_time_clock.getElapsedTime().asSeconds());
-        }
+            if (cef_tweaks_enabled_ && fully_initialized_) {
+                const auto timer = frame_scheduler_.time(tweaks_stage);
+                steam_tweaks_.update(frame_time_clock.getElapsedTime().asSeconds());
+            }
 
-        // Wait on shutdown; User might get confused if window closes to fast if anything with launchApp get's borked.
-        if (delayed_shutdown_) {
-            if (delay_shutdown_clock_.getElapsedTime().asSeconds() >= 3) {
-                run_ = false;
+            // Wait on shutdown; User might get confused if window closes to fast if anything with launchApp get's borked.
+            if (delayed_shutdown_) {
+                if (delay_shutdown_clock_.getElapsedTime().asSeconds() >= 3) {
+                    run_ = false;
+                }
             }
-        }
-        else {
-            if (fully_initialized_) {
-                launcher_.update();
+            else {
+                if (fully_initialized_) {
+                    const auto timer = frame_scheduler_.time(launcher_stage);
+                    launcher_.update();
+                }
             }
+            for (auto& efc : end_frame_callbacks) {
+                efc();
+            }
+            end_frame_callbacks.clear();
+            updateFramePacing();
         }
-        for (auto& efc : end_frame_callbacks) {
-            efc();
+        {
+            PROFILE_ZONE("Wait for next frame");
+            frame_scheduler_.waitForNextFrame();
         }
-        end_frame_callbacks.clear();
         frame_time_clock.restart();
     }
     tray->exit();
@@ -235,6 +285,7 @@ int SteamTarget::run()
 
 void SteamTarget::onOverlayChanged(bool overlay_open)
 {
+    steam_overlay_open_ = overlay_open;
     if (overlay_open) {
         focusWindow(target_window_handle_);
         window_.setClickThrough(!overlay_open);
@@ -263,6 +314,90 @@ void SteamTarget::onOverlayChanged(bool overlay_open)
     }
 }
 
+void SteamTarget::updateFramePacing()
+{
+    const FrameScheduler::Config config{
+        .active_fps = window_.getFpsLimit(),
+        .idle_fps = Settings::window.idleFps,
+    };
+    if (config.active_fps != frame_scheduler_.config().active_fps || config.idle_fps != frame_scheduler_.config().idle_fps) {
+        frame_scheduler_.configure(config);
+    }
+    const bool glossi_overlay_open = !overlay_.expired() && overlay_.lock()->isEnabled();
+    frame_scheduler_.setActive(
+        Settings::window.idleFps == 0
+        || !fully_initialized_
+        || Settings::window.windowMode
+        || steam_overlay_open_
+        || glossi_overlay_open);
+}
+
+void SteamTarget::addFrameStats()
+{
+    const auto stage_json = [this](const FrameScheduler::Stage& stage) {
+        const auto s = stage.histogram.summary();
+        const auto us = [](auto d) { return std::chrono::duration<double, std::micro>(d).count(); };
+        return nlohmann::json{
+            {"name", stage.name},
+            {"count", s.count},
+            {"p50Us", us(s.p50)},
+            {"p99Us", us(s.p99)},
+            {"maxUs", us(s.max)},
+            {"budgetUs", us(frame_scheduler_.budget(stage))},
+            {"overBudget", stage.over_budget.load()},
+        };
+    };
+    HttpServer::AddEndpoint({
+        "/frame-stats",
+        HttpServer::Method::GET,
+        [this, stage_json](const httplib::Request& req, httplib::Response& res) {
+            const auto counters = window_.getFrameCounters();
+            nlohmann::json j = {
+                {"fps", frame_scheduler_.currentFps()},
+                {"idle", frame_scheduler_.isIdle()},
+                {"framesRendered", counters.rendered},
+                {"framesSkipped", counters.skipped},
+                {"frame", stage_json(frame_scheduler_.frame())},
+                {"stages", nlohmann::json::array()},
+            };
+            for (const auto& stage : frame_scheduler_.stages()) {
+                j["stages"].push_back(stage_json(stage));
+            }
+            res.set_content(j.dump(), "text/json");
+        },
+        {
+            {"fps", 20},
+            {"idle", true},
+            {"framesRendered", 600},
+            {"framesSkipped", 9400},
+            {"frame", {{"name", "Frame"}, {"count", 1200}, {"p50Us", 900.0}, {"p99Us", 4000.0}, {"maxUs", 16000.0}, {"budgetUs", 16666.7}, {"overBudget", 1}}},
+            {"stages", {{{"name", "Render"}, {"count", 1200}, {"p50Us", 700.0}, {"p99Us", 3500.0}, {"maxUs", 15000.0}, {"budgetUs", 16666.7}, {"overBudget", 0}}}},
+        },
+    });
+
+    Overlay::AddOverlayElem([this](bool window_has_focus, ImGuiID dockspace_id) {
+        ImGui::SetNextWindowDockID(dockspace_id, ImGuiCond_FirstUseEver);
+        ImGui::Begin("Frame Timing");
+        ImGui::Text("%u FPS%s", frame_scheduler_.currentFps(), frame_scheduler_.isIdle() ? " (idle)" : "");
+        const auto counters = window_.getFrameCounters();
+        ImGui::Text("Frames rendered: %llu; skipped (unchanged): %llu", counters.rendered, counters.skipped);
+        const auto show = [](const FrameScheduler::Stage& stage) {
+            const auto s = stage.histogram.summary();
+            const auto ms = [](auto d) { return std::chrono::duration<float, std::milli>(d).count(); };
+            ImGui::Text("%-18s p50: %6.2fms  p99: %6.2fms  max: %6.2fms  over budget: %llu",
+                        stage.name.c_str(), ms(s.p50), ms(s.p99), ms(s.max), stage.over_budget.load());
+        };
+        show(frame_scheduler_.frame());
+        for (const auto& stage : frame_scheduler_.stages()) {
+            show(stage);
+        }
+        if (ImGui::Button("Reset")) {
+            frame_scheduler_.resetStats();
+        }
+        ImGui::End();
+    });
+}
+
 void SteamTarget::toggleGlossiOverlay()
 {
     if (Settings::window.disableGlosSIOverlay) {
@@ -423,6 +558,9 @@ Application will not function!");
     }
 
     fully_initialized_ = true;
+    // forced elements (e.g. "Global mode is initializing") react to this
+    Overlay::MarkDirty();
+    spdlog::info("Fully initialized {:.1f}ms after process start", StartupTimings::SinceProcessStartMs());
 }
 
 /*
@@ -464,18 +602,16 @@ HWND SteamTarget::keepFgWindowHookFn()
     if (real_fg_win == nullptr) {
         return target_window_handle_;
     }
-    if (std::ranges::find_if(force_config_hwnds_, [real_fg_win](auto hwnd) {
-            return hwnd == real_fg_win;
-        }) != force_config_hwnds_.end()) {
+    if (force_config_windows_.isTracked(real_fg_win)) {
         if (last_real_hwnd_ != real_fg_win) {
             last_real_hwnd_ = real_fg_win;
-            spdlog::debug("Active window (\"{:#x}\") in launched process window list, forcing specific config", reinterpret_cast<uint64_t>(real_fg_win));
+            GLOSSI_DEBUG("Active window (\"{:#x}\") in launched process window list, forcing specific config", reinterpret_cast<uint64_t>(real_fg_win));
         }
         return target_window_handle_;
     }
     if (last_real_hwnd_ != real_fg_win) {
         last_real_hwnd_ = real_fg_win;
-        spdlog::debug("Active window (\"{:#x}\") not in launched process window list, allowing desktop-config", reinterpret_cast<uint64_t>(real_fg_win));
+        GLOSSI_DEBUG("Active window (\"{:#x}\") not in launched process window list, allowing desktop-config", reinterpret_cast<uint64_t>(real_fg_win));
     }
     return real_fg_win;
 }
@@ -511,12 +647,16 @@ std::unique_ptr<Tray::Tray> SteamTarget::createTrayMenu()
 
 void SteamTarget::overlayHotkeyWorkaround()
 {
+    PROFILE_ZONE("SteamTarget::overlayHotkeyWorkaround");
     static bool pressed = false;
     if (std::ranges::all_of(overlay_hotkey_,
                             [](const auto& key) {
                                 return sf::Keyboard::isKeyPressed(keymap::sfkey[key]);
                             })) {
-        spdlog::trace("Detected overlay hotkey(s)");
+        GLOSSI_TRACE("Detected overlay hotkey(s)");
+        if (!pressed) {
+            frame_scheduler_.wake();
+        }
         pressed = true;
         std::ranges::for_each(overlay_hotkey_, [this](const auto& key) {
 #ifdef _WIN32
@@ -525,7 +665,7 @@ void SteamTarget::overlayHotkeyWorkaround()
 
 #endif
         });
-        spdlog::trace("Sending Overlay KeyDown events...");
+        GLOSSI_TRACE("Sending Overlay KeyDown events...");
     }
     else if (pressed) {
         pressed = false;
@@ -536,6 +676,6 @@ void SteamTarget::overlayHotkeyWorkaround()
 
 #endif
         });
-        spdlog::trace("Sending Overlay KeyUp events...");
+        GLOSSI_TRACE("Sending Overlay KeyUp events...");
     }
 }
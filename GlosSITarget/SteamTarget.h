@@ -30,8 +30,10 @@ limitations under the License.
 
 #include "AppLauncher.h"
 #include "CEFInject.h"
+#include "FrameScheduler.h"
 #include "Overlay.h"
 #include "HttpServer.h"
+#include "WindowIndex.h"
 
 #include "../common/steam_util.h"
 
@@ -65,7 +67,8 @@ class SteamTarget {
 #ifdef _WIN32
     static HWND keepFgWindowHookFn();
     static inline subhook::Hook getFgWinHook;
-    static inline std::vector<HWND> force_config_hwnds_ = {};
+    // windows of launched processes; Steam keeps the game config while one of them is in foreground
+    static inline WindowIndex force_config_windows_;
     static inline HWND last_real_hwnd_ = nullptr;
 #endif
 
@@ -80,6 +83,19 @@ class SteamTarget {
     void overlayHotkeyWorkaround();
 
     bool run_ = false;
+
+#ifdef _WIN32
+    WaitableTimerTickClock frame_clock_;
+#else
+    SteadyTickClock frame_clock_;
+#endif
+    FrameScheduler frame_scheduler_;
+    bool steam_overlay_open_ = false;
+    // active rate while anything is visible, idle rate otherwise
+    void updateFramePacing();
+    // /frame-stats endpoint + overlay window
+    void addFrameStats();
+
     std::vector<std::string> overlay_hotkey_ = util::steam::getOverlayHotkey(steam_path_, steam_user_id_);
 
 #ifdef _WIN32
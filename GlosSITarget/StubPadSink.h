@@ -0,0 +1,257 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include "PadSink.h"
+#include "TickClock.h"
+
+/*
+ * In-process stand-in for the ViGEm bus
+ *
+ * Records every submitted report with a timestamp, so the whole controller pipeline
+ * can be run and measured without a driver (or Windows).
+ * Driver round-trips can be simulated by adding latency (busy waiting, sleeps are too coarse)
+ * and random failures; failures are seeded, so runs are reproducible.
+ * Tests can also inject failures directly (failNextSubmits) or have the "bus" drop a pad (removePad).
+ *
+ * Only the latest max_recorded_submissions reports are kept,
+ * as this is also the default sink when not on Windows and may run for a whole session.
+ */
+class StubPadSink : public PadSink {
+  public:
+    struct Options {
+        std::chrono::nanoseconds plug_latency{0};
+        std::chrono::nanoseconds unplug_latency{0};
+        std::chrono::nanoseconds submit_latency{0};
+        // 0..1
+        double plug_failure_rate = 0.0;
+        double submit_failure_rate = 0.0;
+        uint32_t seed = 1;
+        // ring buffer size; reserved up front, so recording doesn't allocate in the hot path
+        size_t max_recorded_submissions = 4096;
+        // timestamps submissions instead of steady_clock, e.g. the redirector's virtual clock in tests
+        const TickClock* clock = nullptr;
+    };
+
+    struct Submission {
+        std::chrono::steady_clock::time_point at;
+        size_t pad = 0;
+        Type type = Type::X360;
+        Ds4Translation::XusbReport report{};
+    };
+
+    StubPadSink() : StubPadSink(Options{}) {}
+
+    explicit StubPadSink(const Options& options) : options_(options), rng_(options.seed)
+    {
+        submissions_.reserve(options_.max_recorded_submissions);
+    }
+
+    const char* name() const override
+    {
+        return "Stub";
+    }
+
+    bool isConnected() const override
+    {
+        return true;
+    }
+
+    bool plug(size_t idx, const Config& config, FeedbackHandler handler, void* context) override
+    {
+        Spin(options_.plug_latency);
+        std::lock_guard lock(mtx_);
+        if (idx >= pads_.size()) {
+            pads_.resize(idx + 1);
+        }
+        if (pads_[idx].plugged || Fails(options_.plug_failure_rate)) {
+            ++plug_failures_;
+            return false;
+        }
+        pads_[idx] = {true, config, handler, context};
+        ++plugs_;
+        return true;
+    }
+
+    bool unplug(size_t idx) override
+    {
+        Spin(options_.unplug_latency);
+        std::lock_guard lock(mtx_);
+        if (idx >= pads_.size() || !pads_[idx].plugged) {
+            return false;
+        }
+        pads_[idx] = {};
+        ++unplugs_;
+        return true;
+    }
+
+    bool isPlugged(size_t idx) const override
+    {
+        std::lock_guard lock(mtx_);
+        return idx < pads_.size() && pads_[idx].plugged;
+    }
+
+    bool submit(size_t idx, const Ds4Translation::XusbReport& report) override
+    {
+        Spin(options_.submit_latency);
+        std::lock_guard lock(mtx_);
+        if (idx >= pads_.size() || !pads_[idx].plugged || Fails(options_.submit_failure_rate)) {
+            ++submit_failures_;
+            return false;
+        }
+        if (forced_submit_failures_ > 0 && forced_failure_delay_ == 0) {
+            --forced_submit_failures_;
+            ++submit_failures_;
+            return false;
+        }
+        if (forced_failure_delay_ > 0) {
+            --forced_failure_delay_;
+        }
+        record({options_.clock ? options_.clock->now() : std::chrono::steady_clock::now(), idx, pads_[idx].config.type, report});
+        return true;
+    }
+
+    // count submits fail after the next `after` successful ones, regardless of the configured failure rate
+    void failNextSubmits(size_t count, size_t after = 0)
+    {
+        std::lock_guard lock(mtx_);
+        forced_submit_failures_ = count;
+        forced_failure_delay_ = after;
+    }
+
+    // Acts as if the bus removed the pad on its own (driver reset, ...); submits to it fail until plugged again
+    bool removePad(size_t idx)
+    {
+        std::lock_guard lock(mtx_);
+        if (idx >= pads_.size() || !pads_[idx].plugged) {
+            return false;
+        }
+        pads_[idx] = {};
+        ++removals_;
+        return true;
+    }
+
+    // Acts as if the game sent rumble/lightbar to the pad; may be called from any thread
+    bool sendFeedback(size_t idx, const Feedback::State& state)
+    {
+        FeedbackHandler handler = nullptr;
+        void* context = nullptr;
+        {
+            std::lock_guard lock(mtx_);
+            if (idx >= pads_.size() || !pads_[idx].plugged || pads_[idx].handler == nullptr) {
+                return false;
+            }
+            handler = pads_[idx].handler;
+            context = pads_[idx].context;
+        }
+        handler(context, state);
+        return true;
+    }
+
+    // recorded submissions, oldest first
+    std::vector<Submission> submissions() const
+    {
+        std::lock_guard lock(mtx_);
+        if (submissions_.size() < options_.max_recorded_submissions) {
+            return submissions_;
+        }
+        std::vector<Submission> res;
+        res.reserve(submissions_.size());
+        res.insert(res.end(), submissions_.begin() + static_cast<std::ptrdiff_t>(next_submission_), submissions_.end());
+        res.insert(res.end(), submissions_.begin(), submissions_.begin() + static_cast<std::ptrdiff_t>(next_submission_));
+        return res;
+    }
+
+    void clearSubmissions()
+    {
+        std::lock_guard lock(mtx_);
+        submissions_.clear();
+        next_submission_ = 0;
+    }
+
+    struct Counters {
+        uint64_t plugs = 0;
+        uint64_t unplugs = 0;
+        uint64_t removals = 0;
+        uint64_t plug_failures = 0;
+        // including the ones no longer recorded
+        uint64_t submits = 0;
+        uint64_t submit_failures = 0;
+    };
+
+    Counters counters() const
+    {
+        std::lock_guard lock(mtx_);
+        return {plugs_, unplugs_, removals_, plug_failures_, submits_, submit_failures_};
+    }
+
+  private:
+    struct Pad {
+        bool plugged = false;
+        Config config;
+        FeedbackHandler handler = nullptr;
+        void* context = nullptr;
+    };
+
+    const Options options_;
+    mutable std::mutex mtx_;
+    std::mt19937 rng_;
+    std::vector<Pad> pads_;
+    std::vector<Submission> submissions_;
+    // oldest entry once submissions_ is full
+    size_t next_submission_ = 0;
+    size_t forced_submit_failures_ = 0;
+    size_t forced_failure_delay_ = 0;
+    uint64_t plugs_ = 0;
+    uint64_t unplugs_ = 0;
+    uint64_t removals_ = 0;
+    uint64_t plug_failures_ = 0;
+    uint64_t submits_ = 0;
+    uint64_t submit_failures_ = 0;
+
+    void record(const Submission& submission)
+    {
+        ++submits_;
+        if (options_.max_recorded_submissions == 0) {
+            return;
+        }
+        if (submissions_.size() < options_.max_recorded_submissions) {
+            submissions_.push_back(submission);
+            return;
+        }
+        submissions_[next_submission_] = submission;
+        next_submission_ = (next_submission_ + 1) % submissions_.size();
+    }
+
+    bool Fails(double rate)
+    {
+        return rate > 0.0 && std::bernoulli_distribution(rate)(rng_);
+    }
+
+    static void Spin(std::chrono::nanoseconds duration)
+    {
+        if (duration <= std::chrono::nanoseconds::zero()) {
+            return;
+        }
+        const auto until = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    }
+};
@@ -17,7 +17,12 @@ limitations under the License.
 
 #include "steam_sf_keymap.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <numeric>
 #include <utility>
+#include <vector>
 
 #include <SFML/Window/Event.hpp>
 #include <spdlog/spdlog.h>
@@ -26,9 +31,12 @@ limitations under the License.
 #include <SFML/Graphics.hpp>
 #include <VersionHelpers.h>
 #include <Windows.h>
+#include <CommCtrl.h>
 #include <dwmapi.h>
 
 #include "ProcessPriority.h"
+#include "Profiler.h"
+#include "StartupTimings.h"
 
 #include "..\common\Settings.h"
 
@@ -36,19 +44,25 @@ limitations under the License.
 #define WM_DPICHANGED 0x02E0
 #endif
 
+#pragma comment(lib, "Comctl32.lib")
+
 #endif
 
 TargetWindow::TargetWindow(
     std::function<void()> on_close,
     std::function<void()> toggle_overlay_state,
     std::vector<std::string> screenshot_hotkey,
-    std::function<void()> on_window_changed)
+    std::function<void()> on_window_changed,
+    std::function<std::vector<WindowHandle>()> game_windows)
     : on_close_(std::move(on_close)),
       toggle_overlay_state_(std::move(toggle_overlay_state)),
       screenshot_keys_(std::move(screenshot_hotkey)),
-      on_window_changed_(std::move(on_window_changed))
+      on_window_changed_(std::move(on_window_changed)),
+      game_windows_(std::move(game_windows))
 {
     createWindow();
+    // only the first one; the window gets recreated on window mode toggles
+    StartupTimings::Mark("Window");
 
     Overlay::AddOverlayElem([this](bool window_has_focus, ImGuiID dockspace_id) {
         ImGui::SetNextWindowDockID(dockspace_id, ImGuiCond_FirstUseEver);
@@ -66,6 +80,14 @@ TargetWindow::TargetWindow(
         int max_fps_copy = Settings::window.maxFps;
         ImGui::InputInt("##max_fps", &max_fps_copy, 20, 20);
         ImGui::Text("Values smaller than 15 set the limit to the screen refresh rate.");
+        ImGui::Text("Idle FPS");
+        ImGui::SameLine();
+        int idle_fps_copy = static_cast<int>(Settings::window.idleFps);
+        if (ImGui::InputInt("##idle_fps", &idle_fps_copy, 5, 10)) {
+            Settings::window.idleFps = static_cast<unsigned int>(std::clamp(idle_fps_copy, 0, 240));
+        }
+        ImGui::Text("Used while both overlays are closed; 0 = always use Max. FPS");
+        ImGui::Text("Monitor: %s (%dx%d at %d, %d)", monitor_.id.c_str(), monitor_.bounds.width(), monitor_.bounds.height(), monitor_.bounds.left, monitor_.bounds.top);
         if (max_fps_copy != Settings::window.maxFps) {
             Settings::window.maxFps = max_fps_copy; 
             if (Settings::window.maxFps > 240) {
@@ -93,12 +115,10 @@ TargetWindow::TargetWindow(
                 Settings::window.scale = 0.0f;
                 ImGuiIO& io = ImGui::GetIO();
                 io.FontGlobalScale = 1;
-                ImGui::SFML::UpdateFontTexture();
             } else {
                 spdlog::trace("Scaling overlay: {}", Settings::window.scale);
                 ImGuiIO& io = ImGui::GetIO();
                 io.FontGlobalScale = Settings::window.scale;
-                ImGui::SFML::UpdateFontTexture();   
             }
         }
 
@@ -111,11 +131,23 @@ TargetWindow::TargetWindow(
 void TargetWindow::setFpsLimit(unsigned int fps_limit)
 {
     spdlog::trace("Limiting FPS to {}", fps_limit);
-    window_.setFramerateLimit(fps_limit);
+    // Not using SFMLs limiter; frames are paced by SteamTarget (see FrameScheduler)
+    fps_limit_ = fps_limit;
+}
+
+unsigned int TargetWindow::getFpsLimit() const
+{
+    return fps_limit_;
+}
+
+TargetWindow::FrameCounters TargetWindow::getFrameCounters() const
+{
+    return {frames_rendered_.load(), frames_skipped_.load()};
 }
 
 void TargetWindow::setClickThrough(bool click_through)
 {
+    Overlay::MarkDirty();
     if (Settings::window.windowMode) {
         return;
     }
@@ -151,6 +183,7 @@ void TargetWindow::setClickThrough(bool click_through)
 
 void TargetWindow::setTransparent(bool transparent) const
 {
+    Overlay::MarkDirty();
     HWND hwnd = window_.getSystemHandle();
 
     if (transparent) {
@@ -186,6 +219,7 @@ void TargetWindow::setTransparent(bool transparent) const
 
 void TargetWindow::update()
 {
+    PROFILE_ZONE("TargetWindow::update");
     sf::Event event{};
     while (window_.pollEvent(event)) {
         Overlay::ProcessEvent(event);
@@ -194,11 +228,20 @@ void TargetWindow::update()
             return;
         }
     }
-    // windows clear always handled in overlay. => non fully transparent
-    window_.clear(sf::Color(0, 0, 0, 0));
-    screenShotWorkaround();
-    overlay_->update();
-    window_.display();
+    // Identical frames aren't drawn nor presented at all; the window simply keeps showing the last one.
+    if (screenShotWorkaround() || overlay_->needsRender()) {
+        // windows clear always handled in overlay. => non fully transparent
+        window_.clear(sf::Color(0, 0, 0, 0));
+        overlay_->update();
+        {
+            PROFILE_ZONE("Present");
+            window_.display();
+        }
+        ++frames_rendered_;
+    }
+    else {
+        ++frames_skipped_;
+    }
 #ifdef _WIN32
     if (toggle_hidealttab_after_frame_) {
         toggle_hidealttab_after_frame_ = false;
@@ -208,16 +251,12 @@ void TargetWindow::update()
         createWindow();
     }
 
-    // As SFML screws us out of most windows-events, just poll resolution every once in a while
-    // If changed, recreate window.
-    // Fixes Blackscreen issues when user does funky stuff and still uses GlosSI in non windowed mod...
-    // (WHY?!)
-    if (check_resolution_clock_.getElapsedTime().asSeconds() > RES_CHECK_SECONDS) {
-        if (sf::VideoMode::getDesktopMode().width != old_desktop_mode_.width) {
-            createWindow();
-        }
-        check_resolution_clock_.restart();
+    checkDisplays();
+#ifdef GLOSSI_WINDOW_MOVE_BENCH
+    if (!monitor_switch_benchmarked_ && frames_rendered_ > 0) {
+        benchmarkMonitorSwitch();
     }
+#endif
 }
 
 void TargetWindow::close()
@@ -232,77 +271,59 @@ std::shared_ptr<Overlay> TargetWindow::getOverlay() const
     return overlay_;
 }
 
-void TargetWindow::screenShotWorkaround()
+bool TargetWindow::screenShotWorkaround()
 {
 #ifdef _WIN32
-    if (std::ranges::all_of(screenshot_keys_,
-                            [](const auto& key) {
-                                return sf::Keyboard::isKeyPressed(keymap::sfkey[key]);
-                            })) {
-        spdlog::debug("Detected screenshot hotkey(s); Taking screenshot");
-
-        // stolen from: https://en.sfml-dev.org/forums/index.php?topic=14323.15
-        // no time to do this shit.
-        HDC hScreenDC = GetDC(nullptr);
-        HDC hMemoryDC = CreateCompatibleDC(hScreenDC);
-        int width = GetDeviceCaps(hScreenDC, HORZRES);
-        int height = GetDeviceCaps(hScreenDC, VERTRES);
-        HBITMAP hBitmap = CreateCompatibleBitmap(hScreenDC, width, height);
-        auto hOldBitmap = static_cast<HBITMAP>(SelectObject(hMemoryDC, hBitmap));
-        BitBlt(hMemoryDC, 0, 0, width, height, hScreenDC, 0, 0, SRCCOPY);
-        hBitmap = static_cast<HBITMAP>(SelectObject(hMemoryDC, hOldBitmap));
-        BITMAP bm;
-        GetObject(hBitmap, sizeof(bm), &bm);
-        BITMAPINFO bmpInfo;
-        bmpInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-        bmpInfo.bmiHeader.biWidth = bm.bmWidth;
-        bmpInfo.bmiHeader.biHeight = -bm.bmHeight;
-        bmpInfo.bmiHeader.biPlanes = 1;
-        bmpInfo.bmiHeader.biBitCount = 32;
-        bmpInfo.bmiHeader.biCompression = BI_RGB;
-        bmpInfo.bmiHeader.biSizeImage = 0;
-        bmpInfo.bmiHeader.biClrImportant = 0;
-        std::vector<COLORREF> pixel;
-        pixel.resize(bm.bmWidth * bm.bmHeight);
-        sf::Image captureImage;
-        captureImage.create(bm.bmWidth, bm.bmHeight, sf::Color::Black);
-        GetDIBits(hMemoryDC, hBitmap, 0, bm.bmHeight, pixel.data(), &bmpInfo, DIB_RGB_COLORS);
-        unsigned int j = 0;
-        for (unsigned int y = 0; y < bm.bmHeight; ++y) {
-            for (unsigned int x = 0; x < bm.bmWidth; ++x) {
-                const COLORREF this_color = pixel[j++];
-                captureImage.setPixel(x, y, sf::Color(GetBValue(this_color), GetGValue(this_color), GetRValue(this_color)));
-            }
+    switch (screen_capture_.state()) {
+    case ScreenCapture::State::Idle:
+        if (std::ranges::all_of(screenshot_keys_,
+                                [](const auto& key) {
+                                    return sf::Keyboard::isKeyPressed(keymap::sfkey[key]);
+                                })) {
+            spdlog::debug("Detected screenshot hotkey(s); Taking screenshot");
+            // grabbing (and converting) a 4K desktop takes a while; keep rendering meanwhile
+            screen_capture_.start(monitor_.bounds);
         }
-        ReleaseDC(NULL, hScreenDC);
-        DeleteObject(hBitmap);
-        DeleteDC(hMemoryDC);
-        DeleteDC(hScreenDC);
-
-        sf::Sprite sprite;
-        sf::Texture texture;
-        texture.loadFromImage(captureImage);
-        sprite.setTexture(texture);
-
-        spdlog::debug("Sending screenshot key events and rendering screen...");
-        std::ranges::for_each(screenshot_keys_, [this](const auto& key) {
-            PostMessage(window_.getSystemHandle(), WM_KEYDOWN, keymap::winkey[key], 0);
-        });
-        std::ranges::for_each(screenshot_keys_, [this](const auto& key) {
-            PostMessage(window_.getSystemHandle(), WM_KEYUP, keymap::winkey[key], 0);
-        });
-        //actually run event loop, so steam gets notified about keys.
-        sf::Event event{};
-        while (window_.pollEvent(event)) {
+        return false;
+    case ScreenCapture::State::Capturing:
+        return false;
+    case ScreenCapture::State::Failed:
+        screen_capture_.reset();
+        return false;
+    case ScreenCapture::State::Done:
+        break;
+    }
+
+    {
+        PROFILE_ZONE("Upload screenshot");
+        if (screenshot_texture_.getSize() != sf::Vector2u{screen_capture_.width(), screen_capture_.height()}) {
+            screenshot_texture_.create(screen_capture_.width(), screen_capture_.height());
         }
-        // steam takes screenshot on next frame, so render our screenshot and dipslay...
-        window_.clear(sf::Color::Black);
-        window_.draw(sprite);
-        window_.display();
-        // finally, draw another transparent frame.
-        window_.clear(sf::Color::Transparent);
+        screenshot_texture_.update(screen_capture_.pixels());
+    }
+    screen_capture_.reset();
+    const sf::Sprite sprite(screenshot_texture_);
+
+    spdlog::debug("Sending screenshot key events and rendering screen...");
+    std::ranges::for_each(screenshot_keys_, [this](const auto& key) {
+        PostMessage(window_.getSystemHandle(), WM_KEYDOWN, keymap::winkey[key], 0);
+    });
+    std::ranges::for_each(screenshot_keys_, [this](const auto& key) {
+        PostMessage(window_.getSystemHandle(), WM_KEYUP, keymap::winkey[key], 0);
+    });
+    //actually run event loop, so steam gets notified about keys.
+    sf::Event event{};
+    while (window_.pollEvent(event)) {
     }
+    // steam takes screenshot on next frame, so render our screenshot and dipslay...
+    window_.clear(sf::Color::Black);
+    window_.draw(sprite);
+    window_.display();
+    // finally, draw another transparent frame.
+    window_.clear(sf::Color::Transparent);
+    return true;
 #endif
+    return false;
 }
 
 WindowHandle TargetWindow::getSystemHandle() const
@@ -354,16 +375,181 @@ unsigned int TargetWindow::calcAutoRefreshRate(unsigned int rate)
     return auto_refresh_rate;
 }
 
+DisplayTopology::Topology TargetWindow::queryTopology() const
+{
+#ifdef _WIN32
+    auto topology = DisplayTopology::Enumerate();
+    if (!topology.monitors.empty()) {
+        return topology;
+    }
+#endif
+    const auto desktop_mode = sf::VideoMode::getDesktopMode();
+    DisplayTopology::Monitor monitor;
+    monitor.id = "primary";
+    monitor.bounds = {0, 0, static_cast<int>(desktop_mode.width), static_cast<int>(desktop_mode.height)};
+    monitor.work_area = monitor.bounds;
+    monitor.primary = true;
+    return {{monitor}};
+}
+
+DisplayTopology::Monitor TargetWindow::pickMonitor(const DisplayTopology::Topology& topology) const
+{
+    const DisplayTopology::Monitor* res = nullptr;
+#ifdef _WIN32
+    if (const auto game_rect = DisplayTopology::GameWindowRect(game_windows_()); !game_rect.empty()) {
+        res = topology.monitorFor(game_rect);
+    }
+#endif
+    // no (visible) game window; stay where we are
+    if (!res) {
+        res = topology.find(monitor_.id);
+    }
+    if (!res) {
+        res = topology.primary();
+    }
+    return res ? *res : DisplayTopology::Monitor{};
+}
+
+void TargetWindow::checkDisplays()
+{
+#ifndef _WIN32
+    // no display change notifications; poll
+    display_changed_ = check_monitor_clock_.getElapsedTime().asSeconds() > MONITOR_CHECK_SECONDS;
+#endif
+    if (!display_changed_ && check_monitor_clock_.getElapsedTime().asSeconds() <= MONITOR_CHECK_SECONDS) {
+        return;
+    }
+    PROFILE_ZONE("TargetWindow::checkDisplays");
+    check_monitor_clock_.restart();
+    if (display_changed_) {
+        display_changed_ = false;
+        auto topology = queryTopology();
+        const auto diff = DisplayTopology::Compare(topology_, topology);
+        if (!diff.empty()) {
+            spdlog::info("Displays changed; added: {}, removed: {}, changed: {}", diff.added.size(), diff.removed.size(), diff.changed.size());
+        }
+        topology_ = std::move(topology);
+    }
+    const auto monitor = pickMonitor(topology_);
+    if (!(monitor == monitor_)) {
+        moveToMonitor(monitor);
+    }
+}
+
+void TargetWindow::moveToMonitor(const DisplayTopology::Monitor& monitor)
+{
+    PROFILE_ZONE("TargetWindow::moveToMonitor");
+    const auto start = std::chrono::steady_clock::now();
+    Overlay::MarkDirty();
+    monitor_ = monitor;
+    const auto width = static_cast<unsigned int>(monitor_.bounds.width());
+    const auto height = static_cast<unsigned int>(monitor_.bounds.height());
+    // window mode: the user placed the window; leave it alone
+    if (!Settings::window.windowMode) {
+        window_.setPosition({monitor_.bounds.left, monitor_.bounds.top});
+        window_.setSize(sf::Vector2u(width - 1, height - 1));
+        window_.setView(sf::View(sf::FloatRect(0.f, 0.f, width - 1.f, height - 1.f)));
+    }
+#ifdef _WIN32
+    if (monitor_.refresh_rate != 0) {
+        screen_refresh_rate_ = monitor_.refresh_rate;
+    }
+    if (Settings::window.disableOverlay) {
+        setFpsLimit(1);
+    }
+    else if (Settings::window.maxFps <= 0) {
+        setFpsLimit(TargetWindow::calcAutoRefreshRate(screen_refresh_rate_));
+    }
+    if (Settings::window.scale <= 0.3f) {
+        const auto dpi = GetWindowDPI(window_.getSystemHandle());
+        ImGui::GetIO().FontGlobalScale = dpi / 96.f;
+    }
+#endif
+    spdlog::info("Moved window to monitor {} ({}x{} at {}, {}) in {:.2f}ms",
+                 monitor_.id, width, height, monitor_.bounds.left, monitor_.bounds.top,
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+
+#ifdef GLOSSI_WINDOW_MOVE_BENCH
+void TargetWindow::benchmarkMonitorSwitch()
+{
+    monitor_switch_benchmarked_ = true;
+    if (topology_.monitors.size() < 2) {
+        spdlog::warn("Monitor switch benchmark needs at least two monitors");
+        return;
+    }
+#ifdef _WIN32
+    if (!DisplayTopology::GameWindowRect(game_windows_()).empty()) {
+        // createWindow would just follow the game
+        spdlog::warn("Monitor switch benchmark needs the game window to be hidden");
+        return;
+    }
+#endif
+    constexpr int RUNS = 10;
+    // createWindow re-queries the topology; keep copies
+    const auto home = monitor_;
+    const auto first = topology_.monitors[0];
+    const auto second = topology_.monitors[1];
+    const auto time = [](auto&& fn) {
+        std::vector<double> ms;
+        for (int i = 0; i < RUNS; i++) {
+            const auto start = std::chrono::steady_clock::now();
+            fn(i);
+            ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        const auto [min, max] = std::ranges::minmax_element(ms);
+        return std::array{*min, std::accumulate(ms.begin(), ms.end(), 0.0) / RUNS, *max};
+    };
+    // every run lands on the other monitor
+    moveToMonitor(first);
+    const auto move = time([&](int i) { moveToMonitor(i % 2 == 0 ? second : first); });
+    moveToMonitor(first);
+    const auto recreate = time([&](int i) {
+        // pickMonitor stays on monitor_ without a game window
+        monitor_ = i % 2 == 0 ? second : first;
+        createWindow();
+    });
+    moveToMonitor(home);
+    spdlog::info("Monitor switch, {} runs (min/avg/max): move {:.2f}/{:.2f}/{:.2f}ms; recreate {:.2f}/{:.2f}/{:.2f}ms",
+                 RUNS, move[0], move[1], move[2], recreate[0], recreate[1], recreate[2]);
+}
+#endif
+
+#ifdef _WIN32
+LRESULT CALLBACK TargetWindow::DisplaySubclassProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam, UINT_PTR id, DWORD_PTR ref_data)
+{
+    switch (msg) {
+    case WM_DISPLAYCHANGE:
+    case WM_DPICHANGED:
+        spdlog::debug("Display change notification ({:#x})", msg);
+        reinterpret_cast<TargetWindow*>(ref_data)->display_changed_ = true;
+        Overlay::MarkDirty();
+        break;
+    case WM_NCDESTROY:
+        RemoveWindowSubclass(hwnd, &TargetWindow::DisplaySubclassProc, id);
+        break;
+    default:
+        break;
+    }
+    return DefSubclassProc(hwnd, msg, wparam, lparam);
+}
+#endif
+
 void TargetWindow::createWindow()
 {
+    PROFILE_ZONE("TargetWindow::createWindow");
+    const auto start = std::chrono::steady_clock::now();
     toggle_window_mode_after_frame_ = false;
+    Overlay::MarkDirty();
 
-    auto desktop_mode = sf::VideoMode::getDesktopMode();
-    spdlog::info("Detected resolution: {}x{}", desktop_mode.width, desktop_mode.height);
-    old_desktop_mode_ = desktop_mode;
+    topology_ = queryTopology();
+    monitor_ = pickMonitor(topology_);
+    const auto width = static_cast<unsigned int>(monitor_.bounds.width());
+    const auto height = static_cast<unsigned int>(monitor_.bounds.height());
+    spdlog::info("Detected resolution: {}x{} on monitor {}", width, height, monitor_.id);
     if (Settings::window.windowMode) {
         spdlog::info("Creating Overlay window...");
-        window_.create(sf::VideoMode(desktop_mode.width * 0.75, desktop_mode.height * 0.75, 32), "GlosSITarget");
+        window_.create(sf::VideoMode(width * 0.75, height * 0.75, 32), "GlosSITarget");
     }
     else {
 #ifdef _WIN32
@@ -373,17 +559,15 @@ void TargetWindow::createWindow()
         // Due to some other issue, the (Steam) overlay might get blurred when doing this
         // as a workaround, start in full size, and scale down later...
         spdlog::info("Creating Overlay window (Borderless Fullscreen)...");
-        window_.create(sf::VideoMode(desktop_mode.width, desktop_mode.height, 32), "GlosSITarget", sf::Style::None);
+        window_.create(sf::VideoMode(width, height, 32), "GlosSITarget", sf::Style::None);
+        window_.setPosition({monitor_.bounds.left, monitor_.bounds.top});
 
-        // get size of all monitors combined
-        const auto screenWidth = GetSystemMetrics(SM_CXVIRTUALSCREEN);
-        const auto screenHeight = GetSystemMetrics(SM_CYVIRTUALSCREEN);
-        spdlog::debug("Full screen size: {}x{}", screenWidth, screenHeight);
-
-        spdlog::debug("Primary monitor size: {}x{}", desktop_mode.width, desktop_mode.height);
+        const auto virtual_screen = topology_.virtualScreen();
+        spdlog::debug("Full screen size: {}x{}; {} monitor(s)", virtual_screen.width(), virtual_screen.height(), topology_.monitors.size());
+        spdlog::debug("Target monitor: {}x{} at {}, {}", width, height, monitor_.bounds.left, monitor_.bounds.top);
 
 #else
-        window_.create(desktop_mode, "GlosSITarget", sf::Style::None);
+        window_.create(sf::VideoMode(width, height, 32), "GlosSITarget", sf::Style::None);
 #endif
     }
     window_.setActive(true);
@@ -391,28 +575,28 @@ void TargetWindow::createWindow()
 
     if (!Settings::window.windowMode) {
         spdlog::info("Resizing window to 1px smaller than fullscreen...");
-        window_.setSize(sf::Vector2u(desktop_mode.width - 1, desktop_mode.height - 1));
+        window_.setSize(sf::Vector2u(width - 1, height - 1));
     }
 
 #ifdef _WIN32
     HWND hwnd = window_.getSystemHandle();
+    // SFML doesn't forward display changes
+    SetWindowSubclass(hwnd, &TargetWindow::DisplaySubclassProc, 0, reinterpret_cast<DWORD_PTR>(this));
+    display_changed_ = false;
+    check_monitor_clock_.restart();
     auto dpi = GetWindowDPI(hwnd);
     spdlog::debug("Screen DPI: {}", dpi);
 
     setTransparent(true);
 
-    DEVMODE dev_mode = {};
-    dev_mode.dmSize = sizeof(DEVMODE);
-    dev_mode.dmDriverExtra = 0;
-
-    if (EnumDisplaySettings(nullptr, ENUM_CURRENT_SETTINGS, &dev_mode) == 0) {
+    if (monitor_.refresh_rate == 0) {
         setFpsLimit(60);
         spdlog::warn("Couldn't detect screen refresh rate; Limiting overlay to 60");
         screen_refresh_rate_ = 60;
     }
     else {
-        setFpsLimit(TargetWindow::calcAutoRefreshRate(dev_mode.dmDisplayFrequency));
-        screen_refresh_rate_ = dev_mode.dmDisplayFrequency;
+        setFpsLimit(TargetWindow::calcAutoRefreshRate(monitor_.refresh_rate));
+        screen_refresh_rate_ = monitor_.refresh_rate;
     }
 
     overlay_ = std::make_shared<Overlay>(
@@ -421,7 +605,6 @@ void TargetWindow::createWindow()
     spdlog::debug("auto screen Scale: {}", dpi/96.f);
     ImGuiIO& io = ImGui::GetIO();
     io.FontGlobalScale = dpi / 96.f;
-    ImGui::SFML::UpdateFontTexture();
 
 #else
     setFpsLimit(60);
@@ -435,13 +618,12 @@ void TargetWindow::createWindow()
         spdlog::debug("setting screen scale by config: {}", Settings::window.scale);
         ImGuiIO& io = ImGui::GetIO();
         io.FontGlobalScale = Settings::window.scale;
-        ImGui::SFML::UpdateFontTexture();
     }
     else {
         spdlog::debug("Not applying too low screen scale setting");
     }
 
-    // window_.setSize({desktop_mode.width - 1, desktop_mode.height - 1 });
+    // window_.setSize({width - 1, height - 1 });
 
     on_window_changed_();
 
@@ -451,4 +633,5 @@ void TargetWindow::createWindow()
         ShowWindow(hwnd, SW_HIDE);
     }
 #endif
+    spdlog::debug("Window created in {:.2f}ms", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
 }
@@ -14,11 +14,15 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #pragma once
+#include "DisplayTopology.h"
 #include "Overlay.h"
+#include "ScreenCapture.h"
 
+#include <atomic>
 #include <functional>
 
 #include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/Texture.hpp>
 
 // Redfine window handle, should impl. change
 #ifdef _WIN32
@@ -34,10 +38,20 @@ class TargetWindow {
         std::function<void()> on_close = []() {},
         std::function<void()> toggle_overlay_state = []() {},
         std::vector<std::string> screenshot_hotkey = {"KEY_F12"},
-        std::function<void()> on_window_changed = []() {}
+        std::function<void()> on_window_changed = []() {},
+        // windows of the launched game; the overlay follows them to their monitor
+        std::function<std::vector<WindowHandle>()> game_windows = []() { return std::vector<WindowHandle>{}; }
     );
 
     void setFpsLimit(unsigned int fps_limit);
+    unsigned int getFpsLimit() const;
+
+    struct FrameCounters {
+        uint64_t rendered = 0;
+        // nothing changed; not drawn/presented
+        uint64_t skipped = 0;
+    };
+    FrameCounters getFrameCounters() const;
     void setClickThrough(bool click_through);
     void setTransparent(bool transparent) const;
     void update();
@@ -48,15 +62,16 @@ class TargetWindow {
     /*
      * Run once per frame
      * - detects steam configured screenshot hotkey
-     * - takes actual screenshot
+     * - takes actual screenshot (in the background, checked on the following frames)
      * - renders it to window
      * - simulates screenshot keys
      * - Wait a few millis...
      * (- steam takes screenshot)
      * - return to normal
-     * 
+     *
+     * returns true if it drew to the window
      */
-    void screenShotWorkaround();
+    bool screenShotWorkaround();
 
     WindowHandle getSystemHandle() const;
 
@@ -69,13 +84,40 @@ class TargetWindow {
     const std::function<void()> toggle_overlay_state_;
     sf::RenderWindow window_;
     std::vector<std::string> screenshot_keys_;
+    ScreenCapture screen_capture_;
+    // reused between screenshots; only recreated if the resolution changed
+    sf::Texture screenshot_texture_;
     const std::function<void()> on_window_changed_;
-
-    sf::VideoMode old_desktop_mode_;
-    sf::Clock check_resolution_clock_;
-    static constexpr int RES_CHECK_SECONDS = 1;
+    const std::function<std::vector<WindowHandle>()> game_windows_;
+
+    // monitor the window (and screenshots) are placed on
+    DisplayTopology::Topology topology_;
+    DisplayTopology::Monitor monitor_;
+    DisplayTopology::Topology queryTopology() const;
+    DisplayTopology::Monitor pickMonitor(const DisplayTopology::Topology& topology) const;
+    void checkDisplays();
+    // Resizes/moves the existing window; keeps GL context, ImGui state and fonts (unlike createWindow)
+    void moveToMonitor(const DisplayTopology::Monitor& monitor);
+    // set on WM_DISPLAYCHANGE/WM_DPICHANGED; topology is only re-queried then
+    bool display_changed_ = false;
+
+#ifdef GLOSSI_WINDOW_MOVE_BENCH
+    // Dev builds only: once after the first frame, switches between the first two monitors
+    // with moveToMonitor and with createWindow and logs both timings
+    bool monitor_switch_benchmarked_ = false;
+    void benchmarkMonitorSwitch();
+#endif
+    // the game moving between monitors doesn't send anything, so that's still polled (cheap)
+    sf::Clock check_monitor_clock_;
+    static constexpr int MONITOR_CHECK_SECONDS = 1;
+#ifdef _WIN32
+    static LRESULT CALLBACK DisplaySubclassProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam, UINT_PTR id, DWORD_PTR ref_data);
+#endif
 
     unsigned int screen_refresh_rate_ = 0;
+    unsigned int fps_limit_ = 60;
+    std::atomic<uint64_t> frames_rendered_ = 0;
+    std::atomic<uint64_t> frames_skipped_ = 0;
 
 
     std::shared_ptr<Overlay> overlay_;
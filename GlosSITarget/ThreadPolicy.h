@@ -0,0 +1,253 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <avrt.h>
+
+#pragma comment(lib, "Avrt.lib")
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/*
+ * Per-thread scheduling policy
+ *
+ * Unlike ProcessPriority, which bumps the whole process (and with it the render loop),
+ * this only touches the calling thread.
+ * All functions act on the *calling* thread, so schedulers must be created, applied and reverted
+ * on the thread they are meant for.
+ */
+namespace ThreadPolicy {
+
+enum class Task {
+    None,
+    Games,
+    ProAudio,
+};
+
+struct Policy {
+    Task task = Task::None;
+    // bit n = logical core n; 0 = don't restrict
+    uint64_t affinity_mask = 0;
+};
+
+inline const char* TaskName(Task task)
+{
+    switch (task) {
+    case Task::Games:
+        return "Games";
+    case Task::ProAudio:
+        return "Pro Audio";
+    default:
+        return "None";
+    }
+}
+
+inline Task TaskFromName(const std::string& name)
+{
+    if (name == TaskName(Task::Games)) {
+        return Task::Games;
+    }
+    if (name == TaskName(Task::ProAudio)) {
+        return Task::ProAudio;
+    }
+    return Task::None;
+}
+
+inline unsigned int CoreCount()
+{
+    return std::clamp(std::thread::hardware_concurrency(), 1u, 64u);
+}
+
+class Scheduler {
+  public:
+    virtual ~Scheduler() = default;
+
+    // Applies policy to the calling thread, replacing whatever was applied before.
+    // Returns false if (parts of) the policy could not be applied
+    virtual bool apply(const Policy& policy) = 0;
+
+    // Restores default scheduling of the calling thread
+    virtual void revert() = 0;
+};
+
+#ifdef _WIN32
+/*
+ * Registers the thread with the Multimedia Class Scheduler Service
+ * MMCSS boosts registered threads for their time slice without needing REALTIME process priority,
+ * and keeps them from being starved when the game saturates all cores.
+ */
+class MmcssScheduler : public Scheduler {
+  public:
+    ~MmcssScheduler() override
+    {
+        revertTask();
+    }
+
+    bool apply(const Policy& policy) override
+    {
+        bool ok = true;
+        revertTask();
+        if (policy.task != Task::None) {
+            DWORD task_index = 0;
+            const auto name = policy.task == Task::ProAudio ? L"Pro Audio" : L"Games";
+            mmcss_handle_ = AvSetMmThreadCharacteristicsW(name, &task_index);
+            if (mmcss_handle_ == nullptr) {
+                spdlog::warn("Couldn't register thread with MMCSS task \"{}\"; error: {}", TaskName(policy.task), GetLastError());
+                ok = false;
+            }
+            else {
+                spdlog::debug("Registered thread with MMCSS task \"{}\"", TaskName(policy.task));
+            }
+        }
+        ok &= setAffinity(policy.affinity_mask);
+        return ok;
+    }
+
+    void revert() override
+    {
+        revertTask();
+        setAffinity(0);
+    }
+
+  private:
+    HANDLE mmcss_handle_ = nullptr;
+
+    void revertTask()
+    {
+        if (mmcss_handle_ != nullptr) {
+            AvRevertMmThreadCharacteristics(mmcss_handle_);
+            mmcss_handle_ = nullptr;
+        }
+    }
+
+    static bool setAffinity(uint64_t mask)
+    {
+        DWORD_PTR process_mask = 0;
+        DWORD_PTR system_mask = 0;
+        if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+            return false;
+        }
+        DWORD_PTR thread_mask = mask == 0 ? process_mask : static_cast<DWORD_PTR>(mask) & process_mask;
+        if (thread_mask == 0) {
+            spdlog::warn("Thread affinity mask {:#x} doesn't contain any usable core; ignoring", mask);
+            thread_mask = process_mask;
+        }
+        if (SetThreadAffinityMask(GetCurrentThread(), thread_mask) == 0) {
+            spdlog::warn("Couldn't set thread affinity to {:#x}; error: {}", thread_mask, GetLastError());
+            return false;
+        }
+        return true;
+    }
+};
+#else
+/*
+ * pthread based implementation
+ * MMCSS tasks are mapped to SCHED_RR ("Games") and SCHED_FIFO ("Pro Audio")
+ * Needs CAP_SYS_NICE / rtprio limits, otherwise only affinity is applied.
+ * revert() restores the affinity the thread had before the first apply().
+ */
+class PthreadScheduler : public Scheduler {
+  public:
+    bool apply(const Policy& policy) override
+    {
+        bool ok = true;
+        sched_param param{};
+        int sched_policy = SCHED_OTHER;
+        if (policy.task != Task::None) {
+            sched_policy = policy.task == Task::ProAudio ? SCHED_FIFO : SCHED_RR;
+            const int min = sched_get_priority_min(sched_policy);
+            const int max = sched_get_priority_max(sched_policy);
+            param.sched_priority = policy.task == Task::ProAudio ? min + (max - min) / 2 : min + (max - min) / 4;
+        }
+        if (const auto res = pthread_setschedparam(pthread_self(), sched_policy, &param); res != 0) {
+            spdlog::warn("Couldn't set thread scheduling to \"{}\"; error: {}", TaskName(policy.task), res);
+            ok = false;
+        }
+        ok &= setAffinity(policy.affinity_mask);
+        return ok;
+    }
+
+    void revert() override
+    {
+        sched_param param{};
+        pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+        setAffinity(0);
+    }
+
+  private:
+    // affinity the thread had before the first apply(); the equivalent of the process mask on Windows
+    std::optional<cpu_set_t> original_affinity_;
+
+    bool setAffinity(uint64_t mask)
+    {
+        if (!original_affinity_) {
+            cpu_set_t original;
+            if (const auto res = pthread_getaffinity_np(pthread_self(), sizeof(original), &original); res != 0) {
+                spdlog::warn("Couldn't query thread affinity; error: {}", res);
+                return false;
+            }
+            original_affinity_ = original;
+        }
+        cpu_set_t set = *original_affinity_;
+        if (mask != 0) {
+            cpu_set_t requested;
+            CPU_ZERO(&requested);
+            for (unsigned int i = 0; i < 64 && i < CPU_SETSIZE; i++) {
+                if (mask & (uint64_t{1} << i)) {
+                    CPU_SET(i, &requested);
+                }
+            }
+            CPU_AND(&requested, &requested, &*original_affinity_);
+            if (CPU_COUNT(&requested) == 0) {
+                spdlog::warn("Thread affinity mask {:#x} doesn't contain any usable core; ignoring", mask);
+            }
+            else {
+                set = requested;
+            }
+        }
+        if (const auto res = pthread_setaffinity_np(pthread_self(), sizeof(set), &set); res != 0) {
+            spdlog::warn("Couldn't set thread affinity to {:#x}; error: {}", mask, res);
+            return false;
+        }
+        return true;
+    }
+};
+#endif
+
+inline std::unique_ptr<Scheduler> Create()
+{
+#ifdef _WIN32
+    return std::make_unique<MmcssScheduler>();
+#else
+    return std::make_unique<PthreadScheduler>();
+#endif
+}
+
+} // namespace ThreadPolicy
@@ -0,0 +1,176 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <timeapi.h>
+
+#pragma comment(lib, "Winmm.lib")
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+/*
+ * Time source + sleep primitive used by the schedulers (input pump, frame pacing)
+ *
+ * Schedulers only ever talk to this interface, so their logic can be driven by
+ * a virtual clock instead of real time.
+ */
+class TickClock {
+  public:
+    using clock = std::chrono::steady_clock;
+    using time_point = clock::time_point;
+    using duration = clock::duration;
+
+    virtual ~TickClock() = default;
+
+    virtual time_point now() const = 0;
+
+    // Blocks until `deadline` has passed or wake() got called.
+    virtual void sleepUntil(time_point deadline) = 0;
+
+    // Interrupts a pending (or the next) sleepUntil; safe to call from any thread.
+    virtual void wake() = 0;
+
+    // Timeout for OS waits with millisecond resolution.
+    // Rounded up; truncating would turn every wait below 1ms into a busy spin.
+    static std::chrono::milliseconds CoarseTimeout(duration remaining)
+    {
+        return std::max(std::chrono::ceil<std::chrono::milliseconds>(remaining), std::chrono::milliseconds::zero());
+    }
+};
+
+/*
+ * Portable implementation on top of std::condition_variable
+ *
+ * Precision depends on the OS timer resolution (~15.6ms on Windows unless raised!)
+ */
+class SteadyTickClock : public TickClock {
+  public:
+    time_point now() const override
+    {
+        return clock::now();
+    }
+
+    void sleepUntil(time_point deadline) override
+    {
+        std::unique_lock lock(mtx_);
+        cv_.wait_until(lock, deadline, [this] { return woken_; });
+        woken_ = false;
+    }
+
+    void wake() override
+    {
+        {
+            std::lock_guard lock(mtx_);
+            woken_ = true;
+        }
+        cv_.notify_one();
+    }
+
+  private:
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    bool woken_ = false;
+};
+
+#ifdef _WIN32
+/*
+ * High resolution waitable timer (Win10 1803+)
+ *
+ * Falls back to a regular waitable timer with the system timer resolution raised to 1ms
+ * on older systems, as plain Sleep() would cap us to ~64Hz.
+ */
+class WaitableTimerTickClock : public TickClock {
+  public:
+    WaitableTimerTickClock()
+    {
+        timer_ = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        high_resolution_ = timer_ != nullptr;
+        if (timer_ == nullptr) {
+            timer_ = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+            raised_timer_resolution_ = timeBeginPeriod(1) == TIMERR_NOERROR;
+        }
+        wake_event_ = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    }
+
+    ~WaitableTimerTickClock() override
+    {
+        if (raised_timer_resolution_) {
+            timeEndPeriod(1);
+        }
+        CloseHandle(timer_);
+        CloseHandle(wake_event_);
+    }
+
+    WaitableTimerTickClock(const WaitableTimerTickClock&) = delete;
+    WaitableTimerTickClock& operator=(const WaitableTimerTickClock&) = delete;
+
+    time_point now() const override
+    {
+        return clock::now();
+    }
+
+    void sleepUntil(time_point deadline) override
+    {
+        const auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now());
+        if (remaining.count() <= 0) {
+            return;
+        }
+        // negative = relative due time, in 100ns intervals (rounded up)
+        LARGE_INTEGER due_time;
+        due_time.QuadPart = -static_cast<LONGLONG>((remaining.count() + 99) / 100);
+        if (timer_ == nullptr || !SetWaitableTimer(timer_, &due_time, 0, nullptr, nullptr, FALSE)) {
+            WaitForSingleObject(wake_event_, static_cast<DWORD>(CoarseTimeout(remaining).count()));
+            return;
+        }
+        const HANDLE handles[] = {timer_, wake_event_};
+        WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+    }
+
+    void wake() override
+    {
+        SetEvent(wake_event_);
+    }
+
+    // sub-millisecond wakeups
+    bool isHighResolution() const
+    {
+        return high_resolution_;
+    }
+
+    // fallback timer, but ~1ms wakeups thanks to timeBeginPeriod; neither -> system default (~15.6ms)
+    bool raisedTimerResolution() const
+    {
+        return raised_timer_resolution_;
+    }
+
+  private:
+    HANDLE timer_ = nullptr;
+    HANDLE wake_event_ = nullptr;
+    bool high_resolution_ = false;
+    bool raised_timer_resolution_ = false;
+};
+#endif
@@ -0,0 +1,180 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "ViGEmPadSink.h"
+
+#include <cstring>
+
+#include <spdlog/spdlog.h>
+
+static_assert(sizeof(Ds4Translation::XusbReport) == sizeof(XUSB_REPORT));
+static_assert(sizeof(Ds4Translation::Ds4Report) == sizeof(DS4_REPORT));
+static_assert(offsetof(Ds4Translation::Ds4Report, bTriggerR) == offsetof(DS4_REPORT, bTriggerR));
+
+ViGEmPadSink::ViGEmPadSink()
+{
+    driver_ = vigem_alloc();
+    connected_ = VIGEM_SUCCESS(vigem_connect(driver_));
+    if (connected_) {
+        spdlog::debug("Connected to ViGEm");
+    }
+    else {
+        spdlog::error("Error initializing ViGEm");
+    }
+}
+
+ViGEmPadSink::~ViGEmPadSink()
+{
+    if (connected_) {
+        for (const auto& target : targets_) {
+            if (target && target->target != nullptr) {
+                vigem_target_remove(driver_, target->target);
+                vigem_target_free(target->target);
+            }
+        }
+    }
+    vigem_disconnect(driver_);
+    vigem_free(driver_);
+}
+
+bool ViGEmPadSink::plug(size_t idx, const Config& config, FeedbackHandler handler, void* context)
+{
+    if (idx >= targets_.size()) {
+        targets_.resize(idx + 1);
+    }
+    if (!targets_[idx]) {
+        targets_[idx] = std::make_unique<Target>();
+    }
+    auto& slot = *targets_[idx];
+    if (slot.target != nullptr) {
+        return false;
+    }
+    slot.type = config.type;
+    slot.handler = handler;
+    slot.context = context;
+
+    const bool ds4 = config.type == Type::DS4;
+    slot.target = ds4 ? vigem_target_ds4_alloc() : vigem_target_x360_alloc();
+    if (config.vid != 0) {
+        vigem_target_set_vid(slot.target, config.vid);
+    }
+    if (config.pid != 0) {
+        vigem_target_set_pid(slot.target, config.pid);
+    }
+
+    const auto target_add_res = vigem_target_add(driver_, slot.target);
+    if (target_add_res != VIGEM_ERROR_NONE) {
+        vigem_target_free(slot.target);
+        slot.target = nullptr;
+        return false;
+    }
+    spdlog::info("Plugged in controller {}, {}; VID: {:x}; PID: {:x}",
+                 idx,
+                 vigem_target_get_index(slot.target),
+                 vigem_target_get_vid(slot.target),
+                 vigem_target_get_pid(slot.target));
+
+    VIGEM_ERROR callback_register_res;
+    if (ds4) {
+        // TODO: make sense of DS4_OUTPUT_BUFFER
+        // there is no doc? Ask @Nef about this...
+        // ReSharper disable once CppDeprecatedEntity
+#pragma warning(disable : 4996)
+        callback_register_res = vigem_target_ds4_register_notification(
+            driver_,
+            slot.target,
+            &ViGEmPadSink::ds4ControllerCallback,
+            &slot);
+    }
+    else {
+        callback_register_res = vigem_target_x360_register_notification(
+            driver_,
+            slot.target,
+            &ViGEmPadSink::x360ControllerCallback,
+            &slot);
+    }
+    if (!VIGEM_SUCCESS(callback_register_res)) {
+        spdlog::error("Registering controller {}, {} for notification failed with error code: {:#x}", idx, vigem_target_get_index(slot.target), callback_register_res);
+    }
+    return true;
+}
+
+bool ViGEmPadSink::unplug(size_t idx)
+{
+    if (!isPlugged(idx)) {
+        return false;
+    }
+    auto& slot = *targets_[idx];
+    if (!VIGEM_SUCCESS(vigem_target_remove(driver_, slot.target))) {
+        return false;
+    }
+    spdlog::info("Unplugged controller {}, {}", idx, vigem_target_get_index(slot.target));
+    vigem_target_free(slot.target);
+    slot.target = nullptr;
+    return true;
+}
+
+bool ViGEmPadSink::isPlugged(size_t idx) const
+{
+    return idx < targets_.size() && targets_[idx] && targets_[idx]->target != nullptr;
+}
+
+bool ViGEmPadSink::submit(size_t idx, const Ds4Translation::XusbReport& report)
+{
+    if (!isPlugged(idx)) {
+        return false;
+    }
+    const auto& slot = *targets_[idx];
+    if (slot.type == Type::DS4) {
+        // The DualShock 4 expects a different report format.
+        // Translation is bit-identical to ViGEms XUSB_TO_DS4_REPORT helper, just table driven.
+        const auto out = Ds4Translation::Translate(report);
+        DS4_REPORT rep;
+        std::memcpy(&rep, &out, sizeof(rep));
+        return VIGEM_SUCCESS(vigem_target_ds4_update(driver_, slot.target, rep));
+    }
+    XUSB_REPORT rep;
+    std::memcpy(&rep, &report, sizeof(rep));
+    return VIGEM_SUCCESS(vigem_target_x360_update(driver_, slot.target, rep));
+}
+
+void ViGEmPadSink::x360ControllerCallback(PVIGEM_CLIENT client, PVIGEM_TARGET Target, UCHAR LargeMotor, UCHAR SmallMotor, UCHAR LedNumber, LPVOID UserData)
+{
+    const auto slot = static_cast<ViGEmPadSink::Target*>(UserData);
+    if (slot->handler == nullptr) {
+        return;
+    }
+    Feedback::State state;
+    state.large_motor = LargeMotor;
+    state.small_motor = SmallMotor;
+    state.led_number = LedNumber;
+    slot->handler(slot->context, state);
+}
+
+void ViGEmPadSink::ds4ControllerCallback(PVIGEM_CLIENT client, PVIGEM_TARGET Target, UCHAR LargeMotor, UCHAR SmallMotor, DS4_LIGHTBAR_COLOR LightbarColor, LPVOID UserData)
+{
+    const auto slot = static_cast<ViGEmPadSink::Target*>(UserData);
+    if (slot->handler == nullptr) {
+        return;
+    }
+    Feedback::State state;
+    state.large_motor = LargeMotor;
+    state.small_motor = SmallMotor;
+    state.has_lightbar = true;
+    state.lightbar_red = LightbarColor.Red;
+    state.lightbar_green = LightbarColor.Green;
+    state.lightbar_blue = LightbarColor.Blue;
+    slot->handler(slot->context, state);
+}
@@ -0,0 +1,65 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <memory>
+#include <vector>
+
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <ViGEm/Client.h>
+
+#include "PadSink.h"
+
+/*
+ * Virtual controllers via the ViGEm bus driver
+ */
+class ViGEmPadSink : public PadSink {
+  public:
+    ViGEmPadSink();
+    ~ViGEmPadSink() override;
+
+    const char* name() const override
+    {
+        return "ViGEm";
+    }
+
+    bool isConnected() const override
+    {
+        return connected_;
+    }
+
+    bool plug(size_t idx, const Config& config, FeedbackHandler handler, void* context) override;
+    bool unplug(size_t idx) override;
+    bool isPlugged(size_t idx) const override;
+    bool submit(size_t idx, const Ds4Translation::XusbReport& report) override;
+
+  private:
+    struct Target {
+        PVIGEM_TARGET target = nullptr;
+        Type type = Type::X360;
+        FeedbackHandler handler = nullptr;
+        void* context = nullptr;
+    };
+
+    PVIGEM_CLIENT driver_;
+    bool connected_ = false;
+    // address is passed as ViGEm callback user data; never moves
+    std::vector<std::unique_ptr<Target>> targets_;
+
+    static void CALLBACK x360ControllerCallback(PVIGEM_CLIENT client, PVIGEM_TARGET Target, UCHAR LargeMotor, UCHAR SmallMotor, UCHAR LedNumber, LPVOID UserData);
+    static void CALLBACK ds4ControllerCallback(PVIGEM_CLIENT client, PVIGEM_TARGET Target, UCHAR LargeMotor, UCHAR SmallMotor, DS4_LIGHTBAR_COLOR LightbarColor, LPVOID UserData);
+};
@@ -0,0 +1,226 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+/*
+ * Top level windows of the launched processes
+ *
+ * Keeps a window -> PID map of all top level windows, maintained by window create/destroy events
+ * instead of enumerating every window on each update.
+ * "Tracked" windows are the ones owned by one of the given PIDs, plus extra windows (UWP frames).
+ *
+ * isTracked() is called from the GetForegroundWindow hook, on any thread; everything else from the main thread.
+ * The event hook needs a message loop on the thread calling startEvents().
+ */
+class WindowIndex {
+  public:
+#ifdef _WIN32
+    using Id = HWND;
+#else
+    using Id = void*;
+#endif
+
+    WindowIndex() = default;
+    ~WindowIndex()
+    {
+        stopEvents();
+    }
+
+    WindowIndex(const WindowIndex&) = delete;
+    WindowIndex& operator=(const WindowIndex&) = delete;
+
+    // Replaces the whole index, e.g. from a full enumeration
+    void reset(const std::vector<std::pair<Id, uint32_t>>& windows)
+    {
+        std::unique_lock lock(mutex_);
+        windows_.clear();
+        windows_.reserve(windows.size());
+        for (const auto& [window, pid] : windows) {
+            windows_.emplace(window, pid);
+        }
+        rebuildTracked();
+    }
+
+    void addWindow(Id window, uint32_t pid)
+    {
+        std::unique_lock lock(mutex_);
+        windows_[window] = pid;
+        if (pids_.contains(pid)) {
+            tracked_.insert(window);
+        }
+    }
+
+    void removeWindow(Id window)
+    {
+        std::unique_lock lock(mutex_);
+        windows_.erase(window);
+        extra_.erase(window);
+        tracked_.erase(window);
+    }
+
+    // Only rebuilds the tracked set if the PIDs actually changed
+    template <typename Pids>
+    void setPids(const Pids& pids)
+    {
+        {
+            std::shared_lock lock(mutex_);
+            if (pids_.size() == static_cast<size_t>(std::ranges::distance(pids))
+                && std::ranges::all_of(pids, [this](auto pid) { return pids_.contains(static_cast<uint32_t>(pid)); })) {
+                return;
+            }
+        }
+        std::unique_lock lock(mutex_);
+        pids_.clear();
+        for (const auto pid : pids) {
+            pids_.insert(static_cast<uint32_t>(pid));
+        }
+        rebuildTracked();
+    }
+
+    // Windows tracked regardless of their PID
+    void setExtraWindows(const std::vector<Id>& windows)
+    {
+        std::unique_lock lock(mutex_);
+        if (extra_.size() == windows.size() && std::ranges::all_of(windows, [this](Id window) { return extra_.contains(window); })) {
+            return;
+        }
+        extra_ = {windows.begin(), windows.end()};
+        rebuildTracked();
+    }
+
+    bool isTracked(Id window) const
+    {
+        std::shared_lock lock(mutex_);
+        return tracked_.contains(window);
+    }
+
+    std::vector<Id> trackedWindows() const
+    {
+        std::shared_lock lock(mutex_);
+        return {tracked_.begin(), tracked_.end()};
+    }
+
+    size_t size() const
+    {
+        std::shared_lock lock(mutex_);
+        return windows_.size();
+    }
+
+#ifdef _WIN32
+    // Enumerates all top level windows and keeps the index up to date from then on
+    bool startEvents()
+    {
+        if (hook_) {
+            return true;
+        }
+        instance_ = this;
+        hook_ = SetWinEventHook(EVENT_OBJECT_CREATE, EVENT_OBJECT_DESTROY, nullptr, &WindowIndex::EventProc, 0, 0,
+                                WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+        // enumerate after hooking; windows created in between are simply added twice
+        std::vector<std::pair<Id, uint32_t>> windows;
+        EnumWindows(
+            [](HWND hwnd, LPARAM param) -> BOOL {
+                DWORD pid = 0;
+                GetWindowThreadProcessId(hwnd, &pid);
+                reinterpret_cast<std::vector<std::pair<Id, uint32_t>>*>(param)->emplace_back(hwnd, pid);
+                return TRUE;
+            },
+            reinterpret_cast<LPARAM>(&windows));
+        reset(windows);
+        return hook_ != nullptr;
+    }
+
+    void stopEvents()
+    {
+        if (hook_) {
+            UnhookWinEvent(hook_);
+            hook_ = nullptr;
+            instance_ = nullptr;
+        }
+    }
+
+    bool eventsRunning() const
+    {
+        return hook_ != nullptr;
+    }
+#else
+    bool startEvents()
+    {
+        return false;
+    }
+
+    void stopEvents() {}
+
+    bool eventsRunning() const
+    {
+        return false;
+    }
+#endif
+
+  private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<Id, uint32_t> windows_;
+    std::unordered_set<uint32_t> pids_;
+    std::unordered_set<Id> extra_;
+    std::unordered_set<Id> tracked_;
+
+    // mutex_ must be held exclusively
+    void rebuildTracked()
+    {
+        tracked_ = extra_;
+        if (pids_.empty()) {
+            return;
+        }
+        for (const auto& [window, pid] : windows_) {
+            if (pids_.contains(pid)) {
+                tracked_.insert(window);
+            }
+        }
+    }
+
+#ifdef _WIN32
+    HWINEVENTHOOK hook_ = nullptr;
+    static inline WindowIndex* instance_ = nullptr;
+
+    static void CALLBACK EventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG id_object, LONG id_child, DWORD event_thread, DWORD event_time)
+    {
+        if (instance_ == nullptr || hwnd == nullptr || id_object != OBJID_WINDOW || id_child != CHILDID_SELF) {
+            return;
+        }
+        if (event == EVENT_OBJECT_DESTROY) {
+            instance_->removeWindow(hwnd);
+            return;
+        }
+        if (event == EVENT_OBJECT_CREATE && GetAncestor(hwnd, GA_PARENT) == GetDesktopWindow()) {
+            DWORD pid = 0;
+            GetWindowThreadProcessId(hwnd, &pid);
+            instance_->addWindow(hwnd, pid);
+        }
+    }
+#endif
+};
@@ -0,0 +1,64 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <cstring>
+
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <Xinput.h>
+
+#include "InputSource.h"
+
+/*
+ * Plain XInput
+ *
+ * The default, as this is what Steam Input hooks into; capped to XUSER_MAX_COUNT controllers
+ */
+class XInputSource : public InputSource {
+  public:
+    const char* name() const override
+    {
+        return "XInput";
+    }
+
+    size_t maxPads() const override
+    {
+        return XUSER_MAX_COUNT;
+    }
+
+    bool poll(size_t idx, PadState& state) override
+    {
+        XINPUT_STATE xstate{};
+        if (XInputGetState(static_cast<DWORD>(idx), &xstate) != ERROR_SUCCESS) {
+            return false;
+        }
+        state.packet = xstate.dwPacketNumber;
+        std::memcpy(&state.gamepad, &xstate.Gamepad, sizeof(state.gamepad));
+        return true;
+    }
+
+    bool setVibration(size_t idx, uint8_t large_motor, uint8_t small_motor) override
+    {
+        XINPUT_VIBRATION vibration;
+        ZeroMemory(&vibration, sizeof(XINPUT_VIBRATION));
+        vibration.wLeftMotorSpeed = large_motor * 257;
+        vibration.wRightMotorSpeed = small_motor * 257;
+        return XInputSetState(static_cast<DWORD>(idx), &vibration) == ERROR_SUCCESS;
+    }
+
+    static_assert(sizeof(Ds4Translation::XusbReport) == sizeof(XINPUT_GAMEPAD));
+};
@@ -0,0 +1,229 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "XusbInputSource.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <cfgmgr32.h>
+#include <spdlog/spdlog.h>
+
+#pragma comment(lib, "Cfgmgr32.lib")
+
+namespace {
+// {EC87F1E3-C13B-4100-B5F7-8B84D54260CB}
+constexpr GUID GUID_DEVINTERFACE_XUSB = {0xEC87F1E3, 0xC13B, 0x4100, {0xB5, 0xF7, 0x8B, 0x84, 0xD5, 0x42, 0x60, 0xCB}};
+
+// IOCTLs and buffer layouts as reverse engineered by OpenXInput
+constexpr DWORD IOCTL_XUSB_GET_INFORMATION = 0x80006000;
+constexpr DWORD IOCTL_XUSB_GET_STATE = 0x8000E00C;
+constexpr DWORD IOCTL_XUSB_SET_STATE = 0x8000A010;
+
+#pragma pack(push, 1)
+struct XusbInformation {
+    uint16_t version;
+    // low 7 bits: number of pads behind this interface
+    uint8_t pad_count;
+    uint8_t unk1;
+    uint32_t unk2;
+    uint16_t vendor_id;
+    uint16_t product_id;
+};
+
+struct XusbStateRequest {
+    uint16_t version;
+    uint8_t index;
+};
+
+struct XusbState {
+    uint8_t status;
+    uint8_t unk0;
+    uint8_t input_id;
+    uint32_t packet;
+    uint8_t unk1;
+    uint16_t buttons;
+    uint8_t left_trigger;
+    uint8_t right_trigger;
+    int16_t thumb_lx;
+    int16_t thumb_ly;
+    int16_t thumb_rx;
+    int16_t thumb_ry;
+};
+
+struct XusbVibration {
+    uint8_t index;
+    uint8_t unk0;
+    uint8_t large_motor;
+    uint8_t small_motor;
+    uint8_t flags;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(XusbInformation) == 12);
+static_assert(sizeof(XusbState) == 20);
+} // namespace
+
+XusbInputSource::Device::~Device()
+{
+    if (handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(handle);
+    }
+}
+
+XusbInputSource::XusbInputSource(uint16_t ignore_vid, uint16_t ignore_pid)
+    : slots_(MAX_PADS), ignore_vid_(ignore_vid), ignore_pid_(ignore_pid)
+{
+    spdlog::warn("Using XUSB input backend; Steam Input configuration does NOT apply to controllers!");
+}
+
+XusbInputSource::~XusbInputSource() = default;
+
+void XusbInputSource::beginTick()
+{
+    if (enumerate_.exchange(false)) {
+        enumerate();
+    }
+}
+
+bool XusbInputSource::poll(size_t idx, PadState& state)
+{
+    const auto& slot = slots_[idx];
+    if (!slot.device) {
+        return false;
+    }
+    const XusbStateRequest request{slot.device->version, slot.index};
+    // newer drivers return more data than we care about
+    uint8_t buffer[64]{};
+    DWORD returned = 0;
+    if (!DeviceIoControl(slot.device->handle, IOCTL_XUSB_GET_STATE,
+                         const_cast<XusbStateRequest*>(&request), sizeof(request),
+                         buffer, sizeof(buffer), &returned, nullptr)
+        || returned < sizeof(XusbState)) {
+        spdlog::debug("XUSB device in slot {} stopped responding; error: {}", idx, GetLastError());
+        close(std::shared_ptr(slot.device));
+        enumerate_ = true;
+        return false;
+    }
+    XusbState xstate;
+    std::memcpy(&xstate, buffer, sizeof(xstate));
+    if (xstate.status != 1) {
+        return false;
+    }
+    state.packet = xstate.packet;
+    state.gamepad.wButtons = xstate.buttons;
+    state.gamepad.bLeftTrigger = xstate.left_trigger;
+    state.gamepad.bRightTrigger = xstate.right_trigger;
+    state.gamepad.sThumbLX = xstate.thumb_lx;
+    state.gamepad.sThumbLY = xstate.thumb_ly;
+    state.gamepad.sThumbRX = xstate.thumb_rx;
+    state.gamepad.sThumbRY = xstate.thumb_ry;
+    return true;
+}
+
+bool XusbInputSource::setVibration(size_t idx, uint8_t large_motor, uint8_t small_motor)
+{
+    const auto& slot = slots_[idx];
+    if (!slot.device) {
+        return false;
+    }
+    XusbVibration vibration{slot.index, 0, large_motor, small_motor, 2};
+    DWORD returned = 0;
+    return DeviceIoControl(slot.device->handle, IOCTL_XUSB_SET_STATE, &vibration, sizeof(vibration), nullptr, 0, &returned, nullptr);
+}
+
+void XusbInputSource::devicesChanged()
+{
+    enumerate_ = true;
+}
+
+void XusbInputSource::enumerate()
+{
+    ULONG size = 0;
+    if (CM_Get_Device_Interface_List_SizeW(&size, const_cast<GUID*>(&GUID_DEVINTERFACE_XUSB), nullptr, CM_GET_DEVICE_INTERFACE_LIST_PRESENT) != CR_SUCCESS) {
+        return;
+    }
+    std::wstring list(size, L'\0');
+    if (CM_Get_Device_Interface_ListW(const_cast<GUID*>(&GUID_DEVINTERFACE_XUSB), nullptr, list.data(), size, CM_GET_DEVICE_INTERFACE_LIST_PRESENT) != CR_SUCCESS) {
+        return;
+    }
+    std::vector<std::wstring> paths;
+    for (const wchar_t* path = list.c_str(); *path; path += wcslen(path) + 1) {
+        paths.emplace_back(path);
+    }
+
+    // keep slots of devices still present stable; drop the rest
+    for (auto& slot : slots_) {
+        if (slot.device && std::ranges::find(paths, slot.device->path) == paths.end()) {
+            close(std::shared_ptr(slot.device));
+        }
+    }
+
+    for (const auto& path : paths) {
+        if (std::ranges::find_if(slots_, [&path](const auto& s) { return s.device && s.device->path == path; }) != slots_.end()) {
+            continue;
+        }
+        if (std::ranges::none_of(slots_, [](const auto& s) { return !s.device; })) {
+            spdlog::warn("More than {} XUSB controllers connected; ignoring the rest", MAX_PADS);
+            break;
+        }
+        const auto handle = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) {
+            continue;
+        }
+        XusbInformation info{};
+        DWORD returned = 0;
+        if (!DeviceIoControl(handle, IOCTL_XUSB_GET_INFORMATION, nullptr, 0, &info, sizeof(info), &returned, nullptr)
+            || returned < sizeof(info)) {
+            CloseHandle(handle);
+            continue;
+        }
+        if (info.vendor_id == ignore_vid_ && info.product_id == ignore_pid_) {
+            // one of our own emulated controllers
+            CloseHandle(handle);
+            continue;
+        }
+        if (info.version < 0x0101) {
+            spdlog::warn("XUSB controller {:x}:{:x} uses unsupported protocol version {:#x}", info.vendor_id, info.product_id, info.version);
+            CloseHandle(handle);
+            continue;
+        }
+        const auto device = std::make_shared<Device>();
+        device->path = path;
+        device->handle = handle;
+        device->version = info.version;
+        // wired controllers have one pad; wireless receivers one per possible controller
+        const uint8_t pad_count = std::max<uint8_t>(info.pad_count & 0x7F, 1);
+        for (uint8_t pad = 0; pad < pad_count; pad++) {
+            const auto free_slot = std::ranges::find_if(slots_, [](const auto& s) { return !s.device; });
+            if (free_slot == slots_.end()) {
+                spdlog::warn("More than {} XUSB controllers connected; ignoring the rest", MAX_PADS);
+                break;
+            }
+            free_slot->device = device;
+            free_slot->index = pad;
+            spdlog::info("XUSB controller {:x}:{:x} pad {}/{} in slot {}", info.vendor_id, info.product_id, pad + 1, pad_count, std::distance(slots_.begin(), free_slot));
+        }
+    }
+}
+
+void XusbInputSource::close(const std::shared_ptr<Device>& device)
+{
+    for (auto& slot : slots_) {
+        if (slot.device == device) {
+            slot = Slot{};
+        }
+    }
+}
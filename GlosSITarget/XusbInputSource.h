@@ -0,0 +1,87 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+#include "InputSource.h"
+
+/*
+ * Talks to XUSB (Xbox 360 / XInput) devices directly via their driver interface, OpenXInput style
+ *
+ * Not limited to 4 controllers. One device interface can carry several pads (wireless receivers: 4);
+ * each of them gets its own slot.
+ * EXPERIMENTAL: This bypasses XInput, and with it Steam Input's hooks!
+ * Controllers show up as-is, without any Steam Input configuration applied.
+ */
+class XusbInputSource : public InputSource {
+  public:
+    static constexpr size_t MAX_PADS = 16;
+
+    // VID/PID of our own emulated controllers; those are skipped
+    XusbInputSource(uint16_t ignore_vid, uint16_t ignore_pid);
+    ~XusbInputSource() override;
+
+    XusbInputSource(const XusbInputSource&) = delete;
+    XusbInputSource& operator=(const XusbInputSource&) = delete;
+
+    const char* name() const override
+    {
+        return "XUSB";
+    }
+
+    size_t maxPads() const override
+    {
+        return MAX_PADS;
+    }
+
+    void beginTick() override;
+    bool poll(size_t idx, PadState& state) override;
+    bool setVibration(size_t idx, uint8_t large_motor, uint8_t small_motor) override;
+    void devicesChanged() override;
+
+  private:
+    // one opened device interface; closed once no slot uses it anymore
+    struct Device {
+        std::wstring path;
+        HANDLE handle = INVALID_HANDLE_VALUE;
+        uint16_t version = 0;
+        Device() = default;
+        Device(const Device&) = delete;
+        Device& operator=(const Device&) = delete;
+        ~Device();
+    };
+    struct Slot {
+        std::shared_ptr<Device> device;
+        // pad on that device
+        uint8_t index = 0;
+    };
+    // index = slot
+    std::vector<Slot> slots_;
+    std::atomic<bool> enumerate_ = true;
+    uint16_t ignore_vid_;
+    uint16_t ignore_pid_;
+
+    void enumerate();
+    // frees all slots of the device
+    void close(const std::shared_ptr<Device>& device);
+};
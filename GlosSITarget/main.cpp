@@ -29,8 +29,12 @@ limitations under the License.
 
 #include "SteamTarget.h"
 
+#include "AsyncLogSink.h"
+#include "Log.h"
 #include "OverlayLogSink.h"
+#include "StartupTimings.h"
 #include "..\common\Settings.h"
+#include <algorithm>
 #include <iostream>
 
 #include "../version.hpp"
@@ -67,6 +71,8 @@ LONG Win32FaultHandler(struct _EXCEPTION_POINTERS* ExInfo)
     spdlog::error("*** Error code {:#x}: {}", wsFault, FaultTx);
     spdlog::error("*** Address: {:#x}", (int)CodeAdress);
     spdlog::error("*** Flags: {:#x}", ExInfo->ExceptionRecord->ExceptionFlags);
+    // get whatever is still queued for the log file out before (possibly) dying
+    spdlog::default_logger()->flush();
 
     MINIDUMP_EXCEPTION_INFORMATION M;
     HANDLE hDump_File;
@@ -98,6 +104,27 @@ LONG Win32FaultHandler(struct _EXCEPTION_POINTERS* ExInfo)
 
 #endif
 
+// Moves writing to the given sinks of the logger onto a background thread
+void EnableAsyncLogging(const std::shared_ptr<spdlog::logger>& logger, const std::vector<spdlog::sink_ptr>& sinks)
+{
+    const auto async_sink = std::make_shared<spdlog::sinks::async_queue_sink>(
+        sinks,
+        spdlog::sinks::async_queue_sink::options{
+            .queue_size = Settings::logging.queueSize,
+            .flush_batch = Settings::logging.flushBatch,
+            .flush_interval = std::chrono::milliseconds(Settings::logging.flushIntervalMs),
+            .overflow = Settings::logging.overflow == "drop"
+                            ? spdlog::sinks::async_queue_sink::overflow_policy::drop
+                            : spdlog::sinks::async_queue_sink::overflow_policy::block,
+        });
+    auto& logger_sinks = logger->sinks();
+    std::erase_if(logger_sinks, [&sinks](const auto& s) { return std::ranges::find(sinks, s) != sinks.end(); });
+    logger_sinks.insert(logger_sinks.begin(), async_sink);
+    // flush() drains the queue synchronously, so errors still hit the disk before returning
+    logger->flush_on(spdlog::level::err);
+    spdlog::debug("Async logging enabled; queue: {}, overflow: {}", Settings::logging.queueSize, Settings::logging.overflow);
+}
+
 #ifdef _WIN32
 #ifdef CONSOLE
 int main(int argc, char* argv[])
@@ -138,6 +165,7 @@ int main(int argc, char* argv[])
     spdlog::set_default_logger(logger);
     SetUnhandledExceptionFilter(static_cast<LPTOP_LEVEL_EXCEPTION_FILTER>(Win32FaultHandler));
     spdlog::info("GlosSITarget version: {}", version::VERSION_STR);
+    StartupTimings::Mark("Logging");
     auto exit = 1;
     try {
 #ifdef _WIN32
@@ -158,6 +186,11 @@ int main(int argc, char* argv[])
                 argsv.emplace_back(args[i]);
         }
         Settings::Parse(argsv);
+        Log::SetExtended(Settings::common.extendedLogging, Settings::common.extendedLogCategories);
+        if (Settings::logging.async) {
+            EnableAsyncLogging(logger, {file_sink, console_sink});
+        }
+        StartupTimings::Mark("Settings");
         Settings::checkWinVer();
         SteamTarget target;
 #else // Code below is broken now due to parse requiring std::wstring instead of std:string. Sorry.
@@ -167,6 +200,11 @@ int main(int argc, char* argv[])
                 argsv += i == 1 ? argv[i] : std::string(" ") + argv[i];
         }
         Settings::Parse(argsv);
+        Log::SetExtended(Settings::common.extendedLogging, Settings::common.extendedLogCategories);
+        if (Settings::logging.async) {
+            EnableAsyncLogging(logger, {file_sink, console_sink});
+        }
+        StartupTimings::Mark("Settings");
         SteamTarget target;
 #endif
         exit = target.run();
@@ -0,0 +1,74 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/spdlog.h>
+
+#include "AsyncLogSink.h"
+
+namespace {
+
+std::shared_ptr<spdlog::sinks::sink> FileSink()
+{
+    return std::make_shared<spdlog::sinks::basic_file_sink_mt>(
+        (std::filesystem::temp_directory_path() / "glossi_async_log_bench.log").string(), true);
+}
+
+// What the input thread pays per line; the file sink is what GlosSITarget logs to
+void LogLines(benchmark::State& state, const std::shared_ptr<spdlog::sinks::sink>& sink, spdlog::level::level_enum flush_level)
+{
+    spdlog::logger logger("bench", sink);
+    logger.set_level(spdlog::level::trace);
+    logger.flush_on(flush_level);
+    int pad = 0;
+    for (auto _ : state) {
+        logger.debug("Controller {} state changed; buttons: {:#x}", pad, 0x1000);
+        pad = (pad + 1) & 3;
+    }
+    logger.flush();
+}
+
+} // namespace
+
+// before: synchronous file sink, flushed on every line (flush_on(trace))
+static void BM_LogLineSync(benchmark::State& state)
+{
+    LogLines(state, FileSink(), spdlog::level::trace);
+}
+BENCHMARK(BM_LogLineSync);
+
+// synchronous, but without flushing; what the file write alone costs
+static void BM_LogLineSyncUnflushed(benchmark::State& state)
+{
+    LogLines(state, FileSink(), spdlog::level::off);
+}
+BENCHMARK(BM_LogLineSyncUnflushed);
+
+// after: EnableAsyncLogging with the default Settings::logging
+static void BM_LogLineAsync(benchmark::State& state)
+{
+    const auto sink = std::make_shared<spdlog::sinks::async_queue_sink>(
+        std::vector<spdlog::sink_ptr>{FileSink()},
+        spdlog::sinks::async_queue_sink::options{8192, 512, std::chrono::milliseconds(250),
+                                                 spdlog::sinks::async_queue_sink::overflow_policy::block});
+    LogLines(state, sink, spdlog::level::err);
+}
+BENCHMARK(BM_LogLineAsync);
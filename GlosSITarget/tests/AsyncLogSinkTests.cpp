@@ -0,0 +1,263 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include "AsyncLogSink.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+class CollectingSink : public spdlog::sinks::base_sink<std::mutex> {
+  public:
+    std::function<void(const std::string&)> on_line;
+
+    std::vector<std::string> lines()
+    {
+        std::lock_guard lock(mutex_);
+        return lines_;
+    }
+
+    size_t flushes() const
+    {
+        return flushes_;
+    }
+
+  protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override
+    {
+        lines_.emplace_back(msg.payload.data(), msg.payload.size());
+        if (on_line) {
+            on_line(lines_.back());
+        }
+    }
+
+    void flush_() override
+    {
+        ++flushes_;
+    }
+
+  private:
+    std::vector<std::string> lines_;
+    std::atomic<size_t> flushes_ = 0;
+};
+
+using Overflow = spdlog::sinks::async_queue_sink::overflow_policy;
+
+spdlog::details::log_msg Msg(const std::string& text)
+{
+    return spdlog::details::log_msg("test", spdlog::level::info, text);
+}
+
+} // namespace
+
+TEST(AsyncLogSink, FlushWritesEverything)
+{
+    auto target = std::make_shared<CollectingSink>();
+    spdlog::sinks::async_queue_sink sink({target}, {64, 1000, 10s, Overflow::block});
+    for (int i = 0; i < 1000; i++) {
+        sink.log(Msg(std::to_string(i)));
+    }
+    sink.flush();
+    const auto lines = target->lines();
+    ASSERT_EQ(lines.size(), 1000u);
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(lines[i], std::to_string(i));
+    }
+    EXPECT_GE(target->flushes(), 1u);
+}
+
+TEST(AsyncLogSink, ConcurrentWritersKeepTheirOrder)
+{
+    auto target = std::make_shared<CollectingSink>();
+    {
+        spdlog::sinks::async_queue_sink sink({target}, {256, 512, 5ms, Overflow::block});
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 4; t++) {
+            writers.emplace_back([&sink, t] {
+                for (int i = 0; i < 10000; i++) {
+                    sink.log(Msg(std::to_string(t) + ":" + std::to_string(i)));
+                }
+            });
+        }
+        for (auto& w : writers) {
+            w.join();
+        }
+    }
+    std::vector<int> next(4, 0);
+    const auto lines = target->lines();
+    ASSERT_EQ(lines.size(), 40000u);
+    for (const auto& line : lines) {
+        const auto t = std::stoi(line.substr(0, 1));
+        EXPECT_EQ(std::stoi(line.substr(2)), next[t]++);
+    }
+}
+
+TEST(AsyncLogSink, DropPolicyReportsLostLines)
+{
+    auto target = std::make_shared<CollectingSink>();
+    std::atomic<bool> release = false;
+    // stalls the writer thread on the first line, so the queue fills up
+    target->on_line = [&release](const std::string&) {
+        while (!release) {
+            std::this_thread::sleep_for(1ms);
+        }
+    };
+    spdlog::sinks::async_queue_sink sink({target}, {8, 1, 1ms, Overflow::drop});
+    for (int i = 0; i < 100; i++) {
+        sink.log(Msg("line"));
+    }
+    release = true;
+    sink.flush();
+    EXPECT_GT(sink.dropped(), 0u);
+    const auto lines = target->lines();
+    EXPECT_EQ(lines.size(), 100 - sink.dropped() + 1);
+    EXPECT_NE(lines.back().find("dropped"), std::string::npos);
+}
+
+// e.g. the crash handler running on the writer thread
+TEST(AsyncLogSink, FlushOnWriterThreadReturnsImmediately)
+{
+    // plain sink (no mutex of its own), so it can flush the other sinks from within log()
+    class FlushingSink : public spdlog::sinks::sink {
+      public:
+        spdlog::sinks::async_queue_sink* async = nullptr;
+        std::thread::id flushed_on;
+        std::chrono::steady_clock::duration flush_time{};
+
+        void log(const spdlog::details::log_msg& msg) override
+        {
+            if (std::string(msg.payload.data(), msg.payload.size()) == "crash") {
+                const auto start = std::chrono::steady_clock::now();
+                async->flush();
+                flush_time = std::chrono::steady_clock::now() - start;
+                flushed_on = std::this_thread::get_id();
+            }
+        }
+        void flush() override {}
+        void set_pattern(const std::string&) override {}
+        void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+    };
+
+    auto target = std::make_shared<CollectingSink>();
+    auto trigger = std::make_shared<FlushingSink>();
+    spdlog::sinks::async_queue_sink sink({target, trigger}, {64, 100, 1ms, Overflow::block});
+    trigger->async = &sink;
+    sink.log(Msg("crash"));
+    // has to be picked up by the writer thread, not by our flush() below
+    const auto until = std::chrono::steady_clock::now() + 5s;
+    while (target->lines().empty() && std::chrono::steady_clock::now() < until) {
+        std::this_thread::sleep_for(1ms);
+    }
+    sink.log(Msg("after"));
+    sink.flush();
+
+    const auto lines = target->lines();
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_EQ(lines[1], "after");
+    EXPECT_NE(trigger->flushed_on, std::this_thread::get_id());
+    EXPECT_LT(trigger->flush_time, 500ms);
+    EXPECT_GE(target->flushes(), 1u);
+}
+
+TEST(AsyncLogSink, WriterFlushesWithinOneInterval)
+{
+    auto target = std::make_shared<CollectingSink>();
+    spdlog::sinks::async_queue_sink sink({target}, {64, 1000, 200ms, Overflow::block});
+    const auto start = std::chrono::steady_clock::now();
+    sink.log(Msg("line"));
+    while (target->flushes() == 0 && std::chrono::steady_clock::now() - start < 5s) {
+        std::this_thread::sleep_for(1ms);
+    }
+    // flushed in the same pass that wrote it, not one interval later
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 300ms);
+    EXPECT_EQ(target->lines().size(), 1u);
+}
+
+TEST(AsyncLogSink, FlushDoesNotWaitForBusyWriter)
+{
+    auto target = std::make_shared<CollectingSink>();
+    std::atomic<bool> writing = false;
+    std::atomic<bool> release = false;
+    target->on_line = [&](const std::string&) {
+        writing = true;
+        while (!release) {
+            std::this_thread::sleep_for(1ms);
+        }
+    };
+    spdlog::sinks::async_queue_sink sink({target}, {64, 1000, 1ms, Overflow::block});
+    sink.log(Msg("stuck"));
+    const auto until = std::chrono::steady_clock::now() + 5s;
+    while (!writing && std::chrono::steady_clock::now() < until) {
+        std::this_thread::sleep_for(1ms);
+    }
+    ASSERT_TRUE(writing);
+
+    sink.log(Msg("error"));
+    const auto start = std::chrono::steady_clock::now();
+    sink.flush();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 200ms);
+
+    // the writer picks it up once it's unstuck
+    release = true;
+    while (target->lines().size() < 2 && std::chrono::steady_clock::now() < until) {
+        std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_EQ(target->lines().size(), 2u);
+}
+
+TEST(AsyncLogSink, WriterThreadLoggingDoesNotBlock)
+{
+    // a wrapped sink that logs itself, e.g. reporting its own errors
+    class EchoSink : public spdlog::sinks::sink {
+      public:
+        spdlog::sinks::async_queue_sink* async = nullptr;
+
+        void log(const spdlog::details::log_msg& msg) override
+        {
+            if (std::string(msg.payload.data(), msg.payload.size()) == "echo") {
+                for (int i = 0; i < 100; i++) {
+                    async->log(Msg("echoed"));
+                }
+            }
+        }
+        void flush() override {}
+        void set_pattern(const std::string&) override {}
+        void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+    };
+
+    auto target = std::make_shared<CollectingSink>();
+    auto echo = std::make_shared<EchoSink>();
+    // block policy and a queue far smaller than what the writer pushes
+    spdlog::sinks::async_queue_sink sink({target, echo}, {8, 1000, 1ms, Overflow::block});
+    echo->async = &sink;
+    sink.log(Msg("echo"));
+    const auto until = std::chrono::steady_clock::now() + 5s;
+    while (sink.dropped() == 0 && std::chrono::steady_clock::now() < until) {
+        std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_GT(sink.dropped(), 0u);
+    sink.flush();
+    EXPECT_GT(target->lines().size(), 1u);
+}
@@ -0,0 +1,156 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "DisplayTopology.h"
+
+namespace {
+
+using DisplayTopology::Monitor;
+using DisplayTopology::Rect;
+using DisplayTopology::Topology;
+
+// 1080p primary, 1440p to its left (top aligned), 1080p portrait above the primary
+Topology ThreeMonitors()
+{
+    return {{
+        {"\\\\.\\DISPLAY1", {0, 0, 1920, 1080}, {0, 0, 1920, 1040}, true, 144},
+        {"\\\\.\\DISPLAY2", {-2560, 0, 0, 1440}, {-2560, 0, 0, 1440}, false, 60},
+        {"\\\\.\\DISPLAY3", {0, -1920, 1080, 0}, {0, -1920, 1080, 0}, false, 60},
+    }};
+}
+
+} // namespace
+
+TEST(DisplayTopology, RectMath)
+{
+    const Rect a{0, 0, 100, 50};
+    EXPECT_EQ(a.width(), 100);
+    EXPECT_EQ(a.height(), 50);
+    EXPECT_EQ(a.area(), 5000);
+    EXPECT_FALSE(a.empty());
+
+    EXPECT_TRUE(Rect{}.empty());
+    EXPECT_TRUE((Rect{10, 10, 5, 20}).empty());
+    EXPECT_EQ((Rect{10, 10, 5, 20}).area(), 0);
+    // doesn't overflow int
+    EXPECT_EQ((Rect{-40000, -40000, 40000, 40000}).area(), 6'400'000'000);
+
+    EXPECT_EQ(a.intersect({50, 25, 200, 200}), (Rect{50, 25, 100, 50}));
+    EXPECT_EQ(a.intersect({-10, -10, 10, 10}), (Rect{0, 0, 10, 10}));
+    // touching edges don't overlap
+    EXPECT_EQ(a.intersect({100, 0, 200, 50}), Rect{});
+    EXPECT_EQ(a.intersect({300, 300, 400, 400}), Rect{});
+
+    EXPECT_EQ(a.unite({-10, 20, 10, 80}), (Rect{-10, 0, 100, 80}));
+    EXPECT_EQ(a.unite({}), a);
+    EXPECT_EQ(Rect{}.unite(a), a);
+}
+
+TEST(DisplayTopology, DistanceToRect)
+{
+    const Rect r{0, 0, 100, 50};
+    EXPECT_EQ(r.distanceSq(0, 0), 0);
+    EXPECT_EQ(r.distanceSq(99, 49), 0);
+    // right/bottom are exclusive; the closest pixel is at 99/49
+    EXPECT_EQ(r.distanceSq(100, 0), 1);
+    EXPECT_EQ(r.distanceSq(0, 50), 1);
+    EXPECT_EQ(r.distanceSq(-3, 10), 9);
+    EXPECT_EQ(r.distanceSq(-3, -4), 25);
+    EXPECT_EQ(r.distanceSq(102, 53), 3 * 3 + 4 * 4);
+    EXPECT_EQ(r.distanceSq(-100000, 0), 10'000'000'000);
+}
+
+TEST(DisplayTopology, Lookups)
+{
+    const auto topology = ThreeMonitors();
+    EXPECT_EQ(topology.virtualScreen(), (Rect{-2560, -1920, 1920, 1440}));
+    ASSERT_NE(topology.primary(), nullptr);
+    EXPECT_EQ(topology.primary()->id, "\\\\.\\DISPLAY1");
+    ASSERT_NE(topology.find("\\\\.\\DISPLAY3"), nullptr);
+    EXPECT_EQ(topology.find("\\\\.\\DISPLAY3")->bounds.height(), 1920);
+    EXPECT_EQ(topology.find("\\\\.\\DISPLAY9"), nullptr);
+
+    // no primary flag: first one
+    Topology unflagged{{
+        {"a", {0, 0, 10, 10}, {0, 0, 10, 10}, false, 60},
+        {"b", {10, 0, 20, 10}, {10, 0, 20, 10}, false, 60},
+    }};
+    EXPECT_EQ(unflagged.primary()->id, "a");
+
+    const Topology none;
+    EXPECT_EQ(none.primary(), nullptr);
+    EXPECT_EQ(none.monitorFor({0, 0, 10, 10}), nullptr);
+    EXPECT_EQ(none.virtualScreen(), Rect{});
+}
+
+TEST(DisplayTopology, MonitorForWindow)
+{
+    const auto topology = ThreeMonitors();
+    const auto id = [&topology](const Rect& window) {
+        const auto monitor = topology.monitorFor(window);
+        return monitor ? monitor->id : std::string{};
+    };
+    // fullscreen on each monitor
+    EXPECT_EQ(id({0, 0, 1920, 1080}), "\\\\.\\DISPLAY1");
+    EXPECT_EQ(id({-2560, 0, 0, 1440}), "\\\\.\\DISPLAY2");
+    EXPECT_EQ(id({0, -1920, 1080, 0}), "\\\\.\\DISPLAY3");
+    // straddling: most of the area wins
+    EXPECT_EQ(id({-300, 100, 500, 600}), "\\\\.\\DISPLAY1");
+    EXPECT_EQ(id({-500, 100, 300, 600}), "\\\\.\\DISPLAY2");
+    EXPECT_EQ(id({100, -400, 600, 100}), "\\\\.\\DISPLAY3");
+    // off screen: nearest one
+    EXPECT_EQ(id({3000, 100, 3800, 600}), "\\\\.\\DISPLAY1");
+    EXPECT_EQ(id({-4000, 2000, -3000, 2500}), "\\\\.\\DISPLAY2");
+    EXPECT_EQ(id({-800, -3000, -200, -2500}), "\\\\.\\DISPLAY3");
+    // empty window: monitor at its position
+    EXPECT_EQ(id({-100, 10, -100, 10}), "\\\\.\\DISPLAY2");
+}
+
+TEST(DisplayTopology, CompareReportsChanges)
+{
+    const auto before = ThreeMonitors();
+    EXPECT_TRUE(DisplayTopology::Compare(before, before).empty());
+
+    auto after = before;
+    // DISPLAY2 unplugged, DISPLAY3 switched to 120Hz, new DISPLAY4 to the right
+    after.monitors.erase(after.monitors.begin() + 1);
+    after.monitors[1].refresh_rate = 120;
+    after.monitors.push_back({"\\\\.\\DISPLAY4", {1920, 0, 3840, 1080}, {1920, 0, 3840, 1080}, false, 60});
+    auto diff = DisplayTopology::Compare(before, after);
+    EXPECT_FALSE(diff.empty());
+    EXPECT_EQ(diff.added, std::vector<std::string>{"\\\\.\\DISPLAY4"});
+    EXPECT_EQ(diff.removed, std::vector<std::string>{"\\\\.\\DISPLAY2"});
+    EXPECT_EQ(diff.changed, std::vector<std::string>{"\\\\.\\DISPLAY3"});
+
+    // moves, resolution, work area and primary changes all count
+    for (const auto change : {+[](Monitor& m) { m.bounds.left += 1; },
+                              +[](Monitor& m) { m.bounds.bottom = 2160; },
+                              +[](Monitor& m) { m.work_area.bottom -= 40; },
+                              +[](Monitor& m) { m.primary = !m.primary; }}) {
+        auto changed = before;
+        change(changed.monitors[0]);
+        diff = DisplayTopology::Compare(before, changed);
+        EXPECT_TRUE(diff.added.empty());
+        EXPECT_TRUE(diff.removed.empty());
+        EXPECT_EQ(diff.changed, std::vector<std::string>{"\\\\.\\DISPLAY1"});
+    }
+
+    // order doesn't matter
+    auto reordered = before;
+    std::ranges::reverse(reordered.monitors);
+    EXPECT_TRUE(DisplayTopology::Compare(before, reordered).empty());
+}
@@ -0,0 +1,86 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Ds4Translation.h"
+#include "ViGEmDs4Reference.h"
+
+namespace {
+
+using Ds4Translation::Ds4Report;
+using Ds4Translation::XusbReport;
+
+// random input, so the branchy reference can't coast on the branch predictor
+std::vector<XusbReport> RandomReports(size_t count)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> word(INT16_MIN, INT16_MAX);
+    std::vector<XusbReport> reports(count);
+    for (auto& report : reports) {
+        report = XusbReport{static_cast<uint16_t>(word(rng)), static_cast<uint8_t>(word(rng)), static_cast<uint8_t>(word(rng)),
+                            static_cast<int16_t>(word(rng)), static_cast<int16_t>(word(rng)), static_cast<int16_t>(word(rng)), static_cast<int16_t>(word(rng))};
+    }
+    return reports;
+}
+
+constexpr size_t REPORTS = 4096;
+
+} // namespace
+
+// items/s is reports/s; ns/report = 1e9 / items_per_second
+static void BM_Ds4Translate(benchmark::State& state)
+{
+    const auto in = RandomReports(REPORTS);
+    std::vector<Ds4Report> out(in.size());
+    for (auto _ : state) {
+        Ds4Translation::Translate(in.data(), out.data(), in.size());
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * in.size()));
+}
+BENCHMARK(BM_Ds4Translate);
+
+static void BM_Ds4TranslateViGEm(benchmark::State& state)
+{
+    const auto in = RandomReports(REPORTS);
+    std::vector<Ds4Report> out(in.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < in.size(); i++) {
+            out[i] = ViGEmDs4Reference::Translate(in[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * in.size()));
+}
+BENCHMARK(BM_Ds4TranslateViGEm);
+
+// one report per tick, as in the controller loop
+static void BM_Ds4TranslateSingle(benchmark::State& state)
+{
+    const auto in = RandomReports(REPORTS);
+    size_t i = 0;
+    for (auto _ : state) {
+        auto out = Ds4Translation::Translate(in[i++ % REPORTS]);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_Ds4TranslateSingle);
@@ -0,0 +1,120 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Ds4Translation.h"
+#include "ViGEmDs4Reference.h"
+
+namespace {
+
+using Ds4Translation::Ds4Report;
+using Ds4Translation::XusbReport;
+
+void ExpectSame(const XusbReport& in)
+{
+    const auto expected = ViGEmDs4Reference::Translate(in);
+    const auto actual = Ds4Translation::Translate(in);
+    const auto describe = [&] {
+        return testing::Message() << "buttons " << std::hex << in.wButtons << std::dec
+                                  << " triggers " << +in.bLeftTrigger << "/" << +in.bRightTrigger
+                                  << " sticks " << in.sThumbLX << "," << in.sThumbLY << " " << in.sThumbRX << "," << in.sThumbRY;
+    };
+    ASSERT_EQ(actual.bThumbLX, expected.bThumbLX) << describe();
+    ASSERT_EQ(actual.bThumbLY, expected.bThumbLY) << describe();
+    ASSERT_EQ(actual.bThumbRX, expected.bThumbRX) << describe();
+    ASSERT_EQ(actual.bThumbRY, expected.bThumbRY) << describe();
+    ASSERT_EQ(actual.wButtons, expected.wButtons) << describe();
+    ASSERT_EQ(actual.bSpecial, expected.bSpecial) << describe();
+    ASSERT_EQ(actual.bTriggerL, expected.bTriggerL) << describe();
+    ASSERT_EQ(actual.bTriggerR, expected.bTriggerR) << describe();
+}
+
+} // namespace
+
+TEST(Ds4Translation, AllButtonCombinationsMatchViGEm)
+{
+    for (uint32_t buttons = 0; buttons <= 0xFFFF; buttons++) {
+        ExpectSame(XusbReport{static_cast<uint16_t>(buttons), 0, 0, 0, 0, 0, 0});
+        if (HasFatalFailure()) {
+            return;
+        }
+    }
+}
+
+TEST(Ds4Translation, AllAxisValuesMatchViGEm)
+{
+    for (int32_t v = INT16_MIN; v <= INT16_MAX; v++) {
+        const auto axis = static_cast<int16_t>(v);
+        ExpectSame(XusbReport{0, 0, 0, axis, axis, axis, axis});
+        // sticks are independent of each other
+        ExpectSame(XusbReport{0, 0, 0, axis, static_cast<int16_t>(-1 - v), 0, INT16_MIN});
+        if (HasFatalFailure()) {
+            return;
+        }
+    }
+}
+
+TEST(Ds4Translation, TriggerBoundariesMatchViGEm)
+{
+    for (const uint8_t left : {0, 1, 127, 128, 254, 255}) {
+        for (const uint8_t right : {0, 1, 127, 128, 254, 255}) {
+            ExpectSame(XusbReport{0, left, right, 0, 0, 0, 0});
+            ExpectSame(XusbReport{0xFFFF, left, right, INT16_MIN, INT16_MAX, INT16_MAX, INT16_MIN});
+        }
+    }
+}
+
+TEST(Ds4Translation, RandomReportsMatchViGEm)
+{
+    std::mt19937 rng(0x6105);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> word(INT16_MIN, INT16_MAX);
+    for (int i = 0; i < 1'000'000; i++) {
+        ExpectSame(XusbReport{
+            static_cast<uint16_t>(word(rng)),
+            static_cast<uint8_t>(byte(rng)),
+            static_cast<uint8_t>(byte(rng)),
+            static_cast<int16_t>(word(rng)),
+            static_cast<int16_t>(word(rng)),
+            static_cast<int16_t>(word(rng)),
+            static_cast<int16_t>(word(rng))});
+        if (HasFatalFailure()) {
+            return;
+        }
+    }
+}
+
+TEST(Ds4Translation, BatchMatchesSingle)
+{
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> word(INT16_MIN, INT16_MAX);
+    std::vector<XusbReport> in(257);
+    for (auto& report : in) {
+        report = XusbReport{static_cast<uint16_t>(word(rng)), static_cast<uint8_t>(word(rng)), static_cast<uint8_t>(word(rng)),
+                            static_cast<int16_t>(word(rng)), static_cast<int16_t>(word(rng)), static_cast<int16_t>(word(rng)), static_cast<int16_t>(word(rng))};
+    }
+    std::vector<Ds4Report> out(in.size());
+    Ds4Translation::Translate(in.data(), out.data(), in.size());
+    for (size_t i = 0; i < in.size(); i++) {
+        const auto expected = ViGEmDs4Reference::Translate(in[i]);
+        EXPECT_EQ(std::memcmp(&out[i], &expected, sizeof(Ds4Report)), 0) << "report " << i;
+    }
+}
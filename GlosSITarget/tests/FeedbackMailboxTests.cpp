@@ -0,0 +1,165 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "FeedbackMailbox.h"
+
+namespace {
+
+// Spreads a sequence number over the fields, so torn or reordered states show up
+Feedback::State Numbered(uint32_t n)
+{
+    Feedback::State state;
+    state.large_motor = static_cast<uint8_t>(n);
+    state.small_motor = static_cast<uint8_t>(n >> 8);
+    state.lightbar_red = static_cast<uint8_t>(n >> 16);
+    state.lightbar_green = static_cast<uint8_t>(n >> 24);
+    state.lightbar_blue = static_cast<uint8_t>(~n);
+    state.led_number = static_cast<uint8_t>(n % 4);
+    state.has_lightbar = n & 1;
+    return state;
+}
+
+uint32_t Number(const Feedback::State& state)
+{
+    return uint32_t{state.large_motor}
+           | uint32_t{state.small_motor} << 8
+           | uint32_t{state.lightbar_red} << 16
+           | uint32_t{state.lightbar_green} << 24;
+}
+
+bool Consistent(const Feedback::State& state)
+{
+    const auto n = Number(state);
+    return state.lightbar_blue == static_cast<uint8_t>(~n)
+           && state.led_number == n % 4
+           && state.has_lightbar == static_cast<bool>(n & 1);
+}
+
+} // namespace
+
+TEST(FeedbackMailbox, EmptyTakesNothing)
+{
+    Feedback::Mailbox mailbox;
+    EXPECT_FALSE(mailbox.take().has_value());
+}
+
+TEST(FeedbackMailbox, RoundTripsEveryField)
+{
+    Feedback::Mailbox mailbox;
+    Feedback::State state;
+    state.large_motor = 0xFF;
+    state.small_motor = 0x80;
+    state.led_number = 3;
+    state.has_lightbar = true;
+    state.lightbar_red = 0x12;
+    state.lightbar_green = 0x34;
+    state.lightbar_blue = 0xFE;
+    EXPECT_FALSE(mailbox.push(state));
+
+    const auto taken = mailbox.take();
+    ASSERT_TRUE(taken.has_value());
+    EXPECT_EQ(taken->large_motor, 0xFF);
+    EXPECT_EQ(taken->small_motor, 0x80);
+    EXPECT_EQ(taken->led_number, 3);
+    EXPECT_TRUE(taken->has_lightbar);
+    EXPECT_EQ(taken->lightbar_red, 0x12);
+    EXPECT_EQ(taken->lightbar_green, 0x34);
+    EXPECT_EQ(taken->lightbar_blue, 0xFE);
+}
+
+TEST(FeedbackMailbox, LatestPushWins)
+{
+    Feedback::Mailbox mailbox;
+    EXPECT_FALSE(mailbox.push(Numbered(1)));
+    EXPECT_TRUE(mailbox.push(Numbered(2)));
+    EXPECT_TRUE(mailbox.push(Numbered(3)));
+
+    const auto taken = mailbox.take();
+    ASSERT_TRUE(taken.has_value());
+    EXPECT_EQ(Number(*taken), 3u);
+    EXPECT_FALSE(mailbox.take().has_value());
+    // taken states aren't reported as coalesced
+    EXPECT_FALSE(mailbox.push(Numbered(4)));
+}
+
+TEST(FeedbackMailbox, PeekKeepsTakenState)
+{
+    Feedback::Mailbox mailbox;
+    mailbox.push(Numbered(42));
+    EXPECT_EQ(Number(mailbox.peek()), 42u);
+    ASSERT_TRUE(mailbox.take().has_value());
+    EXPECT_EQ(Number(mailbox.peek()), 42u);
+    EXPECT_FALSE(mailbox.take().has_value());
+}
+
+TEST(FeedbackMailbox, ResetForgetsPendingAndLastState)
+{
+    Feedback::Mailbox mailbox;
+    mailbox.push(Numbered(42));
+    mailbox.reset();
+    EXPECT_FALSE(mailbox.take().has_value());
+    EXPECT_EQ(Number(mailbox.peek()), 0u);
+    // usable again afterwards; nothing counts as replaced
+    EXPECT_FALSE(mailbox.push(Numbered(7)));
+    EXPECT_EQ(Number(mailbox.take().value()), 7u);
+}
+
+TEST(FeedbackMailbox, ConcurrentPushesArriveInOrder)
+{
+    constexpr uint32_t PUSHES = 1'000'000;
+    Feedback::Mailbox mailbox;
+    std::atomic<bool> done = false;
+    uint64_t coalesced = 0;
+
+    std::thread producer([&] {
+        for (uint32_t n = 1; n <= PUSHES; n++) {
+            coalesced += mailbox.push(Numbered(n));
+        }
+        done = true;
+    });
+
+    uint64_t taken = 0;
+    uint32_t last = 0;
+    bool ordered = true;
+    bool consistent = true;
+    const auto consume = [&](const Feedback::State& state) {
+        taken++;
+        consistent &= Consistent(state);
+        // a state must never be seen twice or after a newer one
+        ordered &= Number(state) > last;
+        last = Number(state);
+    };
+    while (!done) {
+        if (const auto state = mailbox.take()) {
+            consume(*state);
+        }
+    }
+    producer.join();
+    if (const auto state = mailbox.take()) {
+        consume(*state);
+    }
+
+    EXPECT_TRUE(ordered);
+    EXPECT_TRUE(consistent);
+    EXPECT_EQ(last, PUSHES);
+    // every push is either taken or overwritten, never lost
+    EXPECT_EQ(taken + coalesced, PUSHES);
+}
@@ -0,0 +1,159 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include "FrameScheduler.h"
+#include "VirtualTickClock.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+const auto ACTIVE_PERIOD = FrameScheduler::PeriodFromRate(60);
+const auto IDLE_PERIOD = FrameScheduler::PeriodFromRate(10);
+
+// Frame time of one waitForNextFrame call without any work in between
+TickClock::duration Frame(FrameScheduler& scheduler, VirtualTickClock& clock)
+{
+    const auto start = clock.now();
+    scheduler.waitForNextFrame();
+    return clock.now() - start;
+}
+
+} // namespace
+
+TEST(FrameScheduler, RunsAtActiveRate)
+{
+    VirtualTickClock clock;
+    FrameScheduler scheduler(clock, {60, 10, 1s});
+    const auto start = clock.now();
+    for (int i = 0; i < 600; i++) {
+        scheduler.waitForNextFrame();
+        EXPECT_FALSE(scheduler.isIdle());
+    }
+    EXPECT_EQ(clock.now() - start, ACTIVE_PERIOD * 600);
+    EXPECT_EQ(scheduler.currentFps(), 60u);
+}
+
+TEST(FrameScheduler, WorkDoesNotDelayFrames)
+{
+    VirtualTickClock clock;
+    FrameScheduler scheduler(clock, {60, 10, 1s});
+    const auto start = clock.now();
+    for (int i = 0; i < 60; i++) {
+        clock.advance(5ms);
+        scheduler.waitForNextFrame();
+    }
+    EXPECT_EQ(clock.now() - start, ACTIVE_PERIOD * 60);
+}
+
+TEST(FrameScheduler, DropsToIdleRate)
+{
+    VirtualTickClock clock;
+    FrameScheduler scheduler(clock, {60, 10, 1s});
+    scheduler.setActive(false);
+    EXPECT_EQ(Frame(scheduler, clock), IDLE_PERIOD);
+    EXPECT_TRUE(scheduler.isIdle());
+    EXPECT_EQ(scheduler.currentFps(), 10u);
+
+    // becoming active again cuts the idle frame short
+    scheduler.setActive(true);
+    EXPECT_EQ(Frame(scheduler, clock), ACTIVE_PERIOD);
+    EXPECT_FALSE(scheduler.isIdle());
+    EXPECT_EQ(scheduler.currentFps(), 60u);
+}
+
+TEST(FrameScheduler, WakeHoldsActiveRate)
+{
+    VirtualTickClock clock;
+    FrameScheduler scheduler(clock, {60, 10, 1s});
+    scheduler.setActive(false);
+    Frame(scheduler, clock);
+    ASSERT_TRUE(scheduler.isIdle());
+
+    scheduler.wake();
+    const auto woken = clock.now();
+    EXPECT_EQ(Frame(scheduler, clock), ACTIVE_PERIOD);
+    TickClock::duration last{};
+    while (!scheduler.isIdle()) {
+        last = Frame(scheduler, clock);
+        if (!scheduler.isIdle()) {
+            EXPECT_EQ(last, ACTIVE_PERIOD);
+        }
+        ASSERT_LT(clock.now() - woken, 2s);
+    }
+    // idle is decided at the start of the frame that ends the hold
+    EXPECT_EQ(last, IDLE_PERIOD);
+    const auto held = clock.now() - woken - IDLE_PERIOD;
+    EXPECT_GE(held, 1s);
+    EXPECT_LT(held, 1s + ACTIVE_PERIOD);
+}
+
+TEST(FrameScheduler, WakeCutsIdleSleepShort)
+{
+    VirtualTickClock clock;
+    FrameScheduler scheduler(clock, {60, 10, 1s});
+    scheduler.setActive(false);
+    Frame(scheduler, clock);
+    ASSERT_TRUE(scheduler.isIdle());
+
+    // the active frame time has already passed; render right away
+    const auto start = clock.now();
+    clock.at(start + 30ms, [&scheduler] { scheduler.wake(); });
+    scheduler.waitForNextFrame();
+    EXPECT_EQ(clock.now() - start, 30ms);
+    EXPECT_FALSE(scheduler.isIdle());
+    EXPECT_EQ(scheduler.currentFps(), 60u);
+    EXPECT_EQ(Frame(scheduler, clock), ACTIVE_PERIOD);
+}
+
+TEST(FrameScheduler, WakeDuringIdleSleepKeepsActiveRate)
+{
+    VirtualTickClock clock;
+    FrameScheduler scheduler(clock, {60, 10, 1s});
+    scheduler.setActive(false);
+    Frame(scheduler, clock);
+
+    // too early for the next active frame; wait for it instead of the idle one
+    const auto start = clock.now();
+    clock.at(start + 5ms, [&scheduler] { scheduler.wake(); });
+    scheduler.waitForNextFrame();
+    EXPECT_EQ(clock.now() - start, ACTIVE_PERIOD);
+    EXPECT_FALSE(scheduler.isIdle());
+}
+
+TEST(FrameScheduler, StagesCountOverBudget)
+{
+    VirtualTickClock clock;
+    FrameScheduler scheduler(clock, {60, 10, 1s});
+    auto& stage = scheduler.addStage("Render", 4ms);
+    auto& shared = scheduler.addStage("Overlay");
+    EXPECT_EQ(scheduler.budget(shared), ACTIVE_PERIOD);
+    for (const auto took : {1ms, 3ms, 5ms, 20ms}) {
+        auto timer = scheduler.time(stage);
+        auto shared_timer = scheduler.time(shared);
+        clock.advance(took);
+    }
+    EXPECT_EQ(stage.histogram.summary().count, 4u);
+    EXPECT_EQ(stage.over_budget, 2u);
+    EXPECT_EQ(shared.over_budget, 1u);
+
+    scheduler.resetStats();
+    EXPECT_EQ(stage.histogram.summary().count, 0u);
+    EXPECT_EQ(stage.over_budget, 0u);
+}
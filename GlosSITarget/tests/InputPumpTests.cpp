@@ -0,0 +1,146 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "InputPump.h"
+#include "VirtualTickClock.h"
+
+using namespace std::chrono_literals;
+
+TEST(TickClock, CoarseTimeoutRoundsUp)
+{
+    EXPECT_EQ(TickClock::CoarseTimeout(0ns), 0ms);
+    EXPECT_EQ(TickClock::CoarseTimeout(1ns), 1ms);
+    EXPECT_EQ(TickClock::CoarseTimeout(999us), 1ms);
+    EXPECT_EQ(TickClock::CoarseTimeout(1ms), 1ms);
+    EXPECT_EQ(TickClock::CoarseTimeout(1001us), 2ms);
+    EXPECT_EQ(TickClock::CoarseTimeout(-5ms), 0ms);
+}
+
+TEST(TickClock, SteadyWakeInterruptsSleep)
+{
+    SteadyTickClock clock;
+    std::thread waker([&clock] {
+        std::this_thread::sleep_for(20ms);
+        clock.wake();
+    });
+    const auto start = clock.now();
+    clock.sleepUntil(start + 10s);
+    EXPECT_LT(clock.now() - start, 5s);
+    waker.join();
+}
+
+TEST(TickClock, SteadyPendingWakeSkipsNextSleep)
+{
+    SteadyTickClock clock;
+    clock.wake();
+    const auto start = clock.now();
+    clock.sleepUntil(start + 10s);
+    EXPECT_LT(clock.now() - start, 5s);
+}
+
+TEST(InputPump, FixedRateDoesNotDrift)
+{
+    VirtualTickClock clock;
+    InputPump::FixedRatePump pump(clock, 250);
+    const auto start = clock.now();
+    for (int i = 0; i < 1000; i++) {
+        // polling itself takes time; that must not add up
+        clock.advance(1ms);
+        pump.wait(true);
+    }
+    EXPECT_EQ(clock.now() - start, 4s);
+}
+
+TEST(InputPump, FixedRateDoesNotCatchUp)
+{
+    VirtualTickClock clock;
+    InputPump::FixedRatePump pump(clock, 100);
+    clock.advance(1s);
+    pump.wait(false);
+    // the missed ticks are dropped; the next one is due one period after the late one
+    const auto late = clock.now();
+    pump.wait(false);
+    EXPECT_EQ(clock.now() - late, 10ms);
+}
+
+TEST(InputPump, ChangeDrivenIdlesAndRecovers)
+{
+    VirtualTickClock clock;
+    InputPump::ChangeDrivenPump pump(clock, 100, 10, 1s);
+    // idle is decided before sleeping; after 1s of polling at 100Hz, it takes one more
+    for (int i = 0; i <= 100; i++) {
+        pump.wait(false);
+    }
+    EXPECT_TRUE(pump.isIdle());
+    const auto idle_start = clock.now();
+    pump.wait(false);
+    EXPECT_EQ(clock.now() - idle_start, 100ms);
+
+    // first change polls again right away, then at full rate
+    clock.advance(30ms);
+    const auto change = clock.now();
+    pump.wait(true);
+    EXPECT_FALSE(pump.isIdle());
+    EXPECT_EQ(clock.now() - change, 10ms);
+}
+
+TEST(InputPump, ChangeDrivenStaysActiveWhileInputChanges)
+{
+    VirtualTickClock clock;
+    InputPump::ChangeDrivenPump pump(clock, 100, 10, 1s);
+    for (int i = 0; i < 1000; i++) {
+        pump.wait(i % 50 == 0);
+        EXPECT_FALSE(pump.isIdle());
+    }
+}
+
+TEST(InputPump, WakeCutsSleepShort)
+{
+    VirtualTickClock clock;
+    InputPump::FixedRatePump pump(clock, 10);
+    const auto start = clock.now();
+    clock.wake();
+    pump.wait(false);
+    EXPECT_EQ(clock.now(), start);
+}
+
+TEST(InputPump, WakeReanchorsDeadline)
+{
+    VirtualTickClock clock;
+    InputPump::FixedRatePump pump(clock, 10);
+    const auto start = clock.now();
+    pump.wait(false);
+    ASSERT_EQ(clock.now(), start + 100ms);
+    clock.at(start + 130ms, [&clock] { clock.wake(); });
+    pump.wait(false);
+    ASSERT_EQ(clock.now(), start + 130ms);
+    // the early poll counts as the one that was due; no tick gets skipped, none gets squeezed in
+    pump.wait(false);
+    EXPECT_EQ(clock.now(), start + 230ms);
+    pump.wait(false);
+    EXPECT_EQ(clock.now(), start + 330ms);
+}
+
+TEST(InputPump, CreateHonorsIdleThrottle)
+{
+    VirtualTickClock clock;
+    EXPECT_NE(dynamic_cast<InputPump::FixedRatePump*>(InputPump::Create(clock, 144, false, 30).get()), nullptr);
+    EXPECT_NE(dynamic_cast<InputPump::ChangeDrivenPump*>(InputPump::Create(clock, 144, true, 30).get()), nullptr);
+}
@@ -0,0 +1,276 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "InputRecording.h"
+#include "MappedFile.h"
+#include "TempFiles.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+Ds4Translation::XusbReport Buttons(uint16_t buttons)
+{
+    Ds4Translation::XusbReport report{};
+    report.wButtons = buttons;
+    return report;
+}
+
+bool SameReport(const Ds4Translation::XusbReport& a, const Ds4Translation::XusbReport& b)
+{
+    return a.wButtons == b.wButtons && a.bLeftTrigger == b.bLeftTrigger && a.bRightTrigger == b.bRightTrigger
+           && a.sThumbLX == b.sThumbLX && a.sThumbLY == b.sThumbLY && a.sThumbRX == b.sThumbRX && a.sThumbRY == b.sThumbRY;
+}
+
+std::vector<ReplayFrame> ReadAll(ReplayStream& stream)
+{
+    std::vector<ReplayFrame> frames;
+    ReplayFrame frame;
+    while (stream.next(frame)) {
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+// Random walk over a few pads; every field changes now and then, pads (dis)connect now and then
+std::vector<ReplayFrame> RandomFrames(size_t count, size_t pads)
+{
+    std::mt19937 rng(1234);
+    std::vector<ReplayFrame> frames;
+    std::vector<ReplayFrame> last(pads);
+    TickClock::duration at{};
+    for (size_t i = 0; i < count; i++) {
+        at += std::chrono::microseconds(rng() % 20000);
+        const auto pad = static_cast<uint32_t>(rng() % pads);
+        auto frame = last[pad];
+        frame.pad = pad;
+        frame.at = at;
+        auto& g = frame.gamepad;
+        switch (rng() % 9) {
+        case 0:
+            g.wButtons = static_cast<uint16_t>(rng());
+            break;
+        case 1:
+            g.bLeftTrigger = static_cast<uint8_t>(rng());
+            break;
+        case 2:
+            g.bRightTrigger = static_cast<uint8_t>(rng());
+            break;
+        case 3:
+            g.sThumbLX = static_cast<int16_t>(rng());
+            break;
+        case 4:
+            g.sThumbLY = static_cast<int16_t>(rng());
+            break;
+        case 5:
+            g.sThumbRX = static_cast<int16_t>(rng());
+            break;
+        case 6:
+            g.sThumbRY = static_cast<int16_t>(rng());
+            break;
+        case 7:
+            frame.connected = !frame.connected;
+            break;
+        default:
+            // several fields at once
+            g = {};
+            g.wButtons = static_cast<uint16_t>(rng());
+            g.sThumbRY = static_cast<int16_t>(rng());
+            break;
+        }
+        frames.push_back(frame);
+        last[frame.pad] = frame;
+    }
+    return frames;
+}
+
+using InputRecordingTest = TempFiles;
+using MappedFileTest = TempFiles;
+
+} // namespace
+
+TEST_F(InputRecordingTest, RoundTrip)
+{
+    constexpr size_t PADS = 4;
+    const auto path = tempFile("glossi_recording_roundtrip.gsir");
+    // large enough to flush several times and span many pages
+    const auto written = RandomFrames(50000, PADS);
+    const auto start = TickClock::clock::now();
+    {
+        InputRecording::Writer writer(path, PADS);
+        ASSERT_TRUE(writer.isOpen());
+        for (const auto& frame : written) {
+            writer.append(start + frame.at, frame.pad, frame.connected, frame.gamepad);
+        }
+    }
+    ASSERT_GT(std::filesystem::file_size(path), 64u * 1024);
+
+    InputRecording::Reader reader(path);
+    ASSERT_TRUE(reader.isValid());
+    EXPECT_EQ(reader.padCount(), PADS);
+    const auto read = ReadAll(reader);
+
+    // disconnected pads aren't recorded again until they reconnect, so compare against the deduplicated input
+    std::vector<ReplayFrame> expected;
+    std::vector<ReplayFrame> last(PADS);
+    for (auto& frame : last) {
+        frame.connected = false;
+    }
+    for (auto frame : written) {
+        auto& prev = last[frame.pad];
+        const bool changed = frame.connected != prev.connected || (frame.connected && !SameReport(frame.gamepad, prev.gamepad));
+        if (!changed) {
+            continue;
+        }
+        if (!frame.connected) {
+            // disconnect records carry the pad's last connected state
+            frame.gamepad = prev.gamepad;
+        }
+        prev = frame;
+        expected.push_back(frame);
+    }
+    ASSERT_EQ(read.size(), expected.size());
+    const auto first = expected.front().at;
+    for (size_t i = 0; i < read.size(); i++) {
+        ASSERT_EQ(read[i].pad, expected[i].pad) << i;
+        ASSERT_EQ(read[i].connected, expected[i].connected) << i;
+        ASSERT_EQ(read[i].at, expected[i].at - first) << i;
+        ASSERT_TRUE(SameReport(read[i].gamepad, expected[i].gamepad)) << i;
+    }
+}
+
+TEST_F(InputRecordingTest, OnlyChangesAreWritten)
+{
+    const auto path = tempFile("glossi_recording_changes.gsir");
+    {
+        InputRecording::Writer writer(path, 1);
+        const auto now = TickClock::clock::now();
+        writer.append(now, 0, true, Buttons(0x10));
+        for (int i = 0; i < 100; i++) {
+            writer.append(now + std::chrono::milliseconds(i), 0, true, Buttons(0x10));
+        }
+        // pad out of range
+        writer.append(now, 1, true, Buttons(0x20));
+    }
+    // header + one record: 6 byte record header + buttons
+    EXPECT_EQ(std::filesystem::file_size(path), sizeof(InputRecording::FileHeader) + sizeof(InputRecording::RecordHeader) + 2);
+}
+
+TEST_F(InputRecordingTest, RewindReplaysFromStart)
+{
+    const auto path = tempFile("glossi_recording_rewind.gsir");
+    {
+        InputRecording::Writer writer(path, 1);
+        const auto now = TickClock::clock::now();
+        for (uint16_t i = 1; i <= 10; i++) {
+            writer.append(now + std::chrono::milliseconds(i), 0, true, Buttons(i));
+        }
+    }
+    InputRecording::Reader reader(path);
+    const auto first = ReadAll(reader);
+    reader.rewind();
+    const auto second = ReadAll(reader);
+    ASSERT_EQ(first.size(), 10u);
+    ASSERT_EQ(second.size(), first.size());
+    for (size_t i = 0; i < first.size(); i++) {
+        EXPECT_EQ(second[i].at, first[i].at);
+        EXPECT_EQ(second[i].gamepad.wButtons, first[i].gamepad.wButtons);
+    }
+    EXPECT_EQ(first.back().at, 9ms);
+}
+
+TEST_F(InputRecordingTest, TruncatedRecordStopsPlayback)
+{
+    const auto path = tempFile("glossi_recording_truncated.gsir");
+    {
+        InputRecording::Writer writer(path, 1);
+        const auto now = TickClock::clock::now();
+        writer.append(now, 0, true, Buttons(0x1));
+        writer.append(now + 1ms, 0, true, Buttons(0x2));
+    }
+    // cut the buttons of the last record in half
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+
+    InputRecording::Reader reader(path);
+    ASSERT_TRUE(reader.isValid());
+    const auto frames = ReadAll(reader);
+    ASSERT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0].gamepad.wButtons, 0x1);
+    ReplayFrame frame;
+    EXPECT_FALSE(reader.next(frame));
+}
+
+TEST_F(InputRecordingTest, RejectsForeignFiles)
+{
+    EXPECT_FALSE(InputRecording::Reader(tempFile("glossi_recording_missing.gsir")).isValid());
+
+    const auto path = tempFile("glossi_recording_foreign.gsir");
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "not a recording";
+    }
+    InputRecording::Reader reader(path);
+    EXPECT_FALSE(reader.isValid());
+    ReplayFrame frame;
+    EXPECT_FALSE(reader.next(frame));
+
+    {
+        InputRecording::FileHeader header{{'G', 'S', 'I', 'R'}, InputRecording::VERSION + 1, 1};
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    EXPECT_FALSE(InputRecording::Reader(path).isValid());
+}
+
+TEST_F(MappedFileTest, MapsWholeFile)
+{
+    const auto path = tempFile("glossi_mapped_file.bin");
+    std::vector<uint8_t> content(3 * 4096 + 17);
+    for (size_t i = 0; i < content.size(); i++) {
+        content[i] = static_cast<uint8_t>(i * 7);
+    }
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(content.data()), static_cast<std::streamsize>(content.size()));
+    }
+    MappedFile mapped(path);
+    ASSERT_NE(mapped.data(), nullptr);
+    ASSERT_EQ(mapped.size(), content.size());
+    EXPECT_TRUE(std::equal(content.begin(), content.end(), mapped.data()));
+}
+
+TEST_F(MappedFileTest, EmptyOrMissingFileMapsNothing)
+{
+    const auto path = tempFile("glossi_mapped_empty.bin");
+    std::ofstream(path, std::ios::binary).close();
+    MappedFile empty(path);
+    EXPECT_EQ(empty.data(), nullptr);
+    EXPECT_EQ(empty.size(), 0u);
+    std::filesystem::remove(path);
+
+    MappedFile missing(path);
+    EXPECT_EQ(missing.data(), nullptr);
+    EXPECT_EQ(missing.size(), 0u);
+}
@@ -0,0 +1,103 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+#include "HttpServer.h"
+#include "InputRecording.h"
+#include "InputRedirector.h"
+#include "StubPadSink.h"
+#include "../common/Settings.h"
+
+// HttpServer.cpp needs the real server; the redirector only registers its endpoints
+void HttpServer::AddEndpoint(const Endpoint&&)
+{
+}
+
+namespace {
+
+constexpr size_t FRAMES = 2000;
+
+// Every pad changes every frame, so each tick polls, translates and submits all of them
+std::filesystem::path WriteRecording(size_t pads)
+{
+    const auto path = std::filesystem::temp_directory_path() / ("glossi_redirector_bench_" + std::to_string(pads) + ".gsir");
+    InputRecording::Writer writer(path, pads);
+    auto time = TickClock::clock::now();
+    for (size_t frame = 0; frame < FRAMES; frame++) {
+        for (size_t pad = 0; pad < pads; pad++) {
+            Ds4Translation::XusbReport report{};
+            report.wButtons = static_cast<uint16_t>(frame);
+            report.sThumbLX = static_cast<int16_t>(frame * 31 + pad);
+            report.bRightTrigger = static_cast<uint8_t>(frame + pad);
+            writer.append(time, static_cast<uint32_t>(pad), true, report);
+        }
+        time += std::chrono::milliseconds(1);
+    }
+    return path;
+}
+
+} // namespace
+
+// Time per runLoop tick with N pads attached; should grow linearly with the pad count
+static void BM_RedirectorTick(benchmark::State& state)
+{
+    const auto pads = static_cast<size_t>(state.range(0));
+    const auto path = WriteRecording(pads);
+    const auto saved_controller = Settings::controller;
+    Settings::controller.inputBackend = "Replay";
+    Settings::controller.replayFile = path.wstring();
+    Settings::controller.replayMaxSpeed = true;
+    Settings::controller.replayLoop = false;
+    Settings::controller.maxControllers = static_cast<int>(pads);
+    Settings::controller.keepaliveMs = 0;
+
+    size_t ticks = 0;
+    for (auto _ : state) {
+        StubPadSink::Options options;
+        options.max_recorded_submissions = pads * FRAMES;
+        auto sink = std::make_unique<StubPadSink>(options);
+        auto& stub = *sink;
+
+        InputRedirector redirector(std::move(sink));
+        redirector.run();
+        // the first frame only plugs the pads
+        const auto expected = pads * (FRAMES - 1);
+        const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (stub.counters().submits < expected && std::chrono::steady_clock::now() < until) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        redirector.stop();
+
+        const auto submissions = stub.submissions();
+        if (submissions.size() < expected) {
+            state.SkipWithError("redirector did not submit every frame");
+            break;
+        }
+        ticks = submissions.size() / pads - 1;
+        const auto elapsed = std::chrono::duration<double>(submissions.back().at - submissions.front().at);
+        state.SetIterationTime(elapsed.count() / static_cast<double>(ticks));
+    }
+    state.counters["pads"] = static_cast<double>(pads);
+    state.counters["ticks"] = static_cast<double>(ticks);
+    Settings::controller = saved_controller;
+    std::filesystem::remove(path);
+}
+// each iteration includes runLoop's start delay, so keep it to one
+BENCHMARK(BM_RedirectorTick)->RangeMultiplier(2)->Range(1, 16)->Iterations(1)->UseManualTime()->Unit(benchmark::kNanosecond);
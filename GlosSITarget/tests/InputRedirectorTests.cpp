@@ -0,0 +1,312 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "HttpServer.h"
+#include "InputRecording.h"
+#include "InputRedirector.h"
+#include "ReplayInputSource.h"
+#include "StubPadSink.h"
+#include "TempFiles.h"
+#include "VirtualTickClock.h"
+#include "../common/Settings.h"
+
+// HttpServer.cpp needs the real server; the redirector only registers its endpoints
+void HttpServer::AddEndpoint(const Endpoint&&)
+{
+}
+
+namespace {
+
+Ds4Translation::XusbReport Buttons(uint16_t buttons)
+{
+    Ds4Translation::XusbReport report{};
+    report.wButtons = buttons;
+    return report;
+}
+
+void UseRecording(const std::filesystem::path& path, bool loop)
+{
+    Settings::controller.inputBackend = "Replay";
+    Settings::controller.replayFile = path.wstring();
+    Settings::controller.replayMaxSpeed = true;
+    Settings::controller.replayLoop = loop;
+    Settings::controller.maxControllers = 1;
+    Settings::controller.keepaliveMs = 0;
+}
+
+// runLoop waits for Steam before doing anything; give it some leeway on top
+bool WaitFor(const std::function<bool()>& condition, std::chrono::milliseconds timeout = std::chrono::milliseconds(5000))
+{
+    const auto until = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < until) {
+        if (condition()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return condition();
+}
+
+// One frame per millisecond on pad 0; every frame bumps the packet number, even if the report stays the same
+std::vector<ReplayFrame> EveryMs(const std::vector<uint16_t>& buttons)
+{
+    std::vector<ReplayFrame> frames;
+    for (size_t i = 0; i < buttons.size(); i++) {
+        frames.push_back({std::chrono::milliseconds(i), 0, true, Buttons(buttons[i])});
+    }
+    return frames;
+}
+
+// Parks the controller thread once virtual time reaches `when`, so a test can look at a fixed point in time
+class PauseAt {
+  public:
+    PauseAt(VirtualTickClock& clock, TickClock::time_point when)
+    {
+        clock.at(when, [this] {
+            reached_ = true;
+            while (!resumed_) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    }
+
+    bool waitReached()
+    {
+        return WaitFor([this] { return reached_.load(); });
+    }
+
+    // has to happen before InputRedirector::stop()
+    void resume()
+    {
+        resumed_ = true;
+    }
+
+  private:
+    std::atomic<bool> reached_ = false;
+    std::atomic<bool> resumed_ = false;
+};
+
+// Polls at 1000Hz on a virtual clock; ticks (and submissions) happen on exact milliseconds
+struct VirtualPipeline {
+    explicit VirtualPipeline(const std::vector<uint16_t>& buttons)
+    {
+        Settings::controller.maxControllers = 1;
+        Settings::controller.updateRate = 1000;
+        Settings::controller.idleThrottle = false;
+        auto virtual_clock = std::make_unique<VirtualTickClock>();
+        clock = virtual_clock.get();
+        StubPadSink::Options options;
+        options.clock = clock;
+        auto sink = std::make_unique<StubPadSink>(options);
+        stub = sink.get();
+        redirector = std::make_unique<InputRedirector>(
+            std::move(sink),
+            std::move(virtual_clock),
+            std::make_unique<ReplayInputSource>(*clock, EveryMs(buttons)));
+    }
+
+    TickClock::time_point start() const
+    {
+        return TickClock::time_point{};
+    }
+
+    VirtualTickClock* clock = nullptr;
+    StubPadSink* stub = nullptr;
+    std::unique_ptr<InputRedirector> redirector;
+};
+
+// Settings::controller is global; every test gets it back the way it found it
+class InputRedirectorTest : public TempFiles {
+  protected:
+    void SetUp() override
+    {
+        saved_controller_ = Settings::controller;
+    }
+
+    void TearDown() override
+    {
+        Settings::controller = saved_controller_;
+        TempFiles::TearDown();
+    }
+
+    // Replays states (one per tick) on pad 0
+    std::filesystem::path writeRecording(const char* name, const std::vector<uint16_t>& buttons)
+    {
+        const auto path = tempFile(name);
+        InputRecording::Writer writer(path, 1);
+        auto time = TickClock::clock::now();
+        for (const auto b : buttons) {
+            writer.append(time, 0, true, Buttons(b));
+            time += std::chrono::milliseconds(1);
+        }
+        return path;
+    }
+
+  private:
+    decltype(Settings::controller) saved_controller_;
+};
+
+} // namespace
+
+TEST_F(InputRedirectorTest, SkipsUnchangedReports)
+{
+    Settings::controller.keepaliveMs = 0;
+    // tick 0 plugs the pad; from then on only ticks with a different report submit
+    VirtualPipeline pipeline({0x1, 0x1, 0x1, 0x2, 0x2, 0x4});
+    PauseAt pause(*pipeline.clock, pipeline.start() + std::chrono::seconds(1));
+    pipeline.redirector->run();
+    const bool reached = pause.waitReached();
+    const auto submissions = pipeline.stub->submissions();
+    pause.resume();
+    pipeline.redirector->stop();
+
+    ASSERT_TRUE(reached);
+    ASSERT_EQ(submissions.size(), 3u);
+    EXPECT_EQ(submissions[0].report.wButtons, 0x1);
+    EXPECT_EQ(submissions[0].at, pipeline.start() + std::chrono::milliseconds(1));
+    EXPECT_EQ(submissions[1].report.wButtons, 0x2);
+    EXPECT_EQ(submissions[1].at, pipeline.start() + std::chrono::milliseconds(3));
+    EXPECT_EQ(submissions[2].report.wButtons, 0x4);
+    EXPECT_EQ(submissions[2].at, pipeline.start() + std::chrono::milliseconds(5));
+}
+
+TEST_F(InputRedirectorTest, KeepaliveResendsUnchangedReport)
+{
+    Settings::controller.keepaliveMs = 50;
+    VirtualPipeline pipeline({0x1, 0x2});
+    // paused right before the tick at 500ms
+    PauseAt pause(*pipeline.clock, pipeline.start() + std::chrono::milliseconds(500));
+    pipeline.redirector->run();
+    const bool reached = pause.waitReached();
+    const auto submissions = pipeline.stub->submissions();
+    pause.resume();
+    pipeline.redirector->stop();
+
+    ASSERT_TRUE(reached);
+    // 1ms, then every 50ms: 51, 101, ..., 451
+    ASSERT_EQ(submissions.size(), 10u);
+    for (size_t i = 0; i < submissions.size(); i++) {
+        EXPECT_EQ(submissions[i].report.wButtons, 0x2);
+        EXPECT_EQ(submissions[i].at, pipeline.start() + std::chrono::milliseconds(1 + 50 * i));
+    }
+}
+
+TEST_F(InputRedirectorTest, InputChangeRestartsKeepalive)
+{
+    Settings::controller.keepaliveMs = 50;
+    std::vector<uint16_t> buttons(31, 0x1);
+    buttons.push_back(0x2);
+    VirtualPipeline pipeline(buttons);
+    PauseAt pause(*pipeline.clock, pipeline.start() + std::chrono::milliseconds(100));
+    pipeline.redirector->run();
+    const bool reached = pause.waitReached();
+    const auto submissions = pipeline.stub->submissions();
+    pause.resume();
+    pipeline.redirector->stop();
+
+    ASSERT_TRUE(reached);
+    // the change at 31ms resets the keepalive; next one is due at 81ms, not at 51ms
+    ASSERT_EQ(submissions.size(), 3u);
+    EXPECT_EQ(submissions[0].at, pipeline.start() + std::chrono::milliseconds(1));
+    EXPECT_EQ(submissions[1].at, pipeline.start() + std::chrono::milliseconds(31));
+    EXPECT_EQ(submissions[1].report.wButtons, 0x2);
+    EXPECT_EQ(submissions[2].at, pipeline.start() + std::chrono::milliseconds(81));
+    EXPECT_EQ(submissions[2].report.wButtons, 0x2);
+}
+
+TEST_F(InputRedirectorTest, RetriesReportAfterFailedSubmit)
+{
+    // tick 1 plugs the pad, tick 2 submits 0x2, tick 3 submits 0x4 (which fails), then the input doesn't change anymore
+    UseRecording(writeRecording("glossi_redirector_retry.gsir", {0x1, 0x2, 0x4}), false);
+    auto sink = std::make_unique<StubPadSink>();
+    auto& stub = *sink;
+    stub.failNextSubmits(1, 1);
+
+    InputRedirector redirector(std::move(sink));
+    redirector.run();
+    const bool submitted = WaitFor([&stub] { return stub.counters().submits >= 2; });
+    redirector.stop();
+
+    ASSERT_TRUE(submitted);
+    EXPECT_EQ(stub.counters().submit_failures, 1u);
+    const auto submissions = stub.submissions();
+    ASSERT_EQ(submissions.size(), 2u);
+    EXPECT_EQ(submissions[0].report.wButtons, 0x2);
+    EXPECT_EQ(submissions[1].report.wButtons, 0x4);
+}
+
+TEST_F(InputRedirectorTest, ReplugsPadRemovedByBus)
+{
+    UseRecording(writeRecording("glossi_redirector_replug.gsir", {0x1, 0x2, 0x4, 0x8}), true);
+    auto sink = std::make_unique<StubPadSink>();
+    auto& stub = *sink;
+
+    InputRedirector redirector(std::move(sink));
+    redirector.run();
+    ASSERT_TRUE(WaitFor([&stub] { return stub.counters().submits >= 10; }));
+    ASSERT_TRUE(stub.removePad(0));
+    const auto before = stub.counters().submits;
+    const bool resumed = WaitFor([&stub, before] { return stub.counters().submits >= before + 10; });
+    redirector.stop();
+
+    EXPECT_TRUE(resumed);
+    const auto counters = stub.counters();
+    EXPECT_EQ(counters.removals, 1u);
+    EXPECT_EQ(counters.plugs, 2u);
+    EXPECT_EQ(counters.unplugs, 1u);
+}
+
+TEST(StubPadSink, KeepsLatestSubmissions)
+{
+    StubPadSink::Options options;
+    options.max_recorded_submissions = 4;
+    StubPadSink stub(options);
+    ASSERT_TRUE(stub.plug(0, {}, nullptr, nullptr));
+    for (uint16_t i = 0; i < 10; i++) {
+        ASSERT_TRUE(stub.submit(0, Buttons(i)));
+    }
+    const auto submissions = stub.submissions();
+    ASSERT_EQ(submissions.size(), 4u);
+    for (size_t i = 0; i < submissions.size(); i++) {
+        EXPECT_EQ(submissions[i].report.wButtons, 6 + i);
+    }
+    EXPECT_EQ(stub.counters().submits, 10u);
+}
+
+TEST(StubPadSink, InjectedFailures)
+{
+    StubPadSink stub;
+    ASSERT_TRUE(stub.plug(0, {}, nullptr, nullptr));
+    stub.failNextSubmits(2, 1);
+    EXPECT_TRUE(stub.submit(0, Buttons(1)));
+    EXPECT_FALSE(stub.submit(0, Buttons(1)));
+    EXPECT_FALSE(stub.submit(0, Buttons(1)));
+    EXPECT_TRUE(stub.submit(0, Buttons(1)));
+
+    EXPECT_TRUE(stub.removePad(0));
+    EXPECT_FALSE(stub.isPlugged(0));
+    EXPECT_FALSE(stub.submit(0, Buttons(1)));
+    EXPECT_FALSE(stub.unplug(0));
+    EXPECT_EQ(stub.counters().submit_failures, 3u);
+}
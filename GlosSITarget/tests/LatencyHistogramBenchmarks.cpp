@@ -0,0 +1,67 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "LatencyHistogram.h"
+
+namespace {
+
+// Poll latencies look like this: mostly a few hundred us, with a long tail
+std::vector<std::chrono::nanoseconds> Latencies()
+{
+    std::mt19937 rng(3);
+    std::lognormal_distribution<double> dist(12.5, 0.8);
+    std::vector<std::chrono::nanoseconds> latencies(4096);
+    for (auto& l : latencies) {
+        l = std::chrono::nanoseconds(static_cast<int64_t>(dist(rng)));
+    }
+    return latencies;
+}
+
+} // namespace
+
+// Has to stay well below 20ns; it's done on every controller poll
+static void BM_LatencyHistogramRecord(benchmark::State& state)
+{
+    static LatencyHistogram histogram;
+    const auto latencies = Latencies();
+    size_t i = 0;
+    for (auto _ : state) {
+        histogram.record(latencies[i++ & (latencies.size() - 1)]);
+    }
+    benchmark::DoNotOptimize(histogram.summary());
+}
+BENCHMARK(BM_LatencyHistogramRecord);
+// shared histogram, e.g. several pads of the input thread plus the overlay reading
+BENCHMARK(BM_LatencyHistogramRecord)->Threads(std::max(2u, std::thread::hardware_concurrency()));
+
+static void BM_LatencyHistogramSummary(benchmark::State& state)
+{
+    LatencyHistogram histogram;
+    for (const auto l : Latencies()) {
+        histogram.record(l);
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(histogram.summary());
+    }
+}
+BENCHMARK(BM_LatencyHistogramSummary);
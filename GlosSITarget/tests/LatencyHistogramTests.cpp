@@ -0,0 +1,175 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "LatencyHistogram.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Values right around every power of two, plus random ones
+std::vector<uint64_t> Samples()
+{
+    std::vector<uint64_t> values;
+    for (uint64_t bit = 0; bit < 64; bit++) {
+        const auto p = uint64_t{1} << bit;
+        values.push_back(p - 1);
+        values.push_back(p);
+        values.push_back(p + 1);
+    }
+    values.push_back(~uint64_t{0});
+    std::mt19937_64 rng(7);
+    for (int i = 0; i < 10000; i++) {
+        values.push_back(rng() >> (rng() % 64));
+    }
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+void ExpectNear(std::chrono::nanoseconds actual, std::chrono::nanoseconds expected)
+{
+    // one sub-bucket is 1/16 of its power of two
+    EXPECT_GE(actual, expected);
+    EXPECT_LE(actual.count(), expected.count() + expected.count() / 16) << "expected ~" << expected.count();
+}
+
+} // namespace
+
+TEST(LatencyHistogram, SmallValuesAreExact)
+{
+    for (uint64_t v = 0; v < 2 * LatencyHistogram::SUB_BUCKETS; v++) {
+        EXPECT_EQ(LatencyHistogram::BucketIndex(v), v);
+        EXPECT_EQ(LatencyHistogram::BucketUpperBound(v), v);
+    }
+}
+
+TEST(LatencyHistogram, BucketsCoverValues)
+{
+    size_t last_idx = 0;
+    for (const auto v : Samples()) {
+        const auto idx = LatencyHistogram::BucketIndex(v);
+        ASSERT_LT(idx, LatencyHistogram::BUCKET_COUNT);
+        ASSERT_GE(idx, last_idx) << v;
+        last_idx = idx;
+
+        const auto upper = LatencyHistogram::BucketUpperBound(idx);
+        ASSERT_LE(v, upper) << v;
+        if (idx > 0) {
+            const auto lower = LatencyHistogram::BucketUpperBound(idx - 1) + 1;
+            ASSERT_GE(v, lower) << v;
+            ASSERT_LE(upper - lower, lower / LatencyHistogram::SUB_BUCKETS) << v;
+        }
+    }
+}
+
+TEST(LatencyHistogram, BucketsAreContiguous)
+{
+    for (size_t idx = 1; idx < LatencyHistogram::BUCKET_COUNT; idx++) {
+        const auto next_value = LatencyHistogram::BucketUpperBound(idx - 1) + 1;
+        ASSERT_EQ(LatencyHistogram::BucketIndex(next_value), idx);
+        ASSERT_EQ(LatencyHistogram::BucketIndex(LatencyHistogram::BucketUpperBound(idx)), idx);
+    }
+}
+
+TEST(LatencyHistogram, EmptyReportsZero)
+{
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.percentile(50), 0ns);
+    const auto summary = histogram.summary();
+    EXPECT_EQ(summary.count, 0u);
+    EXPECT_EQ(summary.p99, 0ns);
+    EXPECT_EQ(summary.max, 0ns);
+}
+
+TEST(LatencyHistogram, Percentiles)
+{
+    LatencyHistogram histogram;
+    for (int i = 1; i <= 10000; i++) {
+        histogram.record(std::chrono::microseconds(i));
+    }
+    ExpectNear(histogram.percentile(50), 5000us);
+    ExpectNear(histogram.percentile(99), 9900us);
+    ExpectNear(histogram.percentile(0), 1us);
+    ExpectNear(histogram.percentile(100), 10000us);
+
+    const auto summary = histogram.summary();
+    EXPECT_EQ(summary.count, 10000u);
+    ExpectNear(summary.p50, 5000us);
+    ExpectNear(summary.p99, 9900us);
+    EXPECT_EQ(summary.max, 10000us);
+}
+
+TEST(LatencyHistogram, SummaryDoesNotExceedMax)
+{
+    LatencyHistogram histogram;
+    // 1000 shares a bucket with values up to 1023
+    histogram.record(1000ns);
+    ASSERT_GT(histogram.percentile(50), 1000ns);
+    const auto summary = histogram.summary();
+    EXPECT_EQ(summary.p50, 1000ns);
+    EXPECT_EQ(summary.p99, 1000ns);
+    EXPECT_EQ(summary.max, 1000ns);
+}
+
+TEST(LatencyHistogram, NegativeDurationsCountAsZero)
+{
+    LatencyHistogram histogram;
+    histogram.record(-5ms);
+    const auto summary = histogram.summary();
+    EXPECT_EQ(summary.count, 1u);
+    EXPECT_EQ(summary.max, 0ns);
+    EXPECT_EQ(histogram.percentile(100), 0ns);
+}
+
+TEST(LatencyHistogram, Reset)
+{
+    LatencyHistogram histogram;
+    histogram.record(1ms);
+    histogram.reset();
+    const auto summary = histogram.summary();
+    EXPECT_EQ(summary.count, 0u);
+    EXPECT_EQ(summary.max, 0ns);
+}
+
+TEST(LatencyHistogram, ConcurrentRecording)
+{
+    constexpr int THREADS = 4;
+    constexpr int RECORDS = 100000;
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([&histogram, t] {
+            for (int i = 0; i < RECORDS; i++) {
+                histogram.record(std::chrono::nanoseconds(i * THREADS + t));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const auto summary = histogram.summary();
+    EXPECT_EQ(summary.count, uint64_t{THREADS} * RECORDS);
+    EXPECT_EQ(summary.max, std::chrono::nanoseconds(THREADS * RECORDS - 1));
+    ExpectNear(summary.p50, std::chrono::nanoseconds(THREADS * RECORDS / 2));
+}
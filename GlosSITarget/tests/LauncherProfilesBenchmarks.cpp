@@ -0,0 +1,85 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <benchmark/benchmark.h>
+
+#include "LauncherProfiles.h"
+#include "SyntheticProcessTree.h"
+
+namespace {
+
+using namespace SyntheticProcessTree;
+
+LauncherProfiles::Matcher EpicMatcher()
+{
+    LauncherProfiles::Matcher matcher(LauncherProfiles::BuiltIn());
+    matcher.activate(L"com.epicgames.launcher://apps/Fortnite?action=launch");
+    return matcher;
+}
+
+} // namespace
+
+// classifying everything below the launcher, as AppLauncher does per tick; arg: background processes
+static void BM_LauncherIsLauncherCold(benchmark::State& state)
+{
+    const ProcessTree::Index tree(Desktop(static_cast<size_t>(state.range(0)), 16, 64));
+    auto matcher = EpicMatcher();
+    std::vector<ProcessTree::Pid> all;
+    tree.forEachDescendant(LAUNCHER, [&](ProcessTree::Pid pid) { all.push_back(pid); });
+    for (auto _ : state) {
+        for (const auto pid : all) {
+            matcher.forget(pid);
+            benchmark::DoNotOptimize(matcher.isLauncher(tree, pid));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * all.size()));
+}
+BENCHMARK(BM_LauncherIsLauncherCold)->Arg(100)->Arg(1000);
+
+static void BM_LauncherIsLauncherCached(benchmark::State& state)
+{
+    const ProcessTree::Index tree(Desktop(static_cast<size_t>(state.range(0)), 16, 64));
+    auto matcher = EpicMatcher();
+    std::vector<ProcessTree::Pid> all;
+    tree.forEachDescendant(LAUNCHER, [&](ProcessTree::Pid pid) { all.push_back(pid); });
+    for (auto _ : state) {
+        for (const auto pid : all) {
+            benchmark::DoNotOptimize(matcher.isLauncher(tree, pid));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * all.size()));
+}
+BENCHMARK(BM_LauncherIsLauncherCached)->Arg(100)->Arg(1000);
+
+// findLauncherPids while the launcher isn't running (yet): a full scan of the table
+static void BM_LauncherPidByName(benchmark::State& state)
+{
+    const ProcessTree::Index tree(Desktop(static_cast<size_t>(state.range(0))));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tree.pidByName(L"UbisoftConnect.exe"));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * tree.size()));
+}
+BENCHMARK(BM_LauncherPidByName)->Arg(100)->Arg(1000);
+
+static void BM_LauncherActivate(benchmark::State& state)
+{
+    const LauncherProfiles::Matcher prototype(LauncherProfiles::BuiltIn());
+    for (auto _ : state) {
+        auto matcher = prototype;
+        benchmark::DoNotOptimize(matcher.activate(LR"(C:\Program Files\Epic Games\Fortnite\FortniteLauncher.exe -epicportal)"));
+    }
+}
+BENCHMARK(BM_LauncherActivate);
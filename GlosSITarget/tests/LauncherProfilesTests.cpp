@@ -0,0 +1,137 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "LauncherProfiles.h"
+#include "SyntheticProcessTree.h"
+
+namespace {
+
+using namespace SyntheticProcessTree;
+
+LauncherProfiles::Matcher EpicMatcher()
+{
+    LauncherProfiles::Matcher matcher(LauncherProfiles::BuiltIn());
+    matcher.activate(L"com.epicgames.launcher://apps/Fortnite?action=launch");
+    return matcher;
+}
+
+} // namespace
+
+TEST(LauncherProfiles, ActivatesMatchingProfilesOnly)
+{
+    LauncherProfiles::Matcher matcher(LauncherProfiles::BuiltIn());
+    EXPECT_FALSE(matcher.active());
+    EXPECT_FALSE(matcher.activate(LR"(C:\Games\Game.exe)"));
+    EXPECT_FALSE(matcher.active());
+
+    EXPECT_TRUE(matcher.activate(L"COM.EPICGAMES.LAUNCHER://apps/Fortnite"));
+    EXPECT_EQ(matcher.activeNames(), std::vector<std::string>{"Epic Games"});
+    EXPECT_EQ(matcher.mainProcesses(), std::vector<std::wstring>{L"EpicGamesLauncher.exe"});
+    // already active
+    EXPECT_FALSE(matcher.activate(L"com.epicgames.launcher://apps/Other"));
+
+    EXPECT_TRUE(matcher.activate(L"uplay://launch/1"));
+    EXPECT_EQ(matcher.activeNames(), (std::vector<std::string>{"Epic Games", "Ubisoft Connect"}));
+}
+
+TEST(LauncherProfiles, EmptyPatternIsAlwaysActive)
+{
+    LauncherProfiles::Matcher matcher({{"custom", L"", {L"Custom.exe"}, {}}, {"no processes", L"", {}, {}}});
+    EXPECT_TRUE(matcher.activate(L"anything"));
+    EXPECT_EQ(matcher.activeNames(), std::vector<std::string>{"custom"});
+}
+
+TEST(LauncherProfiles, NothingIsALauncherWhileInactive)
+{
+    LauncherProfiles::Matcher matcher(LauncherProfiles::BuiltIn());
+    const ProcessTree::Index tree(Desktop(16));
+    EXPECT_FALSE(matcher.isLauncher(tree, LAUNCHER));
+}
+
+TEST(LauncherProfiles, MatchesWholeNamesIgnoringCase)
+{
+    auto matcher = EpicMatcher();
+    const ProcessTree::Index tree({
+        {10, 4, L"EpicGamesLauncher.exe"},
+        {11, 4, L"epicgameslauncher.EXE"},
+        {12, 4, L"EpicGamesLauncher.exe.bak"},
+        {13, 4, L"MyEpicGamesLauncher.exe"},
+        {14, 4, L"EpicGamesLauncher"},
+    });
+    EXPECT_TRUE(matcher.isLauncher(tree, 10));
+    EXPECT_TRUE(matcher.isLauncher(tree, 11));
+    EXPECT_FALSE(matcher.isLauncher(tree, 12));
+    EXPECT_FALSE(matcher.isLauncher(tree, 13));
+    EXPECT_FALSE(matcher.isLauncher(tree, 14));
+    EXPECT_FALSE(matcher.isLauncher(tree, 99));
+}
+
+TEST(LauncherProfiles, HelpersCountOnlyBelowALauncher)
+{
+    LauncherProfiles::Matcher matcher(LauncherProfiles::BuiltIn());
+    matcher.activate(L"uplay://launch/1");
+    const ProcessTree::Index tree({
+        {10, 4, L"upc.exe"},
+        {11, 10, L"QtWebEngineProcess.exe"},
+        {12, 11, L"QtWebEngineProcess.exe"},
+        {20, 10, L"Game.exe"},
+        {21, 20, L"QtWebEngineProcess.exe"},
+        {30, 4, L"QtWebEngineProcess.exe"},
+    });
+    EXPECT_TRUE(matcher.isLauncher(tree, 10));
+    EXPECT_TRUE(matcher.isLauncher(tree, 11));
+    EXPECT_TRUE(matcher.isLauncher(tree, 12));
+    EXPECT_FALSE(matcher.isLauncher(tree, 20));
+    EXPECT_FALSE(matcher.isLauncher(tree, 21));
+    EXPECT_FALSE(matcher.isLauncher(tree, 30));
+}
+
+TEST(LauncherProfiles, HelperChainsEndAfterSixteenAncestors)
+{
+    LauncherProfiles::Matcher matcher(LauncherProfiles::BuiltIn());
+    matcher.activate(L"uplay://launch/1");
+    std::vector<ProcessTree::Entry> entries{{100, 4, L"upc.exe"}};
+    for (ProcessTree::Pid pid = 101; pid <= 120; pid++) {
+        entries.push_back({pid, pid - 1, L"QtWebEngineProcess.exe"});
+    }
+    const ProcessTree::Index tree(std::move(entries));
+    EXPECT_TRUE(matcher.isLauncher(tree, 116));
+    EXPECT_FALSE(matcher.isLauncher(tree, 117));
+}
+
+TEST(LauncherProfiles, ReclassifiesReusedPids)
+{
+    auto matcher = EpicMatcher();
+    EXPECT_TRUE(matcher.isLauncher(ProcessTree::Index({{10, 4, L"EpicWebHelper.exe"}}), 10));
+    EXPECT_FALSE(matcher.isLauncher(ProcessTree::Index({{10, 4, L"Game.exe"}}), 10));
+    EXPECT_TRUE(matcher.isLauncher(ProcessTree::Index({{10, 4, L"EpicWebHelper.exe"}}), 10));
+}
+
+TEST(LauncherProfiles, ClassifiesSyntheticDesktop)
+{
+    auto matcher = EpicMatcher();
+    const ProcessTree::Index tree(Desktop(200));
+    std::vector<ProcessTree::Pid> launchers;
+    tree.forEachDescendant(EXPLORER, [&](ProcessTree::Pid pid) {
+        if (matcher.isLauncher(tree, pid)) {
+            launchers.push_back(pid);
+        }
+    });
+    std::ranges::sort(launchers);
+    EXPECT_EQ(launchers, (std::vector<ProcessTree::Pid>{LAUNCHER, FIRST_HELPER, FIRST_HELPER + 1, FIRST_HELPER + 2, FIRST_HELPER + 3,
+                                                        FIRST_HELPER + 4, FIRST_HELPER + 5, FIRST_HELPER + 6, FIRST_HELPER + 7}));
+}
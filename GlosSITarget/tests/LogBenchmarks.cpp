@@ -0,0 +1,113 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <memory>
+#include <string>
+
+#include <benchmark/benchmark.h>
+#include <spdlog/sinks/null_sink.h>
+
+#include "Log.h"
+
+// Disabled lines are meant to cost < 1ns, so they can stay in per-tick/per-frame code
+
+namespace {
+
+std::string Expensive(int i)
+{
+    return std::to_string(i) + " formatted the slow way";
+}
+
+// a real logger that throws everything away; the default one would write to the console
+void UseNullLogger(spdlog::level::level_enum level)
+{
+    static const auto logger = std::make_shared<spdlog::logger>("bench", std::make_shared<spdlog::sinks::null_sink_mt>());
+    logger->set_level(level);
+    spdlog::set_default_logger(logger);
+}
+
+} // namespace
+
+// the loop alone; subtract from the numbers below
+static void BM_LogBaseline(benchmark::State& state)
+{
+    int i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(++i);
+    }
+}
+BENCHMARK(BM_LogBaseline);
+
+static void BM_LogDisabledLevel(benchmark::State& state)
+{
+    UseNullLogger(spdlog::level::trace);
+    Log::SetLevel(spdlog::level::info);
+    int i = 0;
+    for (auto _ : state) {
+        GLOSSI_TRACE("tick {}", Expensive(7));
+        benchmark::DoNotOptimize(++i);
+    }
+    Log::SetLevel(spdlog::level::trace);
+}
+BENCHMARK(BM_LogDisabledLevel);
+
+// level set on the logger only (like main.cpp does), so the default logger has to be looked up
+static void BM_LogDisabledLoggerLevel(benchmark::State& state)
+{
+    UseNullLogger(spdlog::level::info);
+    int i = 0;
+    for (auto _ : state) {
+        GLOSSI_TRACE("tick {}", Expensive(7));
+        benchmark::DoNotOptimize(++i);
+    }
+}
+BENCHMARK(BM_LogDisabledLoggerLevel);
+
+static void BM_LogDisabledCategory(benchmark::State& state)
+{
+    UseNullLogger(spdlog::level::trace);
+    Log::SetExtended(true, "window");
+    int i = 0;
+    for (auto _ : state) {
+        GLOSSI_EXT_TRACE(Log::INPUT, "tick {}", Expensive(7));
+        benchmark::DoNotOptimize(++i);
+    }
+    Log::SetExtended(false);
+}
+BENCHMARK(BM_LogDisabledCategory);
+
+// for comparison: spdlog's own functions evaluate their arguments before checking the level
+static void BM_LogDisabledSpdlog(benchmark::State& state)
+{
+    UseNullLogger(spdlog::level::info);
+    int i = 0;
+    for (auto _ : state) {
+        spdlog::trace("tick {}", Expensive(7));
+        benchmark::DoNotOptimize(++i);
+    }
+}
+BENCHMARK(BM_LogDisabledSpdlog);
+
+// enabled, formatted, and dropped by the null sink
+static void BM_LogEnabled(benchmark::State& state)
+{
+    UseNullLogger(spdlog::level::trace);
+    int i = 0;
+    for (auto _ : state) {
+        GLOSSI_TRACE("tick {}", i);
+        benchmark::DoNotOptimize(++i);
+    }
+}
+BENCHMARK(BM_LogEnabled);
@@ -0,0 +1,61 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "LogRing.h"
+
+namespace {
+
+// Same dimensions as the overlay's
+using Ring = LogRing<1024, 256>;
+
+const std::string LINE = "[InputRedirector] Controller 1 connected; plugging virtual pad (DualShock 4, rumble forwarded)";
+
+} // namespace
+
+// Per-frame cost of Overlay::syncLogs after `range(0)` lines were logged, with `range(1)` new lines per frame;
+// has to be the same for 1k and 1M lines
+static void BM_LogViewSync(benchmark::State& state)
+{
+    const auto ring = std::make_unique<Ring>();
+    LogView<Ring> view;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        ring->push(std::chrono::system_clock::now(), spdlog::level::info, LINE);
+    }
+    view.sync(*ring);
+    for (auto _ : state) {
+        for (int64_t i = 0; i < state.range(1); i++) {
+            ring->push(std::chrono::system_clock::now(), spdlog::level::info, LINE);
+        }
+        view.sync(*ring);
+        benchmark::DoNotOptimize(view.end());
+    }
+    state.counters["lines"] = static_cast<double>(ring->head());
+}
+BENCHMARK(BM_LogViewSync)->ArgsProduct({{1'000, 1'000'000}, {0, 1, 16}});
+
+static void BM_LogRingPush(benchmark::State& state)
+{
+    const auto ring = std::make_unique<Ring>();
+    for (auto _ : state) {
+        ring->push(std::chrono::system_clock::now(), spdlog::level::info, LINE);
+    }
+}
+BENCHMARK(BM_LogRingPush);
@@ -0,0 +1,225 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "LogRing.h"
+
+using namespace std::chrono_literals;
+using Clock = std::chrono::system_clock;
+
+namespace {
+
+using SmallRing = LogRing<8, 32>;
+
+// Line n of writer w: "<w><n>" followed by a byte only this line uses; the time carries n, the level w
+std::string Line(uint32_t writer, uint32_t n, size_t max_payload)
+{
+    std::string line(8 + n % (max_payload - 7), static_cast<char>('a' + (n + writer) % 26));
+    std::memcpy(line.data(), &writer, sizeof(writer));
+    std::memcpy(line.data() + sizeof(writer), &n, sizeof(n));
+    return line;
+}
+
+} // namespace
+
+TEST(LogRing, RoundTrip)
+{
+    SmallRing ring;
+    const auto now = Clock::now();
+    ring.push(now, spdlog::level::warn, "hello");
+    EXPECT_EQ(ring.head(), 1u);
+
+    Clock::time_point time;
+    spdlog::level::level_enum level;
+    std::string payload;
+    ASSERT_EQ(ring.read(0, time, level, payload), SmallRing::ReadResult::Ok);
+    EXPECT_EQ(time, now);
+    EXPECT_EQ(level, spdlog::level::warn);
+    EXPECT_EQ(payload, "hello");
+}
+
+TEST(LogRing, TruncatesLongLines)
+{
+    SmallRing ring;
+    const std::string line(100, 'x');
+    ring.push(Clock::now(), spdlog::level::info, line);
+    ring.push(Clock::now(), spdlog::level::info, "");
+
+    Clock::time_point time;
+    spdlog::level::level_enum level;
+    std::string payload;
+    ASSERT_EQ(ring.read(0, time, level, payload), SmallRing::ReadResult::Ok);
+    EXPECT_EQ(payload, line.substr(0, 32));
+    ASSERT_EQ(ring.read(1, time, level, payload), SmallRing::ReadResult::Ok);
+    EXPECT_EQ(payload, "");
+}
+
+TEST(LogRing, UnwrittenLinesArePending)
+{
+    SmallRing ring;
+    Clock::time_point time;
+    spdlog::level::level_enum level;
+    std::string payload;
+    EXPECT_EQ(ring.read(0, time, level, payload), SmallRing::ReadResult::Pending);
+    ring.push(Clock::now(), spdlog::level::info, "a");
+    EXPECT_EQ(ring.read(1, time, level, payload), SmallRing::ReadResult::Pending);
+    // same slot as 0, one lap later
+    EXPECT_EQ(ring.read(8, time, level, payload), SmallRing::ReadResult::Pending);
+}
+
+TEST(LogRing, OverwritesOldestLines)
+{
+    SmallRing ring;
+    for (int i = 0; i < 20; i++) {
+        ring.push(Clock::now(), spdlog::level::info, std::to_string(i));
+    }
+    EXPECT_EQ(ring.head(), 20u);
+    EXPECT_EQ(ring.tail(), 12u);
+
+    Clock::time_point time;
+    spdlog::level::level_enum level;
+    std::string payload;
+    EXPECT_EQ(ring.read(11, time, level, payload), SmallRing::ReadResult::Lost);
+    for (uint64_t seq = ring.tail(); seq < ring.head(); seq++) {
+        ASSERT_EQ(ring.read(seq, time, level, payload), SmallRing::ReadResult::Ok);
+        EXPECT_EQ(payload, std::to_string(seq));
+    }
+}
+
+// A tiny ring, so writers lap each other and the reader all the time
+TEST(LogRing, ConcurrentWriters)
+{
+    using Ring = LogRing<16, 64>;
+    constexpr uint32_t WRITERS = 4;
+    constexpr uint32_t LINES = 200000;
+    Ring ring;
+    std::atomic<uint32_t> running = WRITERS;
+    std::vector<std::thread> writers;
+    for (uint32_t w = 0; w < WRITERS; w++) {
+        writers.emplace_back([&ring, &running, w] {
+            for (uint32_t n = 0; n < LINES; n++) {
+                ring.push(Clock::time_point(Clock::duration(n)), static_cast<spdlog::level::level_enum>(w), Line(w, n, Ring::max_payload));
+            }
+            running--;
+        });
+    }
+
+    uint64_t read = 0;
+    uint64_t torn = 0;
+    uint64_t reordered = 0;
+    uint64_t stuck = 0;
+    std::array<int64_t, WRITERS> last_n;
+    last_n.fill(-1);
+    const auto check = [&](Clock::time_point time, spdlog::level::level_enum level, const std::string& payload) {
+        uint32_t w = 0;
+        uint32_t n = 0;
+        if (payload.size() < 8) {
+            torn++;
+            return;
+        }
+        std::memcpy(&w, payload.data(), sizeof(w));
+        std::memcpy(&n, payload.data() + sizeof(w), sizeof(n));
+        if (w >= WRITERS || payload != Line(w, n, Ring::max_payload) || level != static_cast<spdlog::level::level_enum>(w)
+            || time != Clock::time_point(Clock::duration(n))) {
+            torn++;
+            return;
+        }
+        // lines of one writer keep their order
+        reordered += n <= last_n[w];
+        last_n[w] = n;
+        read++;
+    };
+
+    uint64_t cursor = 0;
+    Clock::time_point time;
+    spdlog::level::level_enum level;
+    std::string payload;
+    while (running > 0 || cursor < ring.head()) {
+        cursor = std::max(cursor, ring.tail());
+        if (cursor == ring.head()) {
+            std::this_thread::yield();
+            continue;
+        }
+        switch (ring.read(cursor, time, level, payload)) {
+        case Ring::ReadResult::Ok:
+            check(time, level, payload);
+            cursor++;
+            break;
+        case Ring::ReadResult::Lost:
+            cursor++;
+            break;
+        case Ring::ReadResult::Pending:
+            // every push has returned; nothing may be left half written
+            if (running == 0) {
+                stuck++;
+                cursor++;
+            }
+            std::this_thread::yield();
+            break;
+        }
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    EXPECT_EQ(ring.head(), uint64_t{WRITERS} * LINES);
+    EXPECT_EQ(torn, 0u);
+    EXPECT_EQ(reordered, 0u);
+    EXPECT_EQ(stuck, 0u);
+    EXPECT_GT(read, 0u);
+
+    // the last lap is complete
+    for (uint64_t seq = ring.tail(); seq < ring.head(); seq++) {
+        EXPECT_EQ(ring.read(seq, time, level, payload), Ring::ReadResult::Ok) << seq;
+    }
+}
+
+TEST(LogView, CopiesOnlyNewLines)
+{
+    SmallRing ring;
+    LogView<SmallRing> view;
+    view.sync(ring);
+    EXPECT_EQ(view.begin(), view.end());
+
+    for (int i = 0; i < 3; i++) {
+        ring.push(Clock::now(), spdlog::level::info, std::to_string(i));
+    }
+    view.sync(ring);
+    ASSERT_EQ(view.begin(), 0u);
+    ASSERT_EQ(view.end(), 3u);
+    EXPECT_EQ(view[2].payload, "2");
+
+    // keeps the last lap when it falls behind
+    for (int i = 3; i < 30; i++) {
+        ring.push(Clock::now(), spdlog::level::warn, std::to_string(i));
+    }
+    view.sync(ring);
+    EXPECT_EQ(view.begin(), 22u);
+    EXPECT_EQ(view.end(), 30u);
+    for (auto seq = view.begin(); seq < view.end(); seq++) {
+        EXPECT_EQ(view[seq].payload, std::to_string(seq));
+        EXPECT_EQ(view[seq].level, spdlog::level::warn);
+    }
+}
@@ -0,0 +1,105 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <memory>
+
+#include <gtest/gtest.h>
+#include <spdlog/sinks/null_sink.h>
+
+#include "Log.h"
+
+namespace {
+
+class LogTest : public testing::Test {
+  protected:
+    void SetUp() override
+    {
+        previous_ = spdlog::default_logger();
+        logger_ = std::make_shared<spdlog::logger>("test", std::make_shared<spdlog::sinks::null_sink_mt>());
+        spdlog::set_default_logger(logger_);
+    }
+
+    void TearDown() override
+    {
+        Log::SetExtended(false);
+        Log::min_level = SPDLOG_LEVEL_TRACE;
+        spdlog::set_default_logger(previous_);
+    }
+
+    std::shared_ptr<spdlog::logger> logger_;
+
+  private:
+    std::shared_ptr<spdlog::logger> previous_;
+};
+
+} // namespace
+
+TEST_F(LogTest, DisabledLinesDontEvaluateArguments)
+{
+    int evaluated = 0;
+    const auto arg = [&evaluated] { return ++evaluated; };
+
+    logger_->set_level(spdlog::level::info);
+    GLOSSI_TRACE("{}", arg());
+    GLOSSI_DEBUG("{}", arg());
+    EXPECT_EQ(evaluated, 0);
+
+    logger_->set_level(spdlog::level::trace);
+    GLOSSI_TRACE("{}", arg());
+    EXPECT_EQ(evaluated, 1);
+
+    // extended lines also need their category
+    GLOSSI_EXT_TRACE(Log::INPUT, "{}", arg());
+    EXPECT_EQ(evaluated, 1);
+    Log::SetExtended(true, "input");
+    GLOSSI_EXT_TRACE(Log::INPUT, "{}", arg());
+    GLOSSI_EXT_TRACE(Log::WINDOW, "{}", arg());
+    EXPECT_EQ(evaluated, 2);
+}
+
+TEST_F(LogTest, SetLevelFiltersBeforeTheLogger)
+{
+    int evaluated = 0;
+    const auto arg = [&evaluated] { return ++evaluated; };
+
+    Log::SetLevel(spdlog::level::info);
+    EXPECT_EQ(logger_->level(), spdlog::level::info);
+    GLOSSI_TRACE("{}", arg());
+    GLOSSI_EXT_INFO(Log::ALL, "{}", arg());
+    EXPECT_EQ(evaluated, 0);
+    Log::SetExtended(true);
+    GLOSSI_EXT_INFO(Log::INPUT, "{}", arg());
+    EXPECT_EQ(evaluated, 1);
+
+    Log::SetLevel(spdlog::level::trace);
+    GLOSSI_TRACE("{}", arg());
+    EXPECT_EQ(evaluated, 2);
+}
+
+TEST_F(LogTest, ParsesCategories)
+{
+    Log::SetExtended(true, " window , http,bogus");
+    EXPECT_TRUE(Log::ExtendedEnabled(Log::WINDOW));
+    EXPECT_TRUE(Log::ExtendedEnabled(Log::HTTP));
+    EXPECT_FALSE(Log::ExtendedEnabled(Log::INPUT));
+    EXPECT_FALSE(Log::ExtendedEnabled(Log::PROCESS));
+
+    Log::SetExtended(true);
+    EXPECT_TRUE(Log::ExtendedEnabled(Log::PROCESS));
+    Log::SetExtended(true, "all");
+    EXPECT_TRUE(Log::ExtendedEnabled(Log::INPUT));
+    Log::SetExtended(false, "window");
+    EXPECT_FALSE(Log::ExtendedEnabled(Log::WINDOW));
+}
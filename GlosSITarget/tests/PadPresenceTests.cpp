@@ -0,0 +1,137 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <chrono>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "PadPresence.h"
+#include "VirtualTickClock.h"
+
+using namespace std::chrono_literals;
+using PadPresence::Event;
+
+namespace {
+
+// Times at which an always empty slot gets probed, ticking every millisecond
+std::vector<TickClock::duration> ProbeTimes(PadPresence::Tracker& tracker, VirtualTickClock& clock, TickClock::duration span)
+{
+    std::vector<TickClock::duration> probes;
+    const auto start = clock.now();
+    while (clock.now() - start < span) {
+        tracker.beginTick(clock.now());
+        if (tracker.shouldProbe(0, clock.now())) {
+            probes.push_back(clock.now() - start);
+            tracker.report(0, false, clock.now());
+        }
+        clock.advance(1ms);
+    }
+    return probes;
+}
+
+} // namespace
+
+TEST(PadPresence, EmptySlotBacksOffExponentially)
+{
+    VirtualTickClock clock;
+    PadPresence::Tracker tracker(1);
+    const auto probes = ProbeTimes(tracker, clock, 8s);
+    // 250ms, doubling, capped at 2s
+    const std::vector<TickClock::duration> expected{0ms, 250ms, 750ms, 1750ms, 3750ms, 5750ms, 7750ms};
+    EXPECT_EQ(probes, expected);
+}
+
+TEST(PadPresence, PlugIsReportedOnce)
+{
+    VirtualTickClock clock;
+    PadPresence::Tracker tracker(1);
+    EXPECT_EQ(tracker.report(0, true, clock.now()), Event::Plugged);
+    EXPECT_EQ(tracker.report(0, true, clock.now()), Event::None);
+    EXPECT_TRUE(tracker.isConnected(0));
+    // connected slots are probed every tick
+    EXPECT_TRUE(tracker.shouldProbe(0, clock.now()));
+}
+
+TEST(PadPresence, ShortFailuresAreDebounced)
+{
+    VirtualTickClock clock;
+    PadPresence::Tracker tracker(1);
+    tracker.report(0, true, clock.now());
+    for (int i = 0; i < 249; i++) {
+        clock.advance(1ms);
+        EXPECT_EQ(tracker.report(0, false, clock.now()), Event::None);
+    }
+    EXPECT_TRUE(tracker.isConnected(0));
+
+    // a success in between restarts the debounce window
+    EXPECT_EQ(tracker.report(0, true, clock.now()), Event::None);
+    clock.advance(1ms);
+    EXPECT_EQ(tracker.report(0, false, clock.now()), Event::None);
+    clock.advance(249ms);
+    EXPECT_EQ(tracker.report(0, false, clock.now()), Event::None);
+    clock.advance(1ms);
+    EXPECT_EQ(tracker.report(0, false, clock.now()), Event::Unplugged);
+    EXPECT_FALSE(tracker.isConnected(0));
+}
+
+TEST(PadPresence, UnplugRestartsBackoff)
+{
+    VirtualTickClock clock;
+    PadPresence::Tracker tracker(1);
+    // let the backoff grow to its cap first
+    ProbeTimes(tracker, clock, 10s);
+    tracker.report(0, true, clock.now());
+    tracker.report(0, false, clock.now());
+    clock.advance(250ms);
+    ASSERT_EQ(tracker.report(0, false, clock.now()), Event::Unplugged);
+
+    EXPECT_FALSE(tracker.shouldProbe(0, clock.now() + 249ms));
+    EXPECT_TRUE(tracker.shouldProbe(0, clock.now() + 250ms));
+}
+
+TEST(PadPresence, RescanProbesEmptySlotsRightAway)
+{
+    VirtualTickClock clock;
+    PadPresence::Tracker tracker(2);
+    ProbeTimes(tracker, clock, 10s);
+    tracker.report(1, true, clock.now());
+    ASSERT_FALSE(tracker.shouldProbe(0, clock.now()));
+
+    tracker.rescan();
+    // only takes effect on the next tick
+    EXPECT_FALSE(tracker.shouldProbe(0, clock.now()));
+    tracker.beginTick(clock.now());
+    EXPECT_TRUE(tracker.shouldProbe(0, clock.now()));
+    EXPECT_TRUE(tracker.isConnected(1));
+
+    // and the backoff starts over
+    tracker.report(0, false, clock.now());
+    EXPECT_TRUE(tracker.shouldProbe(0, clock.now() + 250ms));
+}
+
+TEST(PadPresence, ResizeKeepsExistingSlots)
+{
+    VirtualTickClock clock;
+    PadPresence::Tracker tracker(1);
+    tracker.report(0, true, clock.now());
+    tracker.resize(4);
+    EXPECT_EQ(tracker.size(), 4u);
+    EXPECT_TRUE(tracker.isConnected(0));
+    for (size_t i = 1; i < 4; i++) {
+        EXPECT_FALSE(tracker.isConnected(i));
+        EXPECT_TRUE(tracker.shouldProbe(i, clock.now()));
+    }
+}
@@ -0,0 +1,104 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "PidSnapshot.h"
+
+using Publisher = PidSnapshot::Publisher<uint32_t>;
+
+TEST(PidSnapshot, StartsEmpty)
+{
+    const Publisher publisher(42);
+    const auto snapshot = publisher.current();
+    EXPECT_EQ(snapshot->version, 0u);
+    EXPECT_TRUE(snapshot->pids.empty());
+    EXPECT_EQ(snapshot->json, "[]");
+}
+
+TEST(PidSnapshot, VersionBumpsOnlyOnChange)
+{
+    Publisher publisher(42);
+    EXPECT_TRUE(publisher.publish({10, 20}));
+    const auto first = publisher.current();
+    EXPECT_EQ(first->version, 1u);
+    EXPECT_EQ(first->json, "[10,20]");
+    EXPECT_EQ(first->etag, "\"42-1\"");
+
+    EXPECT_FALSE(publisher.publish({10, 20}));
+    EXPECT_EQ(publisher.current(), first);
+
+    EXPECT_TRUE(publisher.publish({10}));
+    const auto second = publisher.current();
+    EXPECT_EQ(second->version, 2u);
+    EXPECT_EQ(second->json, "[10]");
+    EXPECT_NE(second->etag, first->etag);
+    // readers still holding the old snapshot see it unchanged
+    EXPECT_EQ(first->json, "[10,20]");
+}
+
+TEST(PidSnapshot, EtagIsUniquePerInstance)
+{
+    Publisher a(1);
+    Publisher b(2);
+    a.publish({10});
+    b.publish({10});
+    EXPECT_NE(a.current()->etag, b.current()->etag);
+}
+
+TEST(PidSnapshot, MatchingIfNoneMatchIsNotModified)
+{
+    Publisher publisher(42);
+    publisher.publish({10, 20});
+    const auto etag = publisher.current()->etag;
+    const auto lookup = publisher.lookup(etag);
+    EXPECT_TRUE(lookup.not_modified);
+    EXPECT_EQ(lookup.snapshot->etag, etag);
+
+    EXPECT_TRUE(publisher.lookup("\"1-7\", " + etag).not_modified);
+    EXPECT_TRUE(publisher.lookup("W/" + etag).not_modified);
+    EXPECT_TRUE(publisher.lookup("*").not_modified);
+}
+
+TEST(PidSnapshot, StaleIfNoneMatchGetsBody)
+{
+    Publisher publisher(42);
+    publisher.publish({10, 20});
+    const auto stale = publisher.current()->etag;
+    publisher.publish({10, 20, 30});
+
+    const auto lookup = publisher.lookup(stale);
+    EXPECT_FALSE(lookup.not_modified);
+    EXPECT_EQ(lookup.snapshot->json, "[10,20,30]");
+    EXPECT_NE(lookup.snapshot->etag, stale);
+}
+
+TEST(PidSnapshot, MissingIfNoneMatchGetsBody)
+{
+    Publisher publisher(42);
+    publisher.publish({10});
+    const auto lookup = publisher.lookup("");
+    EXPECT_FALSE(lookup.not_modified);
+    EXPECT_EQ(lookup.snapshot->json, "[10]");
+}
+
+TEST(PidSnapshot, EtagMatchesTrimsListEntries)
+{
+    EXPECT_TRUE(PidSnapshot::EtagMatches(" \"a\" ,\"b\"", "\"a\""));
+    EXPECT_TRUE(PidSnapshot::EtagMatches("\"a\",  \"b\" ", "\"b\""));
+    EXPECT_FALSE(PidSnapshot::EtagMatches("\"a\",\"b\"", "\"c\""));
+    EXPECT_FALSE(PidSnapshot::EtagMatches("\"a\"", "a"));
+    EXPECT_FALSE(PidSnapshot::EtagMatches(",,", "\"a\""));
+}
@@ -0,0 +1,59 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "PixelSwizzle.h"
+
+namespace {
+
+bool Supported(PixelSwizzle::Kernel kernel)
+{
+    // BestKernel() is the widest one the CPU has; everything narrower works as well
+    return static_cast<int>(kernel) <= static_cast<int>(PixelSwizzle::BestKernel());
+}
+
+} // namespace
+
+// args: width, height, kernel
+static void BM_BgrxToRgba(benchmark::State& state)
+{
+    const auto kernel = static_cast<PixelSwizzle::Kernel>(state.range(2));
+    if (!Supported(kernel)) {
+        state.SkipWithError("kernel not supported by this CPU");
+        return;
+    }
+    const auto pixels = static_cast<size_t>(state.range(0) * state.range(1));
+    std::vector<uint8_t> src(pixels * 4);
+    for (size_t i = 0; i < src.size(); i++) {
+        src[i] = static_cast<uint8_t>(i * 31);
+    }
+    std::vector<uint8_t> dst(pixels * 4);
+    state.SetLabel(PixelSwizzle::KernelName(kernel));
+    for (auto _ : state) {
+        PixelSwizzle::BgrxToRgba(src.data(), dst.data(), pixels, kernel);
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * src.size()));
+}
+BENCHMARK(BM_BgrxToRgba)
+    ->ArgNames({"width", "height", "kernel"})
+    ->ArgsProduct({{1920}, {1080}, {0, 1, 2}})
+    ->ArgsProduct({{2560}, {1440}, {0, 1, 2}})
+    ->ArgsProduct({{3840}, {2160}, {0, 1, 2}})
+    ->Unit(benchmark::kMicrosecond);
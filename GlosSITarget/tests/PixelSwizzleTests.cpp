@@ -0,0 +1,65 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "PixelSwizzle.h"
+
+namespace {
+
+std::vector<uint8_t> Pattern(size_t pixels)
+{
+    std::vector<uint8_t> bgrx(pixels * 4);
+    for (size_t i = 0; i < bgrx.size(); i++) {
+        bgrx[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+    return bgrx;
+}
+
+} // namespace
+
+TEST(PixelSwizzle, ScalarSwapsChannels)
+{
+    const uint8_t bgrx[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t rgba[8] = {};
+    PixelSwizzle::BgrxToRgba(bgrx, rgba, 2, PixelSwizzle::Kernel::Scalar);
+    const uint8_t expected[] = {3, 2, 1, 255, 7, 6, 5, 255};
+    EXPECT_EQ(std::memcmp(rgba, expected, sizeof(expected)), 0);
+}
+
+TEST(PixelSwizzle, KernelsMatchScalar)
+{
+    for (const auto kernel : {PixelSwizzle::Kernel::Ssse3, PixelSwizzle::Kernel::Avx2}) {
+        if (static_cast<int>(kernel) > static_cast<int>(PixelSwizzle::BestKernel())) {
+            continue;
+        }
+        // odd sizes exercise the scalar tails
+        for (size_t pixels = 0; pixels < 70; pixels++) {
+            const auto src = Pattern(pixels);
+            std::vector<uint8_t> expected(src.size());
+            std::vector<uint8_t> actual(src.size());
+            PixelSwizzle::BgrxToRgba(src.data(), expected.data(), pixels, PixelSwizzle::Kernel::Scalar);
+            PixelSwizzle::BgrxToRgba(src.data(), actual.data(), pixels, kernel);
+            EXPECT_EQ(actual, expected) << PixelSwizzle::KernelName(kernel) << ", " << pixels << " pixels";
+
+            auto in_place = src;
+            PixelSwizzle::BgrxToRgba(in_place.data(), in_place.data(), pixels, kernel);
+            EXPECT_EQ(in_place, expected) << PixelSwizzle::KernelName(kernel) << " in place, " << pixels << " pixels";
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <benchmark/benchmark.h>
+
+#include "ProcessTree.h"
+#include "SyntheticProcessTree.h"
+
+using namespace SyntheticProcessTree;
+
+// one Index is built per launcher tick; arg: background processes
+static void BM_ProcessTreeBuild(benchmark::State& state)
+{
+    const auto entries = Desktop(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        ProcessTree::Index tree(entries);
+        benchmark::DoNotOptimize(tree.size());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * entries.size()));
+}
+BENCHMARK(BM_ProcessTreeBuild)->Arg(100)->Arg(1000)->Arg(5000);
+
+// walking everything below System visits the whole table
+static void BM_ProcessTreeWalk(benchmark::State& state)
+{
+    const ProcessTree::Index tree(Desktop(static_cast<size_t>(state.range(0))));
+    for (auto _ : state) {
+        size_t visited = 0;
+        tree.forEachDescendant(4, [&](ProcessTree::Pid) { visited++; });
+        benchmark::DoNotOptimize(visited);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * tree.size()));
+}
+BENCHMARK(BM_ProcessTreeWalk)->Arg(100)->Arg(1000)->Arg(5000);
+
+// the launched game's subtree, the usual case
+static void BM_ProcessTreeWalkGame(benchmark::State& state)
+{
+    const ProcessTree::Index tree(Desktop(1000, 16, static_cast<size_t>(state.range(0))));
+    for (auto _ : state) {
+        size_t visited = 0;
+        tree.forEachDescendant(LAUNCHER, [&](ProcessTree::Pid) { visited++; });
+        benchmark::DoNotOptimize(visited);
+    }
+}
+BENCHMARK(BM_ProcessTreeWalkGame)->Arg(8)->Arg(64)->Arg(512);
+
+static void BM_ProcessTreeLookup(benchmark::State& state)
+{
+    const ProcessTree::Index tree(Desktop(static_cast<size_t>(state.range(0))));
+    ProcessTree::Pid pid = FIRST_BACKGROUND;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tree.name(pid));
+        benchmark::DoNotOptimize(tree.parent(pid));
+        pid = pid + 7 < FIRST_BACKGROUND + state.range(0) ? pid + 7 : FIRST_BACKGROUND;
+    }
+}
+BENCHMARK(BM_ProcessTreeLookup)->Arg(100)->Arg(1000)->Arg(5000);
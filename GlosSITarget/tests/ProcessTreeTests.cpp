@@ -0,0 +1,120 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "ProcessTree.h"
+#include "SyntheticProcessTree.h"
+
+namespace {
+
+using ProcessTree::Pid;
+
+std::vector<Pid> Descendants(const ProcessTree::Index& tree, Pid root)
+{
+    std::vector<Pid> res;
+    tree.forEachDescendant(root, [&](Pid pid) { res.push_back(pid); });
+    return res;
+}
+
+} // namespace
+
+TEST(ProcessTree, LooksUpEntries)
+{
+    const ProcessTree::Index tree({
+        {0, 0, L"[System Process]"},
+        {30, 4, L"b.exe"},
+        {4, 0, L"System"},
+        {20, 4, L"a.exe"},
+    });
+    EXPECT_EQ(tree.size(), 4u);
+    EXPECT_TRUE(tree.contains(0));
+    EXPECT_TRUE(tree.contains(30));
+    EXPECT_FALSE(tree.contains(31));
+    EXPECT_EQ(tree.parent(30), 4u);
+    EXPECT_EQ(tree.parent(31), 0u);
+    EXPECT_EQ(tree.name(20), L"a.exe");
+    EXPECT_EQ(tree.name(21), L"");
+    EXPECT_EQ(tree.children(4), (std::vector<Pid>{20, 30}));
+    // the idle process is its own parent, but not its own child
+    EXPECT_EQ(tree.children(0), std::vector<Pid>{4});
+    EXPECT_TRUE(tree.children(20).empty());
+}
+
+TEST(ProcessTree, EmptyIndex)
+{
+    const ProcessTree::Index tree;
+    EXPECT_EQ(tree.size(), 0u);
+    EXPECT_FALSE(tree.contains(0));
+    EXPECT_EQ(tree.pidByName(L"a.exe"), 0u);
+    EXPECT_TRUE(Descendants(tree, 4).empty());
+}
+
+TEST(ProcessTree, PidByNameMatchesWholeNamesIgnoringCase)
+{
+    const ProcessTree::Index tree({
+        {30, 4, L"MyEpicGamesLauncher.exe"},
+        {20, 4, L"epicgameslauncher.exe"},
+        {40, 4, L"EpicGamesLauncher.exe"},
+    });
+    EXPECT_EQ(tree.pidByName(L"EpicGamesLauncher.exe"), 20u);
+    EXPECT_EQ(tree.pidByName(L"EPICGAMESLAUNCHER.EXE"), 20u);
+    EXPECT_EQ(tree.pidByName(L"GamesLauncher.exe"), 0u);
+    EXPECT_EQ(tree.pidByName(L"EpicGamesLauncher"), 0u);
+    EXPECT_EQ(tree.pidByName(L""), 0u);
+}
+
+TEST(ProcessTree, WalksDescendantsBreadthFirst)
+{
+    const ProcessTree::Index tree({
+        {10, 4, L"root.exe"},
+        {11, 10, L"a.exe"},
+        {12, 10, L"b.exe"},
+        {13, 11, L"a1.exe"},
+        {14, 12, L"b1.exe"},
+        {15, 13, L"a2.exe"},
+        {20, 4, L"unrelated.exe"},
+        {21, 20, L"unrelated_child.exe"},
+    });
+    EXPECT_EQ(Descendants(tree, 10), (std::vector<Pid>{11, 12, 13, 14, 15}));
+    EXPECT_EQ(Descendants(tree, 12), std::vector<Pid>{14});
+    EXPECT_TRUE(Descendants(tree, 15).empty());
+    EXPECT_TRUE(Descendants(tree, 99).empty());
+}
+
+TEST(ProcessTree, WalkSurvivesPidReuseLoops)
+{
+    // 10's parent exited, and its PID went to a process started by 12
+    const ProcessTree::Index tree({
+        {10, 12, L"a.exe"},
+        {11, 10, L"b.exe"},
+        {12, 11, L"c.exe"},
+        {13, 12, L"d.exe"},
+    });
+    EXPECT_EQ(Descendants(tree, 10), (std::vector<Pid>{11, 12, 13}));
+    EXPECT_EQ(Descendants(tree, 12), (std::vector<Pid>{10, 13, 11}));
+}
+
+TEST(ProcessTree, WalksSyntheticDesktop)
+{
+    using namespace SyntheticProcessTree;
+    const ProcessTree::Index tree(Desktop(500, 4, 8));
+    EXPECT_EQ(tree.size(), 5u + 8 + 8 + 500);
+    EXPECT_EQ(Descendants(tree, LAUNCHER).size(), 1u + 8 + 8);
+    EXPECT_EQ(Descendants(tree, GAME).size(), 8u);
+    // every background service hangs below System
+    EXPECT_EQ(Descendants(tree, 4).size(), 1u + 1 + 1 + 8 + 8 + 500);
+    EXPECT_EQ(tree.pidByName(L"CrashReporter.exe"), FIRST_GAME_CHILD);
+}
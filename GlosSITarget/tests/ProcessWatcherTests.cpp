@@ -0,0 +1,142 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "ProcessWatcher.h"
+
+// Linux backend (pidfd + poll thread)
+
+namespace {
+
+using namespace std::chrono_literals;
+
+pid_t Spawn(std::chrono::milliseconds lifetime, int exit_code)
+{
+    const pid_t pid = fork();
+    if (pid == 0) {
+        std::this_thread::sleep_for(lifetime);
+        _exit(exit_code);
+    }
+    return pid;
+}
+
+class ExitCollector {
+  public:
+    ProcessWatcher watcher{[this] {
+        std::lock_guard lock(mutex_);
+        cv_.notify_all();
+    }};
+
+    // pid -> exit code, once `count` exits came in or the timeout hit
+    std::map<uint32_t, uint32_t> waitFor(size_t count, std::chrono::seconds timeout = 10s)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::unique_lock lock(mutex_);
+        while (exits_.size() < count) {
+            lock.unlock();
+            for (const auto& exit : watcher.takeExits()) {
+                EXPECT_FALSE(exits_.contains(exit.pid)) << "pid " << exit.pid << " reported twice";
+                exits_[exit.pid] = exit.exit_code;
+            }
+            lock.lock();
+            if (exits_.size() >= count || !cv_.wait_until(lock, deadline, [this] { return watcher.hasExits(); })) {
+                break;
+            }
+        }
+        return exits_;
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::map<uint32_t, uint32_t> exits_;
+};
+
+} // namespace
+
+TEST(ProcessWatcher, ReportsExitCodesOfManyChildren)
+{
+    ExitCollector collector;
+    std::map<uint32_t, uint32_t> expected;
+    for (int i = 0; i < 20; i++) {
+        // some exit together, some before they are watched
+        const auto pid = Spawn(std::chrono::milliseconds((i % 5) * 20), i + 1);
+        ASSERT_GT(pid, 0);
+        expected[static_cast<uint32_t>(pid)] = static_cast<uint32_t>(i + 1);
+    }
+    for (const auto& [pid, code] : expected) {
+        ASSERT_TRUE(collector.watcher.watch(pid)) << "pidfd_open failed for " << pid;
+    }
+    EXPECT_EQ(collector.waitFor(expected.size()), expected);
+    EXPECT_EQ(collector.watcher.size(), 0u);
+    for (const auto& [pid, code] : expected) {
+        EXPECT_FALSE(collector.watcher.watching(pid));
+        // reaped by the watcher
+        EXPECT_EQ(waitpid(static_cast<pid_t>(pid), nullptr, WNOHANG), -1);
+    }
+}
+
+TEST(ProcessWatcher, KeepsWatchingRunningProcesses)
+{
+    ExitCollector collector;
+    const auto short_lived = Spawn(10ms, 3);
+    const auto long_lived = Spawn(300ms, 4);
+    ASSERT_TRUE(collector.watcher.watch(short_lived));
+    ASSERT_TRUE(collector.watcher.watch(long_lived));
+    // watching twice is fine
+    EXPECT_TRUE(collector.watcher.watch(long_lived));
+
+    const auto first = collector.waitFor(1);
+    EXPECT_EQ(first, (std::map<uint32_t, uint32_t>{{short_lived, 3}}));
+    EXPECT_TRUE(collector.watcher.watching(long_lived));
+    EXPECT_EQ(collector.watcher.size(), 1u);
+
+    EXPECT_EQ(collector.waitFor(2), (std::map<uint32_t, uint32_t>{{short_lived, 3}, {long_lived, 4}}));
+}
+
+TEST(ProcessWatcher, UnwatchedProcessesAreNotReported)
+{
+    ExitCollector collector;
+    const auto pid = Spawn(50ms, 5);
+    ASSERT_TRUE(collector.watcher.watch(pid));
+    collector.watcher.unwatch(pid);
+    EXPECT_FALSE(collector.watcher.watching(pid));
+
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_EQ(WEXITSTATUS(status), 5);
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(collector.watcher.hasExits());
+    EXPECT_TRUE(collector.watcher.takeExits().empty());
+}
+
+TEST(ProcessWatcher, CantWatchMissingProcesses)
+{
+    const auto pid = Spawn(0ms, 0);
+    ASSERT_EQ(waitpid(pid, nullptr, 0), pid);
+    ProcessWatcher watcher;
+    EXPECT_FALSE(watcher.watch(pid));
+    EXPECT_EQ(watcher.size(), 0u);
+}
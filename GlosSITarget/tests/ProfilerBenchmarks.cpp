@@ -0,0 +1,49 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <benchmark/benchmark.h>
+
+#include "Profiler.h"
+
+static void BM_ProfilerZone(benchmark::State& state)
+{
+    Profiler::SetEnabled(true);
+    for (auto _ : state) {
+        PROFILE_ZONE("Benchmark zone");
+    }
+}
+BENCHMARK(BM_ProfilerZone);
+
+static void BM_ProfilerZoneDisabled(benchmark::State& state)
+{
+    Profiler::SetEnabled(false);
+    for (auto _ : state) {
+        PROFILE_ZONE("Benchmark zone");
+    }
+    Profiler::SetEnabled(true);
+}
+BENCHMARK(BM_ProfilerZoneDisabled);
+
+static void BM_ProfilerChromeTrace(benchmark::State& state)
+{
+    Profiler::SetEnabled(true);
+    for (size_t i = 0; i < Profiler::ThreadBuffer::CAPACITY; i++) {
+        PROFILE_ZONE("Benchmark zone");
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Profiler::ChromeTrace(std::chrono::seconds(60)).size());
+    }
+}
+BENCHMARK(BM_ProfilerChromeTrace)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,113 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Profiler.h"
+
+namespace {
+
+std::vector<Profiler::Event> Collect(const Profiler::ThreadBuffer& buffer)
+{
+    std::vector<Profiler::Event> events;
+    buffer.collect(std::chrono::nanoseconds::min(), events);
+    return events;
+}
+
+} // namespace
+
+TEST(Profiler, RecordsZones)
+{
+    Profiler::ThreadBuffer buffer;
+    buffer.push("a", std::chrono::nanoseconds(10), std::chrono::nanoseconds(5));
+    buffer.push("b", std::chrono::nanoseconds(20), std::chrono::nanoseconds(7));
+    const auto events = Collect(buffer);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_STREQ(events[0].name, "a");
+    EXPECT_EQ(events[1].start.count(), 20);
+    EXPECT_EQ(events[1].duration.count(), 7);
+
+    std::vector<Profiler::Event> since;
+    buffer.collect(std::chrono::nanoseconds(15), since);
+    ASSERT_EQ(since.size(), 1u);
+    EXPECT_STREQ(since[0].name, "b");
+}
+
+TEST(Profiler, RingOverwritesOldest)
+{
+    auto buffer = std::make_unique<Profiler::ThreadBuffer>();
+    const auto total = Profiler::ThreadBuffer::CAPACITY + 100;
+    for (size_t i = 0; i < total; i++) {
+        buffer->push("zone", std::chrono::nanoseconds(i), std::chrono::nanoseconds(1));
+    }
+    const auto events = Collect(*buffer);
+    // the slot the writer would fill next is treated as torn
+    ASSERT_EQ(events.size(), Profiler::ThreadBuffer::CAPACITY - 1);
+    EXPECT_EQ(events.front().start.count(), static_cast<int64_t>(total - events.size()));
+    EXPECT_EQ(events.back().start.count(), static_cast<int64_t>(total - 1));
+}
+
+TEST(Profiler, ResetHidesPreviousThread)
+{
+    auto buffer = std::make_unique<Profiler::ThreadBuffer>();
+    buffer->setName("Old");
+    buffer->push("old", std::chrono::nanoseconds(1), std::chrono::nanoseconds(1));
+    buffer->reset();
+    EXPECT_TRUE(buffer->name().empty());
+    EXPECT_TRUE(Collect(*buffer).empty());
+    buffer->push("new", std::chrono::nanoseconds(2), std::chrono::nanoseconds(1));
+    const auto events = Collect(*buffer);
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_STREQ(events[0].name, "new");
+}
+
+TEST(Profiler, ExitedThreadsBuffersAreReused)
+{
+    const auto before = Profiler::Registry::Instance().buffers().size();
+    for (int i = 0; i < 50; i++) {
+        std::thread([] {
+            Profiler::SetThreadName("Short lived");
+            PROFILE_ZONE("Short lived zone");
+        }).join();
+    }
+    EXPECT_LE(Profiler::Registry::Instance().buffers().size(), before + 1);
+}
+
+TEST(Profiler, ChromeTrace)
+{
+    std::thread([] {
+        Profiler::SetThreadName("Trace test");
+        PROFILE_ZONE("Trace test zone");
+    }).join();
+
+    const auto trace = Profiler::ChromeTrace(std::chrono::seconds(10));
+    bool found_thread = false;
+    bool found_zone = false;
+    for (const auto& e : trace["traceEvents"]) {
+        if (e["ph"] == "M" && e["args"]["name"] == "Trace test") {
+            found_thread = true;
+        }
+        if (e["ph"] == "X" && e["name"] == "Trace test zone") {
+            found_zone = true;
+            EXPECT_GE(e["dur"].get<double>(), 0.0);
+        }
+    }
+    EXPECT_TRUE(found_thread);
+    EXPECT_TRUE(found_zone);
+}
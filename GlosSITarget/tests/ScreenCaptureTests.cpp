@@ -0,0 +1,52 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "ScreenCapture.h"
+
+namespace {
+
+ScreenCapture::State WaitWhileCapturing(const ScreenCapture& capture)
+{
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (capture.state() == ScreenCapture::State::Capturing && std::chrono::steady_clock::now() < until) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return capture.state();
+}
+
+} // namespace
+
+// There is no screen to grab off Windows; every capture fails, which is enough to drive the worker
+TEST(ScreenCapture, WorkerHandlesRepeatedCaptures)
+{
+    ScreenCapture capture;
+    EXPECT_EQ(capture.state(), ScreenCapture::State::Idle);
+    for (int i = 0; i < 20; i++) {
+        capture.start({0, 0, 64, 64});
+        EXPECT_EQ(WaitWhileCapturing(capture), ScreenCapture::State::Failed);
+        capture.reset();
+        EXPECT_EQ(capture.state(), ScreenCapture::State::Idle);
+    }
+}
+
+TEST(ScreenCapture, DestroyWithoutCapture)
+{
+    ScreenCapture capture;
+}
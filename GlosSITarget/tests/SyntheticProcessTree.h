@@ -0,0 +1,73 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ProcessTree.h"
+
+/*
+ * Process tables that look like a desktop with a store launcher and a game running
+ *
+ * explorer.exe (EXPLORER)
+ *  └ EpicGamesLauncher.exe (LAUNCHER)
+ *     ├ EpicWebHelper.exe x helpers, each with one nested EpicWebHelper.exe
+ *     └ Game.exe (GAME)
+ *        └ CrashReporter.exe, then game_children - 1 more Worker<n>.exe, as a chain
+ * plus `background` unrelated services with random parents.
+ */
+namespace SyntheticProcessTree {
+
+using ProcessTree::Entry;
+using ProcessTree::Pid;
+
+constexpr Pid EXPLORER = 1000;
+constexpr Pid LAUNCHER = 2000;
+constexpr Pid GAME = 3000;
+constexpr Pid FIRST_HELPER = 4000;
+constexpr Pid FIRST_GAME_CHILD = 5000;
+constexpr Pid FIRST_BACKGROUND = 10000;
+
+inline std::vector<Entry> Desktop(size_t background, size_t helpers = 4, size_t game_children = 8)
+{
+    std::vector<Entry> entries{
+        {0, 0, L"[System Process]"},
+        {4, 0, L"System"},
+        {EXPLORER, 4, L"explorer.exe"},
+        {LAUNCHER, EXPLORER, L"EpicGamesLauncher.exe"},
+        {GAME, LAUNCHER, L"Game.exe"},
+    };
+    for (Pid i = 0; i < helpers; i++) {
+        const Pid helper = FIRST_HELPER + i * 2;
+        entries.push_back({helper, LAUNCHER, L"EpicWebHelper.exe"});
+        entries.push_back({helper + 1, helper, L"EpicWebHelper.exe"});
+    }
+    for (Pid i = 0; i < game_children; i++) {
+        const Pid parent = i == 0 ? GAME : FIRST_GAME_CHILD + i - 1;
+        entries.push_back({FIRST_GAME_CHILD + i, parent, i == 0 ? L"CrashReporter.exe" : L"Worker" + std::to_wstring(i) + L".exe"});
+    }
+    std::mt19937 rng(1234);
+    for (Pid i = 0; i < background; i++) {
+        const Pid parent = i == 0 ? 4 : FIRST_BACKGROUND + std::uniform_int_distribution<Pid>(0, i - 1)(rng);
+        entries.push_back({FIRST_BACKGROUND + i, parent, L"svc" + std::to_wstring(i) + L".exe"});
+    }
+    // snapshots aren't sorted by PID either
+    std::ranges::shuffle(entries, rng);
+    return entries;
+}
+
+} // namespace SyntheticProcessTree
@@ -0,0 +1,47 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <filesystem>
+#include <system_error>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+/*
+ * Fixture for tests writing files
+ *
+ * tempFile() hands out paths in the temp directory and TearDown() removes them again,
+ * also when the test bailed out early on a failed ASSERT.
+ */
+class TempFiles : public testing::Test {
+  protected:
+    std::filesystem::path tempFile(const char* name)
+    {
+        return paths_.emplace_back(std::filesystem::temp_directory_path() / name);
+    }
+
+    void TearDown() override
+    {
+        for (const auto& path : paths_) {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+        paths_.clear();
+    }
+
+  private:
+    std::vector<std::filesystem::path> paths_;
+};
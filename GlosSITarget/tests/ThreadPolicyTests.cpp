@@ -0,0 +1,236 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <linux/capability.h>
+#include <pthread.h>
+#include <sched.h>
+#include <spdlog/sinks/ostream_sink.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "ThreadPolicy.h"
+
+namespace {
+
+// Schedulers act on the calling thread; keep the test runner's thread out of it
+class ThreadPolicyTest : public testing::Test {
+  protected:
+    void SetUp() override
+    {
+        previous_ = spdlog::default_logger();
+        spdlog::set_default_logger(std::make_shared<spdlog::logger>("test", std::make_shared<spdlog::sinks::ostream_sink_mt>(log_)));
+    }
+
+    void TearDown() override
+    {
+        spdlog::set_default_logger(previous_);
+    }
+
+    std::string log() const
+    {
+        return log_.str();
+    }
+
+    std::ostringstream log_;
+
+  private:
+    std::shared_ptr<spdlog::logger> previous_;
+};
+
+cpu_set_t Affinity()
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+    return set;
+}
+
+int LowestCore(const cpu_set_t& set)
+{
+    for (int i = 0; i < 64; i++) {
+        if (CPU_ISSET(i, &set)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int SchedPolicy(int* priority = nullptr)
+{
+    int policy = -1;
+    sched_param param{};
+    pthread_getschedparam(pthread_self(), &policy, &param);
+    if (priority) {
+        *priority = param.sched_priority;
+    }
+    return policy;
+}
+
+// Drops CAP_SYS_NICE from the calling thread only; capabilities are per thread on Linux
+bool DropSysNice()
+{
+    __user_cap_header_struct header{_LINUX_CAPABILITY_VERSION_3, 0};
+    __user_cap_data_struct data[2]{};
+    if (syscall(SYS_capget, &header, data) != 0) {
+        return false;
+    }
+    data[0].effective &= ~(1u << CAP_SYS_NICE);
+    return syscall(SYS_capset, &header, data) == 0;
+}
+
+} // namespace
+
+TEST(ThreadPolicy, TaskNamesRoundTrip)
+{
+    for (const auto task : {ThreadPolicy::Task::None, ThreadPolicy::Task::Games, ThreadPolicy::Task::ProAudio}) {
+        EXPECT_EQ(ThreadPolicy::TaskFromName(ThreadPolicy::TaskName(task)), task);
+    }
+    EXPECT_STREQ(ThreadPolicy::TaskName(ThreadPolicy::Task::ProAudio), "Pro Audio");
+    // unknown names (and old configs) fall back to no task
+    EXPECT_EQ(ThreadPolicy::TaskFromName(""), ThreadPolicy::Task::None);
+    EXPECT_EQ(ThreadPolicy::TaskFromName("games"), ThreadPolicy::Task::None);
+}
+
+TEST_F(ThreadPolicyTest, AffinityIsAppliedAndReverted)
+{
+    bool applied = false;
+    int core = -1;
+    int pinned_count = 0;
+    bool pinned_to_core = false;
+    bool reverted = false;
+    std::thread([&] {
+        const auto original = Affinity();
+        core = LowestCore(original);
+        if (core < 0) {
+            return;
+        }
+        auto scheduler = ThreadPolicy::Create();
+        applied = scheduler->apply({ThreadPolicy::Task::None, uint64_t{1} << core});
+        const auto pinned = Affinity();
+        pinned_count = CPU_COUNT(&pinned);
+        pinned_to_core = CPU_ISSET(core, &pinned);
+        scheduler->revert();
+        const auto after = Affinity();
+        reverted = CPU_EQUAL(&after, &original);
+    }).join();
+
+    ASSERT_GE(core, 0);
+    EXPECT_TRUE(applied);
+    EXPECT_EQ(pinned_count, 1);
+    EXPECT_TRUE(pinned_to_core);
+    EXPECT_TRUE(reverted);
+}
+
+TEST_F(ThreadPolicyTest, UnusableAffinityKeepsCurrentCores)
+{
+    bool applied = false;
+    bool unchanged = false;
+    bool has_unusable_core = false;
+    std::thread([&] {
+        const auto original = Affinity();
+        uint64_t mask = 0;
+        for (int i = 0; i < 64; i++) {
+            if (!CPU_ISSET(i, &original)) {
+                mask |= uint64_t{1} << i;
+            }
+        }
+        has_unusable_core = mask != 0;
+        auto scheduler = ThreadPolicy::Create();
+        applied = scheduler->apply({ThreadPolicy::Task::None, mask});
+        const auto after = Affinity();
+        unchanged = CPU_EQUAL(&after, &original);
+    }).join();
+
+    if (!has_unusable_core) {
+        GTEST_SKIP() << "every core is usable";
+    }
+    EXPECT_TRUE(applied);
+    EXPECT_TRUE(unchanged);
+    EXPECT_NE(log().find("doesn't contain any usable core"), std::string::npos);
+}
+
+TEST_F(ThreadPolicyTest, PriorityIsAppliedAndReverted)
+{
+    bool applied = false;
+    int games_policy = -1;
+    int games_priority = 0;
+    int pro_audio_policy = -1;
+    int reverted_policy = -1;
+    int reverted_priority = -1;
+    std::thread([&] {
+        auto scheduler = ThreadPolicy::Create();
+        applied = scheduler->apply({ThreadPolicy::Task::Games, 0});
+        games_policy = SchedPolicy(&games_priority);
+        scheduler->apply({ThreadPolicy::Task::ProAudio, 0});
+        pro_audio_policy = SchedPolicy();
+        scheduler->revert();
+        reverted_policy = SchedPolicy(&reverted_priority);
+    }).join();
+
+    if (!applied) {
+        GTEST_SKIP() << "no permission for realtime scheduling: " << log();
+    }
+    EXPECT_EQ(games_policy, SCHED_RR);
+    EXPECT_GT(games_priority, 0);
+    EXPECT_EQ(pro_audio_policy, SCHED_FIFO);
+    EXPECT_EQ(reverted_policy, SCHED_OTHER);
+    EXPECT_EQ(reverted_priority, 0);
+}
+
+TEST_F(ThreadPolicyTest, MissingSysNiceFailsGracefully)
+{
+    // without CAP_SYS_NICE, a non-zero rtprio limit would still allow realtime scheduling
+    rlimit rtprio{};
+    getrlimit(RLIMIT_RTPRIO, &rtprio);
+    const auto previous_rtprio = rtprio;
+    rtprio.rlim_cur = 0;
+    setrlimit(RLIMIT_RTPRIO, &rtprio);
+
+    bool dropped = false;
+    bool applied = true;
+    int policy = -1;
+    bool pinned = false;
+    std::thread([&] {
+        dropped = DropSysNice();
+        if (!dropped) {
+            return;
+        }
+        const auto original = Affinity();
+        const auto core = LowestCore(original);
+        auto scheduler = ThreadPolicy::Create();
+        applied = scheduler->apply({ThreadPolicy::Task::Games, uint64_t{1} << core});
+        policy = SchedPolicy();
+        // the affinity part still goes through
+        const auto after = Affinity();
+        pinned = CPU_COUNT(&after) == 1 && CPU_ISSET(core, &after);
+        scheduler->revert();
+    }).join();
+    setrlimit(RLIMIT_RTPRIO, &previous_rtprio);
+
+    if (!dropped) {
+        GTEST_SKIP() << "couldn't drop CAP_SYS_NICE";
+    }
+    EXPECT_FALSE(applied);
+    EXPECT_EQ(policy, SCHED_OTHER);
+    EXPECT_TRUE(pinned);
+    EXPECT_NE(log().find("Couldn't set thread scheduling to \"Games\""), std::string::npos) << log();
+}
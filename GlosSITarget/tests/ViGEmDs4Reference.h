@@ -0,0 +1,115 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <climits>
+
+#include "Ds4Translation.h"
+
+/*
+ * Straight transcription of ViGEmClient's DS4_REPORT_INIT, DS4_SET_DPAD and XUSB_TO_DS4_REPORT (include/ViGEm/Util.h)
+ * Kept branchy and in the original order on purpose; Ds4Translation is checked against this.
+ */
+namespace ViGEmDs4Reference {
+
+using Ds4Translation::Ds4Report;
+using Ds4Translation::XusbReport;
+using namespace Ds4Translation::detail;
+
+inline void DS4_SET_DPAD(Ds4Report* report, uint16_t dpad)
+{
+    report->wButtons &= ~0xF;
+    report->wButtons |= dpad;
+}
+
+inline void DS4_REPORT_INIT(Ds4Report* report)
+{
+    *report = Ds4Report{};
+    report->bThumbLX = 0x80;
+    report->bThumbLY = 0x80;
+    report->bThumbRX = 0x80;
+    report->bThumbRY = 0x80;
+    DS4_SET_DPAD(report, NONE);
+}
+
+inline void XUSB_TO_DS4_REPORT(const XusbReport* input, Ds4Report* output)
+{
+    if (input->wButtons & XUSB_BACK)
+        output->wButtons |= DS4_SHARE;
+    if (input->wButtons & XUSB_START)
+        output->wButtons |= DS4_OPTIONS;
+    if (input->wButtons & XUSB_LEFT_THUMB)
+        output->wButtons |= DS4_THUMB_LEFT;
+    if (input->wButtons & XUSB_RIGHT_THUMB)
+        output->wButtons |= DS4_THUMB_RIGHT;
+    if (input->wButtons & XUSB_LEFT_SHOULDER)
+        output->wButtons |= DS4_SHOULDER_LEFT;
+    if (input->wButtons & XUSB_RIGHT_SHOULDER)
+        output->wButtons |= DS4_SHOULDER_RIGHT;
+    if (input->wButtons & XUSB_GUIDE)
+        output->bSpecial |= DS4_SPECIAL_PS;
+    if (input->wButtons & XUSB_A)
+        output->wButtons |= DS4_CROSS;
+    if (input->wButtons & XUSB_B)
+        output->wButtons |= DS4_CIRCLE;
+    if (input->wButtons & XUSB_X)
+        output->wButtons |= DS4_SQUARE;
+    if (input->wButtons & XUSB_Y)
+        output->wButtons |= DS4_TRIANGLE;
+
+    output->bTriggerL = input->bLeftTrigger;
+    output->bTriggerR = input->bRightTrigger;
+
+    if (input->bLeftTrigger > 0)
+        output->wButtons |= DS4_TRIGGER_LEFT;
+    if (input->bRightTrigger > 0)
+        output->wButtons |= DS4_TRIGGER_RIGHT;
+
+    if (input->wButtons & XUSB_DPAD_UP)
+        DS4_SET_DPAD(output, NORTH);
+    if (input->wButtons & XUSB_DPAD_RIGHT)
+        DS4_SET_DPAD(output, EAST);
+    if (input->wButtons & XUSB_DPAD_DOWN)
+        DS4_SET_DPAD(output, SOUTH);
+    if (input->wButtons & XUSB_DPAD_LEFT)
+        DS4_SET_DPAD(output, WEST);
+
+    if (input->wButtons & XUSB_DPAD_UP && input->wButtons & XUSB_DPAD_RIGHT)
+        DS4_SET_DPAD(output, NORTHEAST);
+    if (input->wButtons & XUSB_DPAD_RIGHT && input->wButtons & XUSB_DPAD_DOWN)
+        DS4_SET_DPAD(output, SOUTHEAST);
+    if (input->wButtons & XUSB_DPAD_DOWN && input->wButtons & XUSB_DPAD_LEFT)
+        DS4_SET_DPAD(output, SOUTHWEST);
+    if (input->wButtons & XUSB_DPAD_LEFT && input->wButtons & XUSB_DPAD_UP)
+        DS4_SET_DPAD(output, NORTHWEST);
+
+    output->bThumbLX = static_cast<uint8_t>((input->sThumbLX + ((USHRT_MAX / 2) + 1)) / 257);
+    output->bThumbLY = static_cast<uint8_t>((-(input->sThumbLY + ((USHRT_MAX / 2) - 1)) / 257));
+    output->bThumbLY = (output->bThumbLY == 0) ? 0xFF : output->bThumbLY;
+    output->bThumbRX = static_cast<uint8_t>((input->sThumbRX + ((USHRT_MAX / 2) + 1)) / 257);
+    output->bThumbRY = static_cast<uint8_t>((-(input->sThumbRY + ((USHRT_MAX / 2) + 1)) / 257));
+    output->bThumbRY = (output->bThumbRY == 0) ? 0xFF : output->bThumbRY;
+}
+
+// What ViGEmPadSink did before Ds4Translation
+inline Ds4Report Translate(const XusbReport& input)
+{
+    Ds4Report output;
+    DS4_REPORT_INIT(&output);
+    XUSB_TO_DS4_REPORT(&input, &output);
+    return output;
+}
+
+} // namespace ViGEmDs4Reference
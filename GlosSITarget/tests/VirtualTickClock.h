@@ -0,0 +1,88 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "TickClock.h"
+
+/*
+ * Clock for driving schedulers in tests
+ *
+ * Time only moves when a scheduler sleeps (or advance() is called);
+ * sleepUntil jumps straight to the deadline, unless wake() was called before
+ * (or gets called by an at() action during the sleep).
+ * Only wake() may be called from another thread than the one sleeping.
+ */
+class VirtualTickClock : public TickClock {
+  public:
+    time_point now() const override
+    {
+        return now_;
+    }
+
+    void sleepUntil(time_point deadline) override
+    {
+        sleeps_.push_back(deadline - now_);
+        if (woken_.exchange(false)) {
+            return;
+        }
+        if (action_ && action_at_ <= deadline) {
+            now_ = std::max(now_, action_at_);
+            const auto action = std::move(action_);
+            action_ = nullptr;
+            action();
+            if (woken_.exchange(false)) {
+                return;
+            }
+        }
+        if (deadline > now_) {
+            now_ = deadline;
+        }
+    }
+
+    void wake() override
+    {
+        woken_ = true;
+    }
+
+    void advance(duration d)
+    {
+        now_ += d;
+    }
+
+    // Runs action once, as soon as a sleep passes the given time (e.g. another thread calling wake())
+    void at(time_point when, std::function<void()> action)
+    {
+        action_at_ = when;
+        action_ = std::move(action);
+    }
+
+    // Requested sleep durations, in order
+    const std::vector<duration>& sleeps() const
+    {
+        return sleeps_;
+    }
+
+  private:
+    time_point now_{};
+    std::atomic<bool> woken_ = false;
+    std::vector<duration> sleeps_;
+    time_point action_at_{};
+    std::function<void()> action_;
+};
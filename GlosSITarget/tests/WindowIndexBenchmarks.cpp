@@ -0,0 +1,108 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "WindowIndex.h"
+
+// isTracked() runs inside the GetForegroundWindow hook, i.e. on the game's thread
+
+namespace {
+
+constexpr uintptr_t WINDOWS = 500;
+
+WindowIndex::Id Window(uintptr_t n)
+{
+    return reinterpret_cast<WindowIndex::Id>(0x10000 + n * 0x10);
+}
+
+// 500 top level windows from 100 processes; the launched game owns 5 of them
+void Fill(WindowIndex& index)
+{
+    std::vector<std::pair<WindowIndex::Id, uint32_t>> windows;
+    for (uintptr_t i = 0; i < WINDOWS; i++) {
+        windows.emplace_back(Window(i), static_cast<uint32_t>(1000 + i % 100));
+    }
+    index.reset(windows);
+    index.setPids(std::vector<uint32_t>{1042});
+}
+
+} // namespace
+
+// arg: 1 = foreground window belongs to the game
+static void BM_WindowIndexHook(benchmark::State& state)
+{
+    WindowIndex index;
+    Fill(index);
+    const auto window = Window(state.range(0) ? 42 : 43);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.isTracked(window));
+    }
+}
+BENCHMARK(BM_WindowIndexHook)->Arg(0)->Arg(1);
+
+// hook calls while the main thread keeps handling window create/destroy events
+static void BM_WindowIndexHookWithEvents(benchmark::State& state)
+{
+    WindowIndex index;
+    Fill(index);
+    std::atomic<bool> stop = false;
+    std::thread events([&] {
+        for (uintptr_t n = 0; !stop; n++) {
+            index.addWindow(Window(WINDOWS + n % 16), 1042);
+            index.removeWindow(Window(WINDOWS + n % 16));
+        }
+    });
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.isTracked(Window(42)));
+    }
+    stop = true;
+    events.join();
+}
+BENCHMARK(BM_WindowIndexHookWithEvents);
+
+// one window create/destroy event
+static void BM_WindowIndexEvent(benchmark::State& state)
+{
+    WindowIndex index;
+    Fill(index);
+    uintptr_t n = 0;
+    for (auto _ : state) {
+        index.addWindow(Window(WINDOWS + n % 16), 1042);
+        index.removeWindow(Window(WINDOWS + n % 16));
+        n++;
+    }
+}
+BENCHMARK(BM_WindowIndexEvent);
+
+// launched PIDs changed; rebuilds the tracked set from all 500 windows
+static void BM_WindowIndexSetPids(benchmark::State& state)
+{
+    WindowIndex index;
+    Fill(index);
+    const std::vector<uint32_t> a{1042};
+    const std::vector<uint32_t> b{1042, 1043};
+    bool flip = false;
+    for (auto _ : state) {
+        index.setPids(flip ? a : b);
+        flip = !flip;
+    }
+}
+BENCHMARK(BM_WindowIndexSetPids);
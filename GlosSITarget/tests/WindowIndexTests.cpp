@@ -0,0 +1,137 @@
+/*
+Copyright 2021-2023 Peter Repukat - FlatspotSoftware
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "WindowIndex.h"
+
+namespace {
+
+WindowIndex::Id Window(uintptr_t n)
+{
+    return reinterpret_cast<WindowIndex::Id>(0x10000 + n * 0x10);
+}
+
+std::set<WindowIndex::Id> Tracked(const WindowIndex& index)
+{
+    const auto windows = index.trackedWindows();
+    return {windows.begin(), windows.end()};
+}
+
+} // namespace
+
+TEST(WindowIndex, TracksWindowsOfGivenPids)
+{
+    WindowIndex index;
+    index.reset({{Window(1), 100}, {Window(2), 100}, {Window(3), 200}, {Window(4), 300}});
+    EXPECT_EQ(index.size(), 4u);
+    EXPECT_TRUE(Tracked(index).empty());
+
+    index.setPids(std::vector<uint32_t>{100, 300});
+    EXPECT_EQ(Tracked(index), (std::set{Window(1), Window(2), Window(4)}));
+    EXPECT_TRUE(index.isTracked(Window(1)));
+    EXPECT_FALSE(index.isTracked(Window(3)));
+    EXPECT_FALSE(index.isTracked(Window(99)));
+
+    // any range of integers
+    index.setPids(std::set<int>{200});
+    EXPECT_EQ(Tracked(index), std::set{Window(3)});
+    index.setPids(std::vector<uint32_t>{});
+    EXPECT_TRUE(Tracked(index).empty());
+}
+
+TEST(WindowIndex, FollowsCreatedAndDestroyedWindows)
+{
+    WindowIndex index;
+    index.setPids(std::vector<uint32_t>{100});
+    index.addWindow(Window(1), 100);
+    index.addWindow(Window(2), 200);
+    EXPECT_EQ(Tracked(index), std::set{Window(1)});
+
+    // handle reused by another process
+    index.removeWindow(Window(1));
+    index.addWindow(Window(1), 200);
+    EXPECT_FALSE(index.isTracked(Window(1)));
+    index.addWindow(Window(2), 100);
+    EXPECT_TRUE(index.isTracked(Window(2)));
+
+    index.removeWindow(Window(2));
+    index.removeWindow(Window(42));
+    EXPECT_TRUE(Tracked(index).empty());
+    EXPECT_EQ(index.size(), 1u);
+}
+
+TEST(WindowIndex, ExtraWindowsAreTrackedUntilDestroyed)
+{
+    WindowIndex index;
+    index.reset({{Window(1), 100}, {Window(2), 200}});
+    index.setExtraWindows({Window(2), Window(3)});
+    EXPECT_EQ(Tracked(index), (std::set{Window(2), Window(3)}));
+
+    // survives pid changes
+    index.setPids(std::vector<uint32_t>{100});
+    EXPECT_EQ(Tracked(index), (std::set{Window(1), Window(2), Window(3)}));
+
+    index.removeWindow(Window(3));
+    EXPECT_EQ(Tracked(index), (std::set{Window(1), Window(2)}));
+    index.setExtraWindows({});
+    EXPECT_EQ(Tracked(index), std::set{Window(1)});
+}
+
+TEST(WindowIndex, ResetReplacesEverything)
+{
+    WindowIndex index;
+    index.setPids(std::vector<uint32_t>{100});
+    index.addWindow(Window(1), 100);
+    index.reset({{Window(2), 100}, {Window(3), 200}});
+    EXPECT_EQ(index.size(), 2u);
+    EXPECT_EQ(Tracked(index), std::set{Window(2)});
+}
+
+TEST(WindowIndex, LookupsWhileWindowsComeAndGo)
+{
+    WindowIndex index;
+    std::vector<std::pair<WindowIndex::Id, uint32_t>> windows;
+    for (uintptr_t i = 0; i < 500; i++) {
+        windows.emplace_back(Window(i), static_cast<uint32_t>(i % 50));
+    }
+    index.reset(windows);
+    index.setPids(std::vector<uint32_t>{7});
+
+    std::atomic<bool> stop = false;
+    std::thread churn([&] {
+        for (uintptr_t n = 0; !stop; n++) {
+            const auto window = Window(1000 + n % 64);
+            index.addWindow(window, static_cast<uint32_t>(n % 2 ? 7 : 8));
+            index.removeWindow(window);
+        }
+    });
+    // window 7 is owned by PID 7 and never touched by the churn thread
+    for (int i = 0; i < 100'000; i++) {
+        ASSERT_TRUE(index.isTracked(Window(7)));
+        ASSERT_FALSE(index.isTracked(Window(8)));
+    }
+    stop = true;
+    churn.join();
+    EXPECT_EQ(index.size(), 500u);
+    EXPECT_EQ(index.trackedWindows().size(), 10u);
+}
@@ -87,17 +87,28 @@ DWORD WINAPI watchdog(HMODULE hModule)
 	}
 	spdlog::debug("Found GlosSITarget window; Starting watch loop");
 
+	// keep a handle; waiting on it notices GlosSITarget exiting right away
+	DWORD glossi_pid = 0;
+	GetWindowThreadProcessId(glossi_hwnd, &glossi_pid);
+	const HANDLE glossi_process = OpenProcess(SYNCHRONIZE, FALSE, glossi_pid);
+	if (!glossi_process)
+	{
+		spdlog::warn("Couldn't open GlosSITarget process; falling back to polling its window");
+	}
+
 	httplib::Client http_client("http://localhost:8756");
 
 	fetchSettings(http_client);
 
 	std::vector<DWORD> pids;
+	std::string pids_etag;
 	while (glossi_hwnd)
 	{
 		http_client.set_connection_timeout(120);
-		const auto http_res = http_client.Get("/launched-pids");
+		const auto http_res = http_client.Get("/launched-pids", {{"If-None-Match", pids_etag}});
 		if (http_res.error() == httplib::Error::Success && http_res->status == 200)
 		{
+			pids_etag = http_res->get_header_value("ETag");
 			const auto json = nlohmann::json::parse(http_res->body);
 			if (Settings::common.extendedLogging)
 			{
@@ -105,13 +116,27 @@ DWORD WINAPI watchdog(HMODULE hModule)
 			}
 			pids = json.get<std::vector<DWORD>>();
 		}
-		else {
+		// 304: unchanged since the last response
+		else if (http_res.error() != httplib::Error::Success || http_res->status != 304) {
 			spdlog::error("Couldn't fetch launched PIDs: {}", (int)http_res.error());
 		}
 
-		glossi_hwnd = FindWindowA(nullptr, "GlosSITarget");
-
-		Sleep(333);
+		if (glossi_process)
+		{
+			if (WaitForSingleObject(glossi_process, 333) != WAIT_TIMEOUT)
+			{
+				glossi_hwnd = nullptr;
+			}
+		}
+		else
+		{
+			glossi_hwnd = FindWindowA(nullptr, "GlosSITarget");
+			Sleep(333);
+		}
+	}
+	if (glossi_process)
+	{
+		CloseHandle(glossi_process);
 	}
 	spdlog::info("GlosSITarget was closed. Resetting HidHide state...");
 	HidHide hidhide;
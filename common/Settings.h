@@ -15,8 +15,10 @@ limitations under the License.
 */
 #pragma once
 
+#ifdef _WIN32
 #define SPDLOG_WCHAR_TO_UTF8_SUPPORT
 #define SPDLOG_WCHAR_FILENAMES
+#endif
 #include <spdlog/spdlog.h>
 #include <fstream>
 #include <regex>
@@ -57,6 +59,10 @@ namespace Settings
     {
         bool windowMode = false;
         int maxFps = 0;
+        // while both overlays are closed; 0 = don't throttle
+        unsigned int idleFps = 20;
+        // bit n = logical core n; 0 = any
+        uint64_t renderThreadAffinity = 0;
         float scale = 0.f;
         bool disableOverlay = false;
         bool hideAltTab = true;
@@ -70,13 +76,38 @@ namespace Settings
         bool allowDesktopConfig = false;
         bool emulateDS4 = false;
         unsigned int updateRate = 144;
+        // opt-in; adds up to one idle period of latency to the first input after idling
+        bool idleThrottle = false;
+        unsigned int idleUpdateRate = 30;
+        unsigned int keepaliveMs = 500;
+        std::string inputBackend = "XInput";
+        std::wstring replayFile;
+        bool replayMaxSpeed = false;
+        bool replayLoop = false;
+        // MMCSS task: "None", "Games" or "Pro Audio"
+        std::string inputThreadTask = "None";
+        uint64_t inputThreadAffinity = 0;
     } controller;
 
+    inline struct Logging
+    {
+        // file/console output is written by a background thread; errors are still flushed right away
+        bool async = true;
+        unsigned int queueSize = 8192;
+        // flush the log file after this many lines, or this long after the first unflushed one
+        unsigned int flushBatch = 512;
+        unsigned int flushIntervalMs = 250;
+        // queue full: "block" the logging thread, or "drop" the line
+        std::string overflow = "block";
+    } logging;
+
     inline struct Common
     {
         bool no_uwp_overlay = false;
         bool disable_watchdog = false;
         bool extendedLogging = false;
+        // comma separated (window, process, input, http); empty = all
+        std::string extendedLogCategories;
         std::wstring name;
         std::wstring icon;
         int version;
@@ -89,19 +120,19 @@ namespace Settings
     } common;
 
     inline const std::map<std::wstring, std::function<void()>> cmd_args = {
-        {L"-disableuwpoverlay", [&]()
+        {L"-disableuwpoverlay", []()
          { common.no_uwp_overlay = true; }},
-        {L"-disablewatchdog", [&]()
+        {L"-disablewatchdog", []()
          { common.disable_watchdog = true; }},
-        {L"-ignorelauncher", [&]()
+        {L"-ignorelauncher", []()
          { launch.ignoreLauncher = true; }},
-        {L"-window", [&]()
+        {L"-window", []()
          { window.windowMode = true; }},
-        {L"-extendedLogging", [&]()
+        {L"-extendedLogging", []()
          { common.extendedLogging = true; }},
-        {L"-globalModeUseGamepadUI", [&]()
+        {L"-globalModeUseGamepadUI", []()
          { common.globalModeUseGamepadUI = true; }},
-        {L"-disallowGlobalMode", [&]()
+        {L"-disallowGlobalMode", []()
          { common.allowGlobalMode = false; }},
     };
 
@@ -152,7 +183,7 @@ namespace Settings
                 }
                 if constexpr (std::is_same_v<T, std::wstring>)
                 {
-                    value = util::string::to_wstring(object[key].get<std::string>());
+                    value = util::string::to_wstring(object[key].template get<std::string>());
                 }
                 else
                 {
@@ -216,6 +247,8 @@ namespace Settings
             {
                 safeParseValue(winconf, "windowMode", window.windowMode);
                 safeParseValue(winconf, "maxFps", window.maxFps);
+                safeParseValue(winconf, "idleFps", window.idleFps);
+                safeParseValue(winconf, "renderThreadAffinity", window.renderThreadAffinity);
                 safeParseValue(winconf, "scale", window.scale);
                 safeParseValue(winconf, "disableOverlay", window.disableOverlay);
                 safeParseValue(winconf, "hideAltTab", window.hideAltTab);
@@ -229,8 +262,26 @@ namespace Settings
                 safeParseValue(controllerConf, "allowDesktopConfig", controller.allowDesktopConfig);
                 safeParseValue(controllerConf, "emulateDS4", controller.emulateDS4);
                 safeParseValue(controllerConf, "updateRate", controller.updateRate);
+                safeParseValue(controllerConf, "idleThrottle", controller.idleThrottle);
+                safeParseValue(controllerConf, "idleUpdateRate", controller.idleUpdateRate);
+                safeParseValue(controllerConf, "keepaliveMs", controller.keepaliveMs);
+                safeParseValue(controllerConf, "inputBackend", controller.inputBackend);
+                safeParseValue(controllerConf, "replayFile", controller.replayFile);
+                safeParseValue(controllerConf, "replayMaxSpeed", controller.replayMaxSpeed);
+                safeParseValue(controllerConf, "replayLoop", controller.replayLoop);
+                safeParseValue(controllerConf, "inputThreadTask", controller.inputThreadTask);
+                safeParseValue(controllerConf, "inputThreadAffinity", controller.inputThreadAffinity);
+            }
+            if (const auto logConf = json["logging"]; !logConf.is_null() && !logConf.empty() && logConf.is_object())
+            {
+                safeParseValue(logConf, "async", logging.async);
+                safeParseValue(logConf, "queueSize", logging.queueSize);
+                safeParseValue(logConf, "flushBatch", logging.flushBatch);
+                safeParseValue(logConf, "flushIntervalMs", logging.flushIntervalMs);
+                safeParseValue(logConf, "overflow", logging.overflow);
             }
             safeParseValue(json, "extendedLogging", common.extendedLogging);
+            safeParseValue(json, "extendedLogCategories", common.extendedLogCategories);
             safeParseValue(json, "name", common.name);
             safeParseValue(json, "icon", common.icon);
             safeParseValue(json, "version", common.version);
@@ -302,8 +353,8 @@ namespace Settings
         json_file.open(path);
         if (!json_file.is_open())
         {
-            spdlog::error(L"Couldn't open settings file {}", path.wstring());
-            spdlog::debug(L"Using sane defaults...");
+            spdlog::error("Couldn't open settings file {}", util::string::to_string(path.wstring()));
+            spdlog::debug("Using sane defaults...");
             for (const auto &ovr : cli_overrides)
             {
                 ovr();
@@ -335,6 +386,8 @@ namespace Settings
         json["devices"]["realDeviceIds"] = devices.realDeviceIds;
         json["window"]["windowMode"] = window.windowMode;
         json["window"]["maxFps"] = window.maxFps;
+        json["window"]["idleFps"] = window.idleFps;
+        json["window"]["renderThreadAffinity"] = window.renderThreadAffinity;
         json["window"]["scale"] = window.scale;
         json["window"]["disableOverlay"] = window.disableOverlay;
         json["window"]["hideAltTab"] = window.hideAltTab;
@@ -343,6 +396,21 @@ namespace Settings
         json["controller"]["allowDesktopConfig"] = controller.allowDesktopConfig;
         json["controller"]["emulateDS4"] = controller.emulateDS4;
         json["controller"]["updateRate"] = controller.updateRate;
+        json["controller"]["idleThrottle"] = controller.idleThrottle;
+        json["controller"]["idleUpdateRate"] = controller.idleUpdateRate;
+        json["controller"]["keepaliveMs"] = controller.keepaliveMs;
+        json["controller"]["inputBackend"] = controller.inputBackend;
+        json["controller"]["replayFile"] = controller.replayFile;
+        json["controller"]["replayMaxSpeed"] = controller.replayMaxSpeed;
+        json["controller"]["replayLoop"] = controller.replayLoop;
+        json["controller"]["inputThreadTask"] = controller.inputThreadTask;
+        json["controller"]["inputThreadAffinity"] = controller.inputThreadAffinity;
+
+        json["logging"]["async"] = logging.async;
+        json["logging"]["queueSize"] = logging.queueSize;
+        json["logging"]["flushBatch"] = logging.flushBatch;
+        json["logging"]["flushIntervalMs"] = logging.flushIntervalMs;
+        json["logging"]["overflow"] = logging.overflow;
 
 
         json["globalModeGameId"] = common.globalModeGameId;;
@@ -355,6 +423,7 @@ namespace Settings
 		json["steamUserId"] = common.steamUserId;
 
         json["extendedLogging"] = common.extendedLogging;
+        json["extendedLogCategories"] = common.extendedLogCategories;
         json["name"] = common.name;
         json["icon"] = common.icon;
         json["version"] = common.version;
@@ -369,7 +438,7 @@ namespace Settings
         json_file.open(settings_path_);
         if (!json_file.is_open())
         {
-            spdlog::error(L"Couldn't open settings file {}", settings_path_.wstring());
+            spdlog::error("Couldn't open settings file {}", util::string::to_string(settings_path_.wstring()));
             return;
         }
         json_file << json.dump(4);
@@ -28,6 +28,7 @@ limitations under the License.
 #include <KnownFolders.h>
 #endif
 
+#include <cstdlib>
 #include <filesystem>
 
 #ifdef SPDLOG_H
@@ -58,6 +59,7 @@ namespace util {
 	{
 		inline std::filesystem::path getDataDirPath()
 		{
+#ifdef _WIN32
 			wchar_t* localAppDataFolder;
 			std::filesystem::path path;
 			if (SHGetKnownFolderPath(FOLDERID_LocalAppData, KF_FLAG_CREATE, nullptr, &localAppDataFolder) != S_OK) {
@@ -68,6 +70,18 @@ namespace util {
 			}
 
 			path /= "Roaming";
+#else
+			std::filesystem::path path;
+			if (const auto xdg = std::getenv("XDG_DATA_HOME"); xdg != nullptr && *xdg != '\0') {
+				path = xdg;
+			}
+			else if (const auto home = std::getenv("HOME"); home != nullptr) {
+				path = std::filesystem::path(home) / ".local" / "share";
+			}
+			else {
+				path = std::filesystem::temp_directory_path();
+			}
+#endif
 			path /= "GlosSI";
 			if (!std::filesystem::exists(path))
 				std::filesystem::create_directories(path);
@@ -76,9 +90,14 @@ namespace util {
 
 		inline std::filesystem::path getGlosSIDir()
 		{
+#ifdef _WIN32
 			wchar_t result[MAX_PATH];
 			std::filesystem::path res{ std::wstring{result, GetModuleFileNameW(NULL, result, MAX_PATH)} };
 			return res.parent_path();
+#else
+			std::error_code ec;
+			return std::filesystem::read_symlink("/proc/self/exe", ec).parent_path();
+#endif
 		}
 
 	}